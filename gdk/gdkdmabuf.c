@@ -24,6 +24,7 @@
 #include "gdkdmabuffourccprivate.h"
 #include "gdkdmabuftextureprivate.h"
 #include "gdkmemoryformatprivate.h"
+#include "gdkparalleltaskprivate.h"
 
 #ifdef HAVE_DMABUF
 #include <sys/mman.h>
@@ -2082,6 +2083,152 @@ gdk_dmabuf_get_mmap_formats (void)
   return formats;
 }
 
+/* Rows per band when converting YUV in parallel. This must be a
+ * multiple of the largest vertical subsampling (4 for YUV410), so
+ * that every band starts on a chroma row.
+ */
+#define YUV_BAND_HEIGHT 64
+
+static gsize
+gdk_dmabuf_get_plane_y_subsampling (guint32 fourcc,
+                                    gsize   plane)
+{
+  if (plane == 0)
+    return 1;
+
+  switch (fourcc)
+    {
+    case DRM_FORMAT_NV12:
+    case DRM_FORMAT_NV21:
+    case DRM_FORMAT_P010:
+    case DRM_FORMAT_P012:
+    case DRM_FORMAT_P016:
+    case DRM_FORMAT_YUV420:
+    case DRM_FORMAT_YVU420:
+      return 2;
+
+    case DRM_FORMAT_YUV410:
+    case DRM_FORMAT_YVU410:
+      return 4;
+
+    default:
+      return 1;
+    }
+}
+
+typedef struct _YuvDownload YuvDownload;
+
+struct _YuvDownload
+{
+  const GdkDrmFormatInfo *info;
+  const GdkDmabuf        *dmabuf;
+  guchar                 *data;
+  gsize                   stride;
+  GdkMemoryFormat         format;
+  gsize                   width;
+  gsize                   height;
+  const guchar          **src_data;
+  gsize                  *sizes;
+  gsize                   band_height;
+
+  /* atomic */ int        bands_done;
+};
+
+static void
+gdk_dmabuf_download_yuv_bands (gpointer data)
+{
+  YuvDownload *yd = data;
+  gsize band, y, i;
+
+  for (band = g_atomic_int_add (&yd->bands_done, 1);
+       band * yd->band_height < yd->height;
+       band = g_atomic_int_add (&yd->bands_done, 1))
+    {
+      GdkDmabuf dmabuf = *yd->dmabuf;
+
+      y = band * yd->band_height;
+      for (i = 0; i < dmabuf.n_planes; i++)
+        dmabuf.planes[i].offset += y / gdk_dmabuf_get_plane_y_subsampling (dmabuf.fourcc, i) * dmabuf.planes[i].stride;
+
+      yd->info->download (yd->data + y * yd->stride,
+                          yd->stride,
+                          yd->format,
+                          yd->width,
+                          MIN (yd->band_height, yd->height - y),
+                          &dmabuf,
+                          yd->src_data,
+                          yd->sizes);
+    }
+}
+
+/*< private >
+ * gdk_dmabuf_download_planes:
+ * @dmabuf: the dmabuf
+ * @src_data: the mapped memory of each plane
+ * @sizes: the size of the mapped memory of each plane
+ * @format: the memory format of the dmabuf's fourcc
+ * @width: the width of the dmabuf
+ * @height: the height of the dmabuf
+ * @band_height: the number of rows to convert at once for YUV formats,
+ *   a multiple of 4, or 0 to convert all rows at once
+ * @data: the memory to convert into
+ * @stride: the stride of @data
+ *
+ * Converts the mapped planes of a dmabuf into @format. YUV formats
+ * are converted in bands of @band_height rows that run in parallel.
+ */
+void
+gdk_dmabuf_download_planes (const GdkDmabuf *dmabuf,
+                            const guchar    *src_data[GDK_DMABUF_MAX_PLANES],
+                            gsize            sizes[GDK_DMABUF_MAX_PLANES],
+                            GdkMemoryFormat  format,
+                            gsize            width,
+                            gsize            height,
+                            gsize            band_height,
+                            guchar          *data,
+                            gsize            stride)
+{
+  const GdkDrmFormatInfo *info;
+
+  info = get_drm_format_info (dmabuf->fourcc);
+
+  g_return_if_fail (info && info->download);
+  g_return_if_fail (band_height % 4 == 0);
+
+  if (info->is_yuv && band_height > 0 && height > band_height)
+    {
+      /* YUV conversion is compute bound, so split it into bands of rows
+       * and convert them in parallel, like gdk_memory_convert() does.
+       */
+      YuvDownload yd = {
+        .info = info,
+        .dmabuf = dmabuf,
+        .data = data,
+        .stride = stride,
+        .format = format,
+        .width = width,
+        .height = height,
+        .src_data = src_data,
+        .sizes = sizes,
+        .band_height = band_height,
+        .bands_done = 0,
+      };
+
+      gdk_parallel_task_run (gdk_dmabuf_download_yuv_bands, &yd);
+    }
+  else
+    {
+      info->download (data,
+                      stride,
+                      format,
+                      width,
+                      height,
+                      dmabuf,
+                      src_data,
+                      sizes);
+    }
+}
+
 static void
 gdk_dmabuf_do_download_mmap (GdkTexture *texture,
                              guchar     *data,
@@ -2139,14 +2286,15 @@ gdk_dmabuf_do_download_mmap (GdkTexture *texture,
       needs_unmap[i] = TRUE;
     }
 
-    info->download (data,
-                    stride,
-                    gdk_texture_get_format (texture),
-                    gdk_texture_get_width (texture),
-                    gdk_texture_get_height (texture),
-                    dmabuf,
-                    src_data,
-                    sizes);
+  gdk_dmabuf_download_planes (dmabuf,
+                              src_data,
+                              sizes,
+                              gdk_texture_get_format (texture),
+                              gdk_texture_get_width (texture),
+                              gdk_texture_get_height (texture),
+                              YUV_BAND_HEIGHT,
+                              data,
+                              stride);
 
 out:
   for (i = 0; i < dmabuf->n_planes; i++)
@@ -32,6 +32,15 @@ void                        gdk_dmabuf_download_mmap            (GdkTexture
                                                                  GdkColorState                  *color_state,
                                                                  guchar                         *data,
                                                                  gsize                           stride);
+void                        gdk_dmabuf_download_planes          (const GdkDmabuf                *dmabuf,
+                                                                 const guchar                   *src_data[GDK_DMABUF_MAX_PLANES],
+                                                                 gsize                           sizes[GDK_DMABUF_MAX_PLANES],
+                                                                 GdkMemoryFormat                 format,
+                                                                 gsize                           width,
+                                                                 gsize                           height,
+                                                                 gsize                           band_height,
+                                                                 guchar                         *data,
+                                                                 gsize                           stride);
 
 int                         gdk_dmabuf_ioctl                    (int                             fd,
                                                                  unsigned long                   request,
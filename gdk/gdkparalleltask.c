@@ -30,13 +30,18 @@ struct _TaskData
   int n_running_tasks;
 };
 
+/* Set while a thread runs a task function */
+static GPrivate in_task;
+
 static void
 gdk_parallel_task_thread_func (gpointer data,
                                gpointer unused)
 {
   TaskData *task = data;
 
+  g_private_set (&in_task, GINT_TO_POINTER (TRUE));
   task->task_func (task->task_data);
+  g_private_set (&in_task, NULL);
 
   g_atomic_int_add (&task->n_running_tasks, -1);
 }
@@ -48,6 +53,15 @@ gdk_parallel_task_thread_func (gpointer data,
  *
  * Spawns the given function in many threads.
  * Once all functions have exited, this function returns.
+ *
+ * The function must be safe to run any number of times, and
+ * the calls must share the work between them, so that a single
+ * call does all of it.
+ *
+ * When called from inside a task function, the function is run
+ * only once, in the calling thread. All the threads of the pool
+ * may be busy waiting for their own tasks then, so pushing more
+ * tasks to the pool could deadlock.
  **/
 void
 gdk_parallel_task_run (GdkTaskFunc task_func,
@@ -60,6 +74,12 @@ gdk_parallel_task_run (GdkTaskFunc task_func,
   };
   int i, n_tasks;
 
+  if (g_private_get (&in_task))
+    {
+      task_func (task_data);
+      return;
+    }
+
   if (g_once_init_enter (&pool))
     {
       GThreadPool *the_pool = g_thread_pool_new (gdk_parallel_task_thread_func,
@@ -128,9 +128,11 @@ insert_subsurface (GdkSubsurface *subsurface,
  *   It must be integral in application and device pixels, or attaching will fail
  * @transform: the transform to apply to the texture contents before displaying
  * @background: (nullable): the background rectangle, in application pixels relative
- *   to the parent surface. This tells GDK to put a black background of this
+ *   to the parent surface. This tells GDK to put a solid background of this
  *   size below the subsurface. It must be integral in application and device pixels,
  *   or attaching will fail
+ * @background_color: (nullable): the color of the background, or `NULL` for black.
+ *   It must be opaque. This is ignored if @background is `NULL`
  * @above: whether the subsurface should be above its sibling
  * @sibling: (nullable): the sibling subsurface to stack relative to, or `NULL` to
  *   stack relative to the parent surface
@@ -149,6 +151,7 @@ gdk_subsurface_attach (GdkSubsurface         *subsurface,
                        const graphene_rect_t *dest,
                        GdkDihedral            transform,
                        const graphene_rect_t *background,
+                       const GdkColor        *background_color,
                        gboolean               above,
                        GdkSubsurface         *sibling)
 {
@@ -166,6 +169,7 @@ gdk_subsurface_attach (GdkSubsurface         *subsurface,
   g_return_val_if_fail (sibling != subsurface, FALSE);
   g_return_val_if_fail (sibling == NULL || GDK_IS_SUBSURFACE (sibling), FALSE);
   g_return_val_if_fail (sibling == NULL || sibling->parent == subsurface->parent, FALSE);
+  g_return_val_if_fail (background_color == NULL || gdk_color_is_opaque (background_color), FALSE);
 
   /* if the texture fully covers the background, ignore it */
   if (background &&
@@ -179,6 +183,7 @@ gdk_subsurface_attach (GdkSubsurface         *subsurface,
                                                           dest,
                                                           transform,
                                                           background,
+                                                          background_color,
                                                           above,
                                                           sibling);
 
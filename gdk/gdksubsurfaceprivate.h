@@ -20,6 +20,7 @@
 #pragma once
 
 #include "gdkenumtypes.h"
+#include "gdkcolorprivate.h"
 #include "gdkdihedralprivate.h"
 #include "gdksurface.h"
 #include <graphene.h>
@@ -58,6 +59,7 @@ struct _GdkSubsurfaceClass
                                         const graphene_rect_t *dest,
                                         GdkDihedral            transform,
                                         const graphene_rect_t *bg,
+                                        const GdkColor        *bg_color,
                                         gboolean               above,
                                         GdkSubsurface         *sibling);
   void         (* detach)              (GdkSubsurface         *subsurface);
@@ -82,6 +84,7 @@ gboolean        gdk_subsurface_attach              (GdkSubsurface         *subsu
                                                     const graphene_rect_t *dest,
                                                     GdkDihedral             transform,
                                                     const graphene_rect_t *background,
+                                                    const GdkColor        *background_color,
                                                     gboolean               above,
                                                     GdkSubsurface         *sibling);
 void            gdk_subsurface_detach              (GdkSubsurface         *subsurface);
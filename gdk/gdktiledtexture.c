@@ -0,0 +1,183 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdktiledtextureprivate.h"
+
+#include "gdkcolorstateprivate.h"
+#include "gdkmemoryformatprivate.h"
+
+#include <string.h>
+
+/* A texture whose pixels are not kept in memory, but produced
+ * on demand, one area at a time, by a loader function. This is
+ * meant for images that are too large to keep around in full,
+ * like maps or microscopy scans.
+ *
+ * Renderers that know about it (the GPU renderer) only request
+ * the tiles that are visible, at the level of detail they need.
+ * Everything else downloads the full image, in bands, through
+ * the regular download vfunc.
+ */
+
+/* Height of the bands that are loaded when downloading the whole texture */
+#define DOWNLOAD_BAND_HEIGHT 256
+
+struct _GdkTiledTexture
+{
+  GdkTexture parent_instance;
+
+  GdkTiledTextureLoadFunc load_func;
+  gpointer user_data;
+  GDestroyNotify destroy;
+};
+
+struct _GdkTiledTextureClass
+{
+  GdkTextureClass parent_class;
+};
+
+G_DEFINE_TYPE (GdkTiledTexture, gdk_tiled_texture, GDK_TYPE_TEXTURE)
+
+static void
+gdk_tiled_texture_finalize (GObject *object)
+{
+  GdkTiledTexture *self = GDK_TILED_TEXTURE (object);
+
+  if (self->destroy)
+    self->destroy (self->user_data);
+
+  G_OBJECT_CLASS (gdk_tiled_texture_parent_class)->finalize (object);
+}
+
+static void
+gdk_tiled_texture_download (GdkTexture      *texture,
+                            GdkMemoryFormat  format,
+                            GdkColorState   *color_state,
+                            guchar          *data,
+                            gsize            stride)
+{
+  GdkTiledTexture *self = GDK_TILED_TEXTURE (texture);
+  gsize bpp = gdk_memory_format_bytes_per_pixel (format);
+  int y, i;
+
+  for (y = 0; y < texture->height; y += DOWNLOAD_BAND_HEIGHT)
+    {
+      cairo_rectangle_int_t area = { 0, y, texture->width, MIN (DOWNLOAD_BAND_HEIGHT, texture->height - y) };
+      GdkTexture *band;
+
+      band = gdk_tiled_texture_load (self, 0, &area);
+      if (band == NULL)
+        {
+          /* The last row may not have a full stride */
+          for (i = 0; i < area.height; i++)
+            memset (data + (y + i) * stride, 0, texture->width * bpp);
+          continue;
+        }
+
+      gdk_texture_do_download (band, format, color_state, data + y * stride, stride);
+      g_object_unref (band);
+    }
+}
+
+static void
+gdk_tiled_texture_class_init (GdkTiledTextureClass *klass)
+{
+  GdkTextureClass *texture_class = GDK_TEXTURE_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  texture_class->download = gdk_tiled_texture_download;
+
+  gobject_class->finalize = gdk_tiled_texture_finalize;
+}
+
+static void
+gdk_tiled_texture_init (GdkTiledTexture *self)
+{
+}
+
+GdkTexture *
+gdk_tiled_texture_new (int                      width,
+                       int                      height,
+                       GdkMemoryFormat          format,
+                       GdkColorState           *color_state,
+                       GdkTiledTextureLoadFunc  load_func,
+                       gpointer                 user_data,
+                       GDestroyNotify           destroy)
+{
+  GdkTiledTexture *self;
+
+  g_return_val_if_fail (width > 0, NULL);
+  g_return_val_if_fail (height > 0, NULL);
+  g_return_val_if_fail (format < GDK_MEMORY_N_FORMATS, NULL);
+  g_return_val_if_fail (color_state != NULL, NULL);
+  g_return_val_if_fail (load_func != NULL, NULL);
+
+  self = g_object_new (GDK_TYPE_TILED_TEXTURE,
+                       "width", width,
+                       "height", height,
+                       "color-state", color_state,
+                       NULL);
+
+  GDK_TEXTURE (self)->format = format;
+  self->load_func = load_func;
+  self->user_data = user_data;
+  self->destroy = destroy;
+
+  return GDK_TEXTURE (self);
+}
+
+/* Returns the pixels of @area, in full-size image coordinates,
+ * scaled down by 2^lod_level. The area is clipped to the texture.
+ */
+GdkTexture *
+gdk_tiled_texture_load (GdkTiledTexture             *self,
+                        guint                        lod_level,
+                        const cairo_rectangle_int_t *area)
+{
+  GdkTexture *texture = GDK_TEXTURE (self);
+  cairo_rectangle_int_t clipped;
+  GdkTexture *result;
+  int width, height;
+
+  clipped.x = MAX (area->x, 0);
+  clipped.y = MAX (area->y, 0);
+  clipped.width = MIN (area->x + area->width, texture->width) - clipped.x;
+  clipped.height = MIN (area->y + area->height, texture->height) - clipped.y;
+  if (clipped.width <= 0 || clipped.height <= 0)
+    return NULL;
+
+  result = self->load_func (self, lod_level, &clipped, self->user_data);
+  if (result == NULL)
+    return NULL;
+
+  width = (clipped.width + (1 << lod_level) - 1) >> lod_level;
+  height = (clipped.height + (1 << lod_level) - 1) >> lod_level;
+  if (gdk_texture_get_width (result) != width ||
+      gdk_texture_get_height (result) != height)
+    {
+      g_critical ("Tile loader returned a %dx%d texture for %dx%d area at level %u, expected %dx%d",
+                  gdk_texture_get_width (result), gdk_texture_get_height (result),
+                  clipped.width, clipped.height, lod_level,
+                  width, height);
+      g_object_unref (result);
+      return NULL;
+    }
+
+  return result;
+}
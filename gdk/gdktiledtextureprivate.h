@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gdktextureprivate.h"
+
+G_BEGIN_DECLS
+
+#define GDK_TYPE_TILED_TEXTURE (gdk_tiled_texture_get_type ())
+
+#define GDK_TILED_TEXTURE(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDK_TYPE_TILED_TEXTURE, GdkTiledTexture))
+#define GDK_IS_TILED_TEXTURE(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDK_TYPE_TILED_TEXTURE))
+
+typedef struct _GdkTiledTexture       GdkTiledTexture;
+typedef struct _GdkTiledTextureClass  GdkTiledTextureClass;
+
+/*
+ * GdkTiledTextureLoadFunc:
+ * @self: the texture
+ * @lod_level: the level of detail, the area is scaled down by 2^lod_level
+ * @area: the area to load, in pixels of the full-size image
+ * @user_data: the data passed when creating the texture
+ *
+ * Produces the pixels of @area at the given level of detail.
+ *
+ * The returned texture must be @area scaled down by 2^@lod_level,
+ * rounded up. This function may be called from any thread.
+ *
+ * Returns: (transfer full) (nullable): the pixels or %NULL on error
+ */
+typedef GdkTexture * (* GdkTiledTextureLoadFunc) (GdkTiledTexture             *self,
+                                                  guint                        lod_level,
+                                                  const cairo_rectangle_int_t *area,
+                                                  gpointer                     user_data);
+
+GType                   gdk_tiled_texture_get_type      (void) G_GNUC_CONST;
+
+GdkTexture *            gdk_tiled_texture_new           (int                          width,
+                                                         int                          height,
+                                                         GdkMemoryFormat              format,
+                                                         GdkColorState               *color_state,
+                                                         GdkTiledTextureLoadFunc      load_func,
+                                                         gpointer                     user_data,
+                                                         GDestroyNotify               destroy);
+
+GdkTexture *            gdk_tiled_texture_load          (GdkTiledTexture             *self,
+                                                         guint                        lod_level,
+                                                         const cairo_rectangle_int_t *area);
+
+G_END_DECLS
+
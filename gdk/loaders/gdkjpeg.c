@@ -26,6 +26,7 @@
 #include "gdktexturedownloaderprivate.h"
 #include "gdkmemorytexturebuilder.h"
 #include "gdkcolorstateprivate.h"
+#include "gdktiledtextureprivate.h"
 
 #include "gdkprofilerprivate.h"
 
@@ -108,12 +109,350 @@ convert_cmyk_to_rgba (guchar *data,
     }
 }
 
+/* }}} */
+/* {{{ Tiled loading */
+
+/* JPEGs with more pixels than this are not decoded up front. They
+ * become tiled textures that decode the areas that are drawn, at
+ * the size they are drawn at.
+ */
+#define TILED_JPEG_MIN_PIXELS (8192 * 8192)
+
+typedef struct _JpegTiles JpegTiles;
+
+struct _JpegTiles
+{
+  GBytes *bytes;
+  guint width;
+  guint height;
+  GdkMemoryFormat format;
+
+  GMutex mutex;
+
+  /* The decoder is kept between loads, so loading areas from
+   * top to bottom decodes the image only once */
+  struct jpeg_decompress_struct info;
+  struct error_handler_data jerr;
+  gboolean decoding;
+
+  /* The rows that were decoded last, at the full decoded width.
+   * Tiles next to each other need the same rows. */
+  guchar *band;
+  guint band_shift;
+  guint band_y;
+  guint band_height;
+  gsize band_stride;
+};
+
+static void
+jpeg_tiles_free (gpointer data)
+{
+  JpegTiles *self = data;
+
+  if (self->decoding)
+    jpeg_destroy_decompress (&self->info);
+  g_free (self->band);
+  g_mutex_clear (&self->mutex);
+  g_bytes_unref (self->bytes);
+  g_free (self);
+}
+
+/* Decodes @height rows starting at @y, at 1/2^@shift of the full size,
+ * into self->band */
+static gboolean
+jpeg_tiles_decode_band (JpegTiles *self,
+                        guint      shift,
+                        guint      y,
+                        guint      height)
+{
+  unsigned char *row[1];
+  guint i;
+
+  if (sigsetjmp (self->jerr.setjmp_buffer, 1))
+    {
+      jpeg_destroy_decompress (&self->info);
+      self->decoding = FALSE;
+      g_clear_pointer (&self->band, g_free);
+      self->band_height = 0;
+      return FALSE;
+    }
+
+  if (self->decoding &&
+      (self->info.scale_denom != 1u << shift || self->info.output_scanline > y))
+    {
+      jpeg_destroy_decompress (&self->info);
+      self->decoding = FALSE;
+    }
+
+  if (!self->decoding)
+    {
+      jpeg_create_decompress (&self->info);
+      self->decoding = TRUE;
+
+      self->info.mem->max_memory_to_use = 1024 * 1024 * 1024;
+
+      jpeg_mem_src (&self->info,
+                    g_bytes_get_data (self->bytes, NULL),
+                    g_bytes_get_size (self->bytes));
+      jpeg_read_header (&self->info, TRUE);
+
+      self->info.scale_num = 1;
+      self->info.scale_denom = 1 << shift;
+
+      jpeg_start_decompress (&self->info);
+    }
+
+  height = MIN (height, self->info.output_height - y);
+
+  g_clear_pointer (&self->band, g_free);
+  self->band_height = 0;
+  self->band_stride = (gsize) self->info.output_width * self->info.output_components;
+  self->band = g_try_malloc_n (self->band_stride, height);
+  if (self->band == NULL)
+    return FALSE;
+
+  /* The first row of the band doubles as scratch space for skipping */
+  while (self->info.output_scanline < y)
+    {
+      row[0] = self->band;
+      jpeg_read_scanlines (&self->info, row, 1);
+    }
+
+  for (i = 0; i < height; i++)
+    {
+      row[0] = self->band + i * self->band_stride;
+      jpeg_read_scanlines (&self->info, row, 1);
+    }
+
+  if (self->info.out_color_space == JCS_CMYK)
+    convert_cmyk_to_rgba (self->band, self->info.output_width, height, self->band_stride);
+
+  self->band_shift = shift;
+  self->band_y = y;
+  self->band_height = height;
+
+  return TRUE;
+}
+
+static GdkTexture *
+gdk_load_jpeg_tile (GdkTiledTexture             *texture,
+                    guint                        lod_level,
+                    const cairo_rectangle_int_t *area,
+                    gpointer                     data)
+{
+  JpegTiles *self = data;
+  GdkMemoryTextureBuilder *builder;
+  GdkTexture *tile;
+  GBytes *bytes;
+  guchar *pixels;
+  guint shift, box, components, denom;
+  gsize decoded_width, decoded_height, width, height, stride;
+  gsize x0, y0, x, y, c, bx, by;
+
+  /* libjpeg scales down by up to 8, the rest is box filtered */
+  shift = MIN (lod_level, 3);
+  box = 1 << (lod_level - shift);
+  denom = 1 << shift;
+  decoded_width = (self->width + denom - 1) / denom;
+  decoded_height = (self->height + denom - 1) / denom;
+
+  width = (area->width + (1 << lod_level) - 1) >> lod_level;
+  height = (area->height + (1 << lod_level) - 1) >> lod_level;
+  x0 = area->x >> shift;
+  y0 = area->y >> shift;
+
+  g_mutex_lock (&self->mutex);
+
+  if (self->band == NULL ||
+      self->band_shift != shift ||
+      self->band_y > y0 ||
+      self->band_y + self->band_height < MIN (y0 + height * box, decoded_height))
+    {
+      if (!jpeg_tiles_decode_band (self, shift, y0, height * box))
+        {
+          g_mutex_unlock (&self->mutex);
+          return NULL;
+        }
+    }
+
+  components = gdk_memory_format_bytes_per_pixel (self->format);
+  stride = width * components;
+  pixels = g_malloc_n (stride, height);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      for (c = 0; c < components; c++)
+        {
+          guint sum = 0;
+
+          /* Pixels past the edge repeat the last row or column */
+          for (by = 0; by < box; by++)
+            {
+              const guchar *src_row;
+              gsize src_y = MIN (y0 + y * box + by, decoded_height - 1);
+
+              src_row = self->band + (src_y - self->band_y) * self->band_stride;
+              for (bx = 0; bx < box; bx++)
+                sum += src_row[MIN (x0 + x * box + bx, decoded_width - 1) * components + c];
+            }
+
+          pixels[y * stride + x * components + c] = (sum + box * box / 2) / (box * box);
+        }
+
+  g_mutex_unlock (&self->mutex);
+
+  bytes = g_bytes_new_take (pixels, stride * height);
+
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_bytes (builder, bytes);
+  gdk_memory_texture_builder_set_stride (builder, stride);
+  gdk_memory_texture_builder_set_width (builder, width);
+  gdk_memory_texture_builder_set_height (builder, height);
+  gdk_memory_texture_builder_set_format (builder, self->format);
+  gdk_memory_texture_builder_set_color_state (builder, GDK_COLOR_STATE_SRGB);
+
+  tile = gdk_memory_texture_builder_build (builder);
+
+  g_object_unref (builder);
+  g_bytes_unref (bytes);
+
+  return tile;
+}
+
+/* Reads the size of the image and the format it decodes to */
+static gboolean
+gdk_jpeg_read_header (GBytes           *input_bytes,
+                      guint            *width,
+                      guint            *height,
+                      GdkMemoryFormat  *format,
+                      GError          **error)
+{
+  struct jpeg_decompress_struct info;
+  struct error_handler_data jerr;
+  gboolean result = TRUE;
+
+  info.err = jpeg_std_error (&jerr.pub);
+  jerr.pub.error_exit = fatal_error_handler;
+  jerr.pub.output_message = output_message_handler;
+  jerr.error = error;
+
+  if (sigsetjmp (jerr.setjmp_buffer, 1))
+    {
+      jpeg_destroy_decompress (&info);
+      return FALSE;
+    }
+
+  jpeg_create_decompress (&info);
+
+  jpeg_mem_src (&info,
+                g_bytes_get_data (input_bytes, NULL),
+                g_bytes_get_size (input_bytes));
+
+  jpeg_read_header (&info, TRUE);
+
+  *width = info.image_width;
+  *height = info.image_height;
+
+  switch ((int)info.out_color_space)
+    {
+    case JCS_GRAYSCALE:
+      *format = GDK_MEMORY_G8;
+      break;
+    case JCS_RGB:
+      *format = GDK_MEMORY_R8G8B8;
+      break;
+    case JCS_CMYK:
+      *format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+      break;
+    default:
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                   _("Unsupported JPEG colorspace (%d)"), info.out_color_space);
+      result = FALSE;
+      break;
+    }
+
+  jpeg_destroy_decompress (&info);
+
+  return result;
+}
+
+/* Loads a JPEG as a tiled texture. Only the header is read here,
+ * the pixels are decoded when they are needed, so errors in the
+ * image data only show up as missing areas.
+ */
+GdkTexture *
+gdk_load_jpeg_tiled (GBytes  *input_bytes,
+                     GError **error)
+{
+  JpegTiles *self;
+  guint width, height;
+  GdkMemoryFormat format;
+
+  if (!gdk_jpeg_read_header (input_bytes, &width, &height, &format, error))
+    return NULL;
+
+  if (width > G_MAXINT || height > G_MAXINT)
+    {
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                   _("Image size %ux%u is too large"), width, height);
+      return NULL;
+    }
+
+  self = g_new0 (JpegTiles, 1);
+  self->bytes = g_bytes_ref (input_bytes);
+  self->width = width;
+  self->height = height;
+  self->format = format;
+  g_mutex_init (&self->mutex);
+
+  self->info.err = jpeg_std_error (&self->jerr.pub);
+  self->jerr.pub.error_exit = fatal_error_handler;
+  self->jerr.pub.output_message = output_message_handler;
+  self->jerr.error = NULL;
+
+  return gdk_tiled_texture_new (width, height,
+                                format,
+                                GDK_COLOR_STATE_SRGB,
+                                gdk_load_jpeg_tile,
+                                self,
+                                jpeg_tiles_free);
+}
+
 /* }}} */
 /* {{{ Public API */
 
 GdkTexture *
 gdk_load_jpeg (GBytes  *input_bytes,
                GError **error)
+{
+  guint width, height;
+  GdkMemoryFormat format;
+
+  if (gdk_jpeg_read_header (input_bytes, &width, &height, &format, NULL) &&
+      (guint64) width * height > TILED_JPEG_MIN_PIXELS)
+    return gdk_load_jpeg_tiled (input_bytes, error);
+
+  return gdk_load_jpeg_at_size (input_bytes, 0, 0, error);
+}
+
+/* Loads a JPEG that is going to be displayed at no more than
+ * @max_width x @max_height, preserving aspect ratio.
+ *
+ * libjpeg can produce downscaled output directly from the DCT
+ * coefficients, at 1/2, 1/4 or 1/8 of the original size, which
+ * saves both the time and the memory to decode the full image.
+ * The result is never smaller than the requested size, so it
+ * still needs to be scaled down when drawing it.
+ *
+ * Pass 0 for both sizes to load the image at full size.
+ */
+GdkTexture *
+gdk_load_jpeg_at_size (GBytes  *input_bytes,
+                       int      max_width,
+                       int      max_height,
+                       GError **error)
 {
   struct jpeg_decompress_struct info;
   struct error_handler_data jerr;
@@ -149,6 +488,23 @@ gdk_load_jpeg (GBytes  *input_bytes,
                 g_bytes_get_size (input_bytes));
 
   jpeg_read_header (&info, TRUE);
+
+  if (max_width > 0 && max_height > 0)
+    {
+      double scale = MIN ((double) max_width / info.image_width,
+                          (double) max_height / info.image_height);
+      guint denom;
+
+      for (denom = 8; denom > 1; denom /= 2)
+        {
+          if (denom * scale <= 1.0)
+            break;
+        }
+
+      info.scale_num = 1;
+      info.scale_denom = denom;
+    }
+
   jpeg_start_decompress (&info);
 
   width = info.output_width;
@@ -24,6 +24,12 @@
 
 GdkTexture *gdk_load_jpeg         (GBytes           *bytes,
                                    GError          **error);
+GdkTexture *gdk_load_jpeg_at_size (GBytes           *bytes,
+                                   int               max_width,
+                                   int               max_height,
+                                   GError          **error);
+GdkTexture *gdk_load_jpeg_tiled   (GBytes           *bytes,
+                                   GError          **error);
 
 GBytes     *gdk_save_jpeg         (GdkTexture     *texture);
 
@@ -27,6 +27,7 @@ GdkTexture *gdk_load_png        (GBytes         *bytes,
                                  GError        **error);
 
 GBytes     *gdk_save_png        (GdkTexture     *texture);
+GBytes     *gdk_save_png_fast   (GdkTexture     *texture);
 
 static inline gboolean
 gdk_is_png (GBytes *bytes)
@@ -36,6 +36,7 @@ struct _GdkWaylandSubsurface
   struct wl_subsurface *bg_subsurface;
   struct wp_viewport *bg_viewport;
   cairo_rectangle_int_t bg_rect;
+  float bg_color[3];
   gboolean bg_attached;
 };
 
@@ -309,7 +309,10 @@ get_sp_buffer (GdkWaylandSubsurface *self)
 
   if (display->single_pixel_buffer)
     buffer = wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer (display->single_pixel_buffer,
-                                                                       0, 0, 0, 0xffffffffU);
+                                                                       self->bg_color[0] * (double) G_MAXUINT32,
+                                                                       self->bg_color[1] * (double) G_MAXUINT32,
+                                                                       self->bg_color[2] * (double) G_MAXUINT32,
+                                                                       0xffffffffU);
 
   if (buffer)
     wl_buffer_add_listener (buffer, &sp_buffer_listener, self);
@@ -391,6 +394,7 @@ gdk_wayland_subsurface_attach (GdkSubsurface         *sub,
                                const graphene_rect_t *dest,
                                GdkDihedral            transform,
                                const graphene_rect_t *background,
+                               const GdkColor        *background_color,
                                gboolean               above,
                                GdkSubsurface         *sibling)
 {
@@ -411,6 +415,7 @@ gdk_wayland_subsurface_attach (GdkSubsurface         *sub,
   gboolean stacking_changed = FALSE;
   gboolean needs_commit = FALSE;
   gboolean background_changed = FALSE;
+  gboolean bg_color_changed = FALSE;
   gboolean needs_bg_commit = FALSE;
   gboolean color_state_changed = FALSE;
 
@@ -479,6 +484,23 @@ gdk_wayland_subsurface_attach (GdkSubsurface         *sub,
       self->bg_rect.y = background->origin.y;
       self->bg_rect.width = background->size.width;
       self->bg_rect.height = background->size.height;
+
+      if (background_color)
+        {
+          float values[4];
+
+          gdk_color_to_float (background_color, GDK_COLOR_STATE_SRGB, values);
+          for (int i = 0; i < 3; i++)
+            values[i] = CLAMP (values[i], 0.f, 1.f);
+
+          bg_color_changed = memcmp (self->bg_color, values, sizeof (self->bg_color)) != 0;
+          memcpy (self->bg_color, values, sizeof (self->bg_color));
+        }
+      else
+        {
+          bg_color_changed = self->bg_color[0] != 0 || self->bg_color[1] != 0 || self->bg_color[2] != 0;
+          memset (self->bg_color, 0, sizeof (self->bg_color));
+        }
     }
   else
     {
@@ -675,7 +697,7 @@ gdk_wayland_subsurface_attach (GdkSubsurface         *sub,
               needs_bg_commit = TRUE;
             }
 
-          if (!self->bg_attached)
+          if (!self->bg_attached || bg_color_changed)
             {
               self->bg_attached = TRUE;
 
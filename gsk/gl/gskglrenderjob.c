@@ -4184,11 +4184,19 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
     case GSK_CONTAINER_NODE:
       {
         GskRenderNode **children;
-        guint n_children;
+        graphene_rect_t clip_rect;
+        guint i, n_children;
 
         children = gsk_container_node_get_children (node, &n_children);
 
-        for (guint i = 0; i < n_children; i++)
+        if (job->current_clip->is_fully_contained)
+          clip_rect = node->bounds;
+        else
+          gsk_gl_render_job_untransform_bounds (job, &job->current_clip->rect.bounds, &clip_rect);
+
+        for (i = gsk_container_node_get_next_child_in_rect (node, 0, &clip_rect);
+             i < n_children;
+             i = gsk_container_node_get_next_child_in_rect (node, i + 1, &clip_rect))
           {
             const GskRenderNode *child = children[i];
 
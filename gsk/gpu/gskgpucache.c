@@ -30,6 +30,7 @@ G_STATIC_ASSERT (MIN_ALIVE_PIXELS < ATLAS_SIZE * ATLAS_SIZE);
 typedef struct _GskGpuCachedGlyph GskGpuCachedGlyph;
 typedef struct _GskGpuCachedTexture GskGpuCachedTexture;
 typedef struct _GskGpuCachedTile GskGpuCachedTile;
+typedef struct _GskGpuCachedChain GskGpuCachedChain;
 
 struct _GskGpuCache
 {
@@ -45,15 +46,21 @@ struct _GskGpuCache
   GHashTable *ccs_texture_caches[GDK_COLOR_STATE_N_IDS];
   GHashTable *tile_cache;
   GHashTable *glyph_cache;
+  GHashTable *chain_cache;
 
   GskGpuCachedAtlas *current_atlas;
 
   /* atomic */ gsize dead_textures;
   /* atomic */ gsize dead_texture_pixels;
+
+  gsize memory;   /* sum of the memory of all cached items */
+  gsize budget;   /* 0 for unlimited */
 };
 
 G_DEFINE_TYPE (GskGpuCache, gsk_gpu_cache, G_TYPE_OBJECT)
 
+static guint memory_counter;
+
 /* {{{ Cached base class */
 
 static inline void
@@ -89,6 +96,8 @@ gsk_gpu_cached_free (GskGpuCache  *self,
 
   mark_as_stale (cached, TRUE);
 
+  self->memory -= cached->memory;
+
   cached->class->free (self, cached);
 }
 
@@ -130,6 +139,26 @@ gsk_gpu_cached_new (GskGpuCache             *cache,
   return gsk_gpu_cached_new_from_atlas (cache, class, NULL);
 }
 
+static void
+gsk_gpu_cached_set_image_memory (GskGpuCache  *self,
+                                 GskGpuCached *cached,
+                                 GskGpuImage  *image)
+{
+  self->memory -= cached->memory;
+  cached->memory = gsk_gpu_image_get_width (image) *
+                   gsk_gpu_image_get_height (image) *
+                   gdk_memory_format_bytes_per_pixel (gsk_gpu_image_get_format (image));
+  self->memory += cached->memory;
+}
+
+static void
+gsk_gpu_cached_clear_image_memory (GskGpuCache  *self,
+                                   GskGpuCached *cached)
+{
+  self->memory -= cached->memory;
+  cached->memory = 0;
+}
+
 static void
 gsk_gpu_cached_use (GskGpuCache  *self,
                     GskGpuCached *cached)
@@ -222,6 +251,7 @@ gsk_gpu_cached_atlas_new (GskGpuCache *cache)
   self = gsk_gpu_cached_new (cache, &GSK_GPU_CACHED_ATLAS_CLASS);
   self->image = gsk_gpu_device_create_atlas_image (cache->device, ATLAS_SIZE, ATLAS_SIZE);
   self->remaining_pixels = gsk_gpu_image_get_width (self->image) * gsk_gpu_image_get_height (self->image);
+  gsk_gpu_cached_set_image_memory (cache, (GskGpuCached *) self, self->image);
 
   return self;
 }
@@ -513,6 +543,7 @@ gsk_gpu_cached_texture_new (GskGpuCache   *cache,
   self->image = g_object_ref (image);
   self->color_state = color_state;
   ((GskGpuCached *)self)->pixels = gsk_gpu_image_get_width (image) * gsk_gpu_image_get_height (image);
+  gsk_gpu_cached_set_image_memory (cache, (GskGpuCached *) self, image);
   self->dead_textures_counter = &cache->dead_textures;
   self->dead_pixels_counter = &cache->dead_texture_pixels;
   self->use_count = 2;
@@ -670,6 +701,7 @@ gsk_gpu_cached_tile_new (GskGpuCache   *cache,
   self->image = g_object_ref (image);
   self->color_state = gdk_color_state_ref (color_state);
   ((GskGpuCached *)self)->pixels = gsk_gpu_image_get_width (image) * gsk_gpu_image_get_height (image);
+  gsk_gpu_cached_set_image_memory (cache, (GskGpuCached *) self, image);
   self->dead_textures_counter = &cache->dead_textures;
   self->dead_pixels_counter = &cache->dead_texture_pixels;
   self->use_count = 2;
@@ -735,6 +767,169 @@ gsk_gpu_cache_cache_tile (GskGpuCache      *self,
   gsk_gpu_cached_use (self, (GskGpuCached *) tile);
 }
 
+/* }}} */
+/* {{{ CachedChain */
+
+/* For textures that are part of a GdkTextureChain, we remember the
+ * last uploaded texture and its image, so that the next texture in
+ * the chain can reuse the image and only upload what changed.
+ *
+ * We keep a reference to the texture, so that its link in the chain
+ * stays intact and gdk_texture_diff() can compute the changes.
+ */
+struct _GskGpuCachedChain
+{
+  GskGpuCached parent;
+
+  GdkTextureChain *chain; /* no ref, kept alive by texture */
+  GdkTexture *texture;
+  GskGpuImage *image;
+};
+
+static void
+gsk_gpu_cached_chain_free (GskGpuCache  *cache,
+                           GskGpuCached *cached)
+{
+  GskGpuCachedChain *self = (GskGpuCachedChain *) cached;
+  gpointer key, value;
+
+  if (g_hash_table_steal_extended (cache->chain_cache, self->chain, &key, &value))
+    {
+      if ((GskGpuCached *) value != cached)
+        g_hash_table_insert (cache->chain_cache, key, value);
+    }
+
+  g_clear_object (&self->image);
+  g_object_unref (self->texture);
+  g_free (self);
+}
+
+static gboolean
+gsk_gpu_cached_chain_should_collect (GskGpuCache  *cache,
+                                     GskGpuCached *cached,
+                                     gint64        cache_timeout,
+                                     gint64        timestamp)
+{
+  GskGpuCachedChain *self = (GskGpuCachedChain *) cached;
+
+  return gsk_gpu_cached_is_old (cache, cached, cache_timeout, timestamp) ||
+         self->image == NULL;
+}
+
+static const GskGpuCachedClass GSK_GPU_CACHED_CHAIN_CLASS =
+{
+  sizeof (GskGpuCachedChain),
+  "Chain",
+  gsk_gpu_cached_chain_free,
+  gsk_gpu_cached_chain_should_collect
+};
+
+static void
+gsk_gpu_cache_remember_chain_image (GskGpuCache *self,
+                                    GdkTexture  *texture,
+                                    GskGpuImage *image)
+{
+  GdkTextureChain *chain;
+  GskGpuCachedChain *cached;
+
+  chain = g_atomic_pointer_get (&texture->chain);
+  if (chain == NULL)
+    return;
+
+  if (self->chain_cache == NULL)
+    self->chain_cache = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  cached = g_hash_table_lookup (self->chain_cache, chain);
+  if (cached == NULL)
+    {
+      cached = gsk_gpu_cached_new (self, &GSK_GPU_CACHED_CHAIN_CLASS);
+      cached->chain = chain;
+      g_hash_table_insert (self->chain_cache, chain, cached);
+    }
+  else
+    {
+      g_clear_object (&cached->image);
+      g_clear_object (&cached->texture);
+    }
+
+  cached->texture = g_object_ref (texture);
+  cached->image = g_object_ref (image);
+
+  gsk_gpu_cached_use (self, (GskGpuCached *) cached);
+}
+
+static GskGpuCachedTexture *
+gsk_gpu_cache_lookup_cached_texture (GskGpuCache   *self,
+                                     GdkTexture    *texture,
+                                     GdkColorState *color_state);
+
+/*
+ * gsk_gpu_cache_steal_chain_image:
+ * @self: the cache
+ * @texture: a texture that is not uploaded yet
+ * @region: region to add the changed area to
+ *
+ * Finds the image of a previously uploaded texture in the same chain
+ * as @texture and takes it over for @texture. The caller must upload
+ * the parts of @texture in @region to the returned image.
+ *
+ * Images that have been used in the current frame are never returned,
+ * as changing them would change what has already been drawn.
+ *
+ * Returns: (transfer full) (nullable): the image to update
+ **/
+GskGpuImage *
+gsk_gpu_cache_steal_chain_image (GskGpuCache    *self,
+                                 GdkTexture     *texture,
+                                 cairo_region_t *region)
+{
+  GdkTextureChain *chain;
+  GskGpuCachedChain *cached;
+  GskGpuCachedTexture *previous;
+  GdkTexture *prev_texture;
+  GskGpuImage *image;
+
+  if (self->chain_cache == NULL)
+    return NULL;
+
+  chain = g_atomic_pointer_get (&texture->chain);
+  if (chain == NULL)
+    return NULL;
+
+  cached = g_hash_table_lookup (self->chain_cache, chain);
+  if (cached == NULL || cached->image == NULL || cached->texture == texture)
+    return NULL;
+
+  prev_texture = cached->texture;
+  if (gdk_texture_get_width (prev_texture) != gdk_texture_get_width (texture) ||
+      gdk_texture_get_height (prev_texture) != gdk_texture_get_height (texture) ||
+      gdk_texture_get_format (prev_texture) != gdk_texture_get_format (texture) ||
+      !gdk_color_state_equal (gdk_texture_get_color_state (prev_texture),
+                              gdk_texture_get_color_state (texture)))
+    return NULL;
+
+  /* We'd have to regenerate the mipmaps */
+  if (gsk_gpu_image_get_flags (cached->image) & GSK_GPU_IMAGE_MIPMAP)
+    return NULL;
+
+  previous = gsk_gpu_cache_lookup_cached_texture (self, prev_texture, NULL);
+  if (previous && previous->image == cached->image)
+    {
+      if (((GskGpuCached *) previous)->timestamp == self->timestamp)
+        return NULL;
+
+      /* The previous texture needs to upload again if it's drawn again */
+      g_clear_object (&previous->image);
+      gsk_gpu_cached_clear_image_memory (self, (GskGpuCached *) previous);
+    }
+
+  gdk_texture_diff (texture, prev_texture, region);
+
+  image = g_steal_pointer (&cached->image);
+
+  return image;
+}
+
 /* }}} */
 /* {{{ CachedGlyph */
 
@@ -840,6 +1035,12 @@ gsk_gpu_cache_set_time (GskGpuCache *self,
   self->timestamp = timestamp;
 }
 
+gint64
+gsk_gpu_cache_get_time (GskGpuCache *self)
+{
+  return self->timestamp;
+}
+
 typedef struct
 {
   guint n_items;
@@ -886,6 +1087,11 @@ print_cache_stats (GskGpuCache *self)
     g_string_append (ratios, ")");
 
   message = g_string_new ("Cached items");
+  if (self->budget)
+    g_string_append_printf (message, " (%" G_GSIZE_FORMAT " of %" G_GSIZE_FORMAT " kB)",
+                            self->memory / 1024, self->budget / 1024);
+  else
+    g_string_append_printf (message, " (%" G_GSIZE_FORMAT " kB)", self->memory / 1024);
   g_hash_table_iter_init (&iter, classes);
   while (g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -906,6 +1112,71 @@ print_cache_stats (GskGpuCache *self)
   g_string_free (ratios, TRUE);
 }
 
+static int
+compare_cached_age (gconstpointer a,
+                    gconstpointer b)
+{
+  const GskGpuCached *ca = *(const GskGpuCached **) a;
+  const GskGpuCached *cb = *(const GskGpuCached **) b;
+
+  if (ca->timestamp < cb->timestamp)
+    return -1;
+  else if (ca->timestamp > cb->timestamp)
+    return 1;
+  else
+    return 0;
+}
+
+/* Frees the least recently used textures and tiles until the
+ * memory use is below the budget.
+ *
+ * Atlases are not evicted here, they are collected once their
+ * glyphs are gone. Items used in the current frame are kept, as
+ * they may be referenced by ops that have not been submitted yet.
+ */
+static void
+gsk_gpu_cache_evict (GskGpuCache *self)
+{
+  GskGpuCached *cached, *prev;
+  GPtrArray *candidates;
+  gsize i, target;
+
+  if (self->budget == 0 || self->memory <= self->budget)
+    return;
+
+  /* Leave some headroom, so we don't have to evict again next frame */
+  target = self->budget - self->budget / 4;
+
+  candidates = g_ptr_array_new ();
+
+  for (cached = self->last_cached; cached != NULL; cached = prev)
+    {
+      prev = cached->prev;
+
+      if (cached->timestamp == self->timestamp)
+        continue;
+
+      /* Chains keep images alive that are also owned by textures,
+       * so drop them first to make evicting those effective.
+       */
+      if (cached->class == &GSK_GPU_CACHED_CHAIN_CLASS)
+        gsk_gpu_cached_free (self, cached);
+      else if (cached->class == &GSK_GPU_CACHED_TEXTURE_CLASS ||
+               cached->class == &GSK_GPU_CACHED_TILE_CLASS)
+        g_ptr_array_add (candidates, cached);
+    }
+
+  g_ptr_array_sort (candidates, compare_cached_age);
+
+  for (i = 0; i < candidates->len && self->memory > target; i++)
+    gsk_gpu_cached_free (self, g_ptr_array_index (candidates, i));
+
+  GSK_DEBUG (CACHE, "Evicted %" G_GSIZE_FORMAT " items to stay within budget (%" G_GSIZE_FORMAT " kB used)",
+             i, self->memory / 1024);
+
+  g_ptr_array_unref (candidates);
+}
+
 /* Returns TRUE if everything was GC'ed */
 gboolean
 gsk_gpu_cache_gc (GskGpuCache *self,
@@ -928,9 +1199,13 @@ gsk_gpu_cache_gc (GskGpuCache *self,
         is_empty &= cached->stale;
     }
 
+  gsk_gpu_cache_evict (self);
+
   g_atomic_pointer_set (&self->dead_textures, 0);
   g_atomic_pointer_set (&self->dead_texture_pixels, 0);
 
+  gdk_profiler_set_int_counter (memory_counter, self->memory);
+
   if (GSK_DEBUG_CHECK (CACHE))
     print_cache_stats (self);
 
@@ -939,6 +1214,34 @@ gsk_gpu_cache_gc (GskGpuCache *self,
   return is_empty;
 }
 
+/*
+ * gsk_gpu_cache_set_budget:
+ * @self: a `GskGpuCache`
+ * @budget: the memory budget in bytes, or 0 for no limit
+ *
+ * Sets the amount of image memory the cache tries to stay below.
+ * When it is exceeded, the least recently used textures are
+ * evicted during the next GC until 3/4 of the budget are used.
+ **/
+void
+gsk_gpu_cache_set_budget (GskGpuCache *self,
+                          gsize        budget)
+{
+  self->budget = budget;
+}
+
+gsize
+gsk_gpu_cache_get_memory (GskGpuCache *self)
+{
+  return self->memory;
+}
+
+gboolean
+gsk_gpu_cache_is_over_budget (GskGpuCache *self)
+{
+  return self->budget > 0 && self->memory > self->budget;
+}
+
 gsize
 gsk_gpu_cache_get_dead_textures (GskGpuCache *self)
 {
@@ -981,6 +1284,7 @@ gsk_gpu_cache_dispose (GObject *object)
   gsk_gpu_cache_clear_cache (self);
   g_hash_table_unref (self->glyph_cache);
   g_clear_pointer (&self->tile_cache, g_hash_table_unref);
+  g_clear_pointer (&self->chain_cache, g_hash_table_unref);
   g_hash_table_unref (self->texture_cache);
 
   G_OBJECT_CLASS (gsk_gpu_cache_parent_class)->dispose (object);
@@ -1003,6 +1307,8 @@ gsk_gpu_cache_class_init (GskGpuCacheClass *klass)
 
   object_class->dispose = gsk_gpu_cache_dispose;
   object_class->finalize = gsk_gpu_cache_finalize;
+
+  memory_counter = gdk_profiler_define_int_counter ("gpu-cache-memory", "Bytes of images in the GPU cache");
 }
 
 static void
@@ -1014,10 +1320,10 @@ gsk_gpu_cache_init (GskGpuCache *self)
                                           g_direct_equal);
 }
 
-GskGpuImage *
-gsk_gpu_cache_lookup_texture_image (GskGpuCache   *self,
-                                    GdkTexture    *texture,
-                                    GdkColorState *color_state)
+static GskGpuCachedTexture *
+gsk_gpu_cache_lookup_cached_texture (GskGpuCache   *self,
+                                     GdkTexture    *texture,
+                                     GdkColorState *color_state)
 {
   GskGpuCachedTexture *cache;
   GHashTable *texture_cache;
@@ -1035,6 +1341,20 @@ gsk_gpu_cache_lookup_texture_image (GskGpuCache   *self,
   if (!cache || !cache->image || gsk_gpu_cached_texture_is_invalid (cache))
     return NULL;
 
+  return cache;
+}
+
+GskGpuImage *
+gsk_gpu_cache_lookup_texture_image (GskGpuCache   *self,
+                                    GdkTexture    *texture,
+                                    GdkColorState *color_state)
+{
+  GskGpuCachedTexture *cache;
+
+  cache = gsk_gpu_cache_lookup_cached_texture (self, texture, color_state);
+  if (cache == NULL)
+    return NULL;
+
   gsk_gpu_cached_use (self, (GskGpuCached *) cache);
 
   return g_object_ref (cache->image);
@@ -1052,6 +1372,9 @@ gsk_gpu_cache_cache_texture_image (GskGpuCache   *self,
   g_return_if_fail (cache != NULL);
 
   gsk_gpu_cached_use (self, (GskGpuCached *) cache);
+
+  if (color_state == NULL)
+    gsk_gpu_cache_remember_chain_image (self, texture, image);
 }
 
 GskGpuImage *
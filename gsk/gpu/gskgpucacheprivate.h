@@ -34,6 +34,7 @@ struct _GskGpuCached
   gint64 timestamp;
   gboolean stale;
   guint pixels;   /* For glyphs and textures, pixels. For atlases, alive pixels */
+  gsize memory;   /* Estimated bytes of image memory owned by this item */
 };
 
 #define GSK_TYPE_GPU_CACHE         (gsk_gpu_cache_get_type ())
@@ -60,10 +61,15 @@ gpointer                gsk_gpu_cached_new                              (GskGpuC
 GskGpuDevice *          gsk_gpu_cache_get_device                        (GskGpuCache            *self);
 void                    gsk_gpu_cache_set_time                          (GskGpuCache            *self,
                                                                          gint64                  timestamp);
+gint64                  gsk_gpu_cache_get_time                          (GskGpuCache            *self);
 
 gboolean                gsk_gpu_cache_gc                                (GskGpuCache            *self,
                                                                          gint64                  cache_timeout,
                                                                          gint64                  timestamp);
+void                    gsk_gpu_cache_set_budget                        (GskGpuCache            *self,
+                                                                         gsize                   budget);
+gsize                   gsk_gpu_cache_get_memory                        (GskGpuCache            *self);
+gboolean                gsk_gpu_cache_is_over_budget                    (GskGpuCache            *self);
 gsize                   gsk_gpu_cache_get_dead_textures                 (GskGpuCache            *self);
 gsize                   gsk_gpu_cache_get_dead_texture_pixels           (GskGpuCache            *self);
 GskGpuImage *           gsk_gpu_cache_get_atlas_image                   (GskGpuCache            *self);
@@ -75,6 +81,9 @@ void                    gsk_gpu_cache_cache_texture_image               (GskGpuC
                                                                          GdkTexture             *texture,
                                                                          GskGpuImage            *image,
                                                                          GdkColorState          *color_state);
+GskGpuImage *           gsk_gpu_cache_steal_chain_image                 (GskGpuCache            *self,
+                                                                         GdkTexture             *texture,
+                                                                         cairo_region_t         *region);
 GskGpuImage *           gsk_gpu_cache_lookup_tile                       (GskGpuCache            *self,
                                                                          GdkTexture             *texture,
                                                                          guint                   lod_level,
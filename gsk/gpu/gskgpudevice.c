@@ -9,6 +9,7 @@
 #include "gsk/gskdebugprivate.h"
 
 #define CACHE_TIMEOUT 15  /* seconds */
+#define CACHE_BUDGET 256  /* megabytes */
 
 typedef struct _GskGpuDevicePrivate GskGpuDevicePrivate;
 
@@ -21,6 +22,10 @@ struct _GskGpuDevicePrivate
   GskGpuCache *cache; /* we don't own a ref, but manage the cache */
   guint cache_gc_source;
   int cache_timeout;  /* in seconds, or -1 to disable gc */
+  gsize cache_budget; /* in bytes, or 0 for no limit */
+  gsize budget_gc_memory; /* memory left after the last GC for the budget */
+
+  GMemoryMonitor *memory_monitor;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GskGpuDevice, gsk_gpu_device, G_TYPE_OBJECT)
@@ -97,6 +102,41 @@ gsk_gpu_device_maybe_gc (GskGpuDevice *self)
                  dead_textures, dead_texture_pixels);
       gsk_gpu_device_gc (self, g_get_monotonic_time ());
     }
+  else if (!gsk_gpu_cache_is_over_budget (priv->cache))
+    {
+      priv->budget_gc_memory = 0;
+    }
+  else if (gsk_gpu_cache_get_memory (priv->cache) > priv->budget_gc_memory)
+    {
+      /* If the last GC could not get below the budget because everything
+       * is in use, don't try again before even more memory is used.
+       */
+      GSK_DEBUG (CACHE, "Pre-frame GC (%" G_GSIZE_FORMAT " kB used, budget is %" G_GSIZE_FORMAT " kB)",
+                 gsk_gpu_cache_get_memory (priv->cache) / 1024, priv->cache_budget / 1024);
+      if (!gsk_gpu_device_gc (self, g_get_monotonic_time ()))
+        priv->budget_gc_memory = gsk_gpu_cache_get_memory (priv->cache);
+    }
+}
+
+static void
+low_memory_warning_cb (GMemoryMonitor             *monitor,
+                       GMemoryMonitorWarningLevel  level,
+                       GskGpuDevice               *self)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
+
+  if (priv->cache == NULL || priv->cache_timeout < 0)
+    return;
+
+  GSK_DEBUG (CACHE, "Low memory GC (level %d, %" G_GSIZE_FORMAT " kB used)",
+             level, gsk_gpu_cache_get_memory (priv->cache) / 1024);
+
+  /* Drop everything that was not used in the last frame */
+  g_object_ref (self);
+  gsk_gpu_device_make_current (self);
+  if (gsk_gpu_cache_gc (priv->cache, 0, gsk_gpu_cache_get_time (priv->cache)))
+    g_clear_object (&priv->cache);
+  g_object_unref (self);
 }
 
 void
@@ -116,6 +156,12 @@ gsk_gpu_device_dispose (GObject *object)
 
   g_clear_handle_id (&priv->cache_gc_source, g_source_remove);
 
+  if (priv->memory_monitor)
+    {
+      g_signal_handlers_disconnect_by_func (priv->memory_monitor, low_memory_warning_cb, self);
+      g_clear_object (&priv->memory_monitor);
+    }
+
   G_OBJECT_CLASS (gsk_gpu_device_parent_class)->dispose (object);
 }
 
@@ -174,6 +220,25 @@ gsk_gpu_device_setup (GskGpuDevice *self,
         }
     }
 
+  priv->cache_budget = (gsize) CACHE_BUDGET * 1024 * 1024;
+
+  str = g_getenv ("GSK_CACHE_BUDGET");
+  if (str != NULL)
+    {
+      guint64 value;
+      GError *error = NULL;
+
+      if (!g_ascii_string_to_unsigned (str, 10, 0, G_MAXSIZE / (1024 * 1024), &value, &error))
+        {
+          g_warning ("Failed to parse GSK_CACHE_BUDGET: %s", error->message);
+          g_error_free (error);
+        }
+      else
+        {
+          priv->cache_budget = (gsize) value * 1024 * 1024;
+        }
+    }
+
   if (GSK_DEBUG_CHECK (CACHE))
     {
       if (priv->cache_timeout < 0)
@@ -182,6 +247,11 @@ gsk_gpu_device_setup (GskGpuDevice *self,
         gdk_debug_message ("Cache GC before every frame");
       else
         gdk_debug_message ("Cache GC timeout: %d seconds", priv->cache_timeout);
+
+      if (priv->cache_budget == 0)
+        gdk_debug_message ("Cache budget disabled");
+      else
+        gdk_debug_message ("Cache budget: %" G_GSIZE_FORMAT " MB", priv->cache_budget / (1024 * 1024));
     }
 }
 
@@ -202,6 +272,18 @@ gsk_gpu_device_get_cache (GskGpuDevice *self)
     return priv->cache;
 
   priv->cache = gsk_gpu_cache_new (self);
+  gsk_gpu_cache_set_budget (priv->cache, priv->cache_budget);
+
+  /* Looking up the monitor may talk to the portal, so only do it
+   * once there is something to free, and not at all if the user
+   * turned off the budget.
+   */
+  if (priv->memory_monitor == NULL && priv->cache_budget > 0 && priv->cache_timeout >= 0)
+    {
+      priv->memory_monitor = g_memory_monitor_dup_default ();
+      g_signal_connect (priv->memory_monitor, "low-memory-warning",
+                        G_CALLBACK (low_memory_warning_cb), self);
+    }
 
   return priv->cache;
 }
@@ -14,10 +14,13 @@
 
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
+#include "gskrendernodeprivate.h"
 
 #include "gdk/gdkdmabufdownloaderprivate.h"
 #include "gdk/gdkdrawcontextprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdktexturedownloaderprivate.h"
+#include "gdk/gdktiledtextureprivate.h"
 
 #define DEFAULT_VERTEX_BUFFER_SIZE 128 * 1024
 
@@ -463,6 +466,38 @@ gsk_gpu_frame_get_last_op (GskGpuFrame *self)
   return priv->last_op;
 }
 
+/* Memory textures that are a new version of a previously uploaded
+ * texture only upload the changed areas into the old image.
+ */
+static GskGpuImage *
+gsk_gpu_frame_update_texture (GskGpuFrame *self,
+                              GdkTexture  *texture)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  cairo_region_t *region;
+  GskGpuImage *image;
+  int i;
+
+  if (!GDK_IS_MEMORY_TEXTURE (texture))
+    return NULL;
+
+  region = cairo_region_create ();
+  image = gsk_gpu_cache_steal_chain_image (gsk_gpu_device_get_cache (priv->device), texture, region);
+  if (image)
+    {
+      for (i = 0; i < cairo_region_num_rectangles (region); i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (region, i, &rect);
+          gsk_gpu_upload_texture_area_op (self, image, texture, &rect);
+        }
+    }
+  cairo_region_destroy (region);
+
+  return image;
+}
+
 GskGpuImage *
 gsk_gpu_frame_upload_texture (GskGpuFrame  *self,
                               gboolean      with_mipmap,
@@ -471,7 +506,9 @@ gsk_gpu_frame_upload_texture (GskGpuFrame  *self,
   GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
   GskGpuImage *image;
 
-  image = GSK_GPU_FRAME_GET_CLASS (self)->upload_texture (self, with_mipmap, texture);
+  image = gsk_gpu_frame_update_texture (self, texture);
+  if (image == NULL)
+    image = GSK_GPU_FRAME_GET_CLASS (self)->upload_texture (self, with_mipmap, texture);
 
   if (image)
     gsk_gpu_cache_cache_texture_image (gsk_gpu_device_get_cache (priv->device), texture, image, NULL);
@@ -731,6 +768,92 @@ do_download (gpointer    user_data,
   g_free (download);
 }
 
+/* Tiled textures can be much larger than any image, so instead of
+ * uploading them whole, they are rendered in chunks the size of the
+ * largest image. The node processor then only loads one chunk's
+ * worth of tiles at a time.
+ */
+static void
+gsk_gpu_frame_download_texture_tiles (GskGpuFrame     *self,
+                                      GdkTexture      *texture,
+                                      GdkMemoryFormat  format,
+                                      GdkColorState   *color_state,
+                                      guchar          *data,
+                                      gsize            stride)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  GskRenderNode *node;
+  GskGpuImage *image;
+  GdkColorState *image_color_state;
+  cairo_region_t *clip_region;
+  gsize x, y, width, height, max_size, bpp;
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  max_size = gsk_gpu_device_get_max_image_size (priv->device);
+  bpp = gdk_memory_format_bytes_per_pixel (format);
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, width, height));
+
+  for (y = 0; y < height; y += max_size)
+    {
+      for (x = 0; x < width; x += max_size)
+        {
+          image = gsk_gpu_device_create_download_image (priv->device,
+                                                        gsk_render_node_get_preferred_depth (node),
+                                                        MIN (max_size, width - x),
+                                                        MIN (max_size, height - y));
+          if (image == NULL)
+            {
+              g_critical ("Could not create image to download texture into");
+              goto out;
+            }
+
+          if (gsk_gpu_image_get_flags (image) & GSK_GPU_IMAGE_SRGB)
+            image_color_state = GDK_COLOR_STATE_SRGB_LINEAR;
+          else
+            image_color_state = GDK_COLOR_STATE_SRGB;
+
+          clip_region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                                           0, 0,
+                                                           gsk_gpu_image_get_width (image),
+                                                           gsk_gpu_image_get_height (image)
+                                                       });
+
+          /* waits for the previous chunk and finishes its download */
+          gsk_gpu_frame_cleanup (self);
+
+          gsk_gpu_node_processor_process (self,
+                                          image,
+                                          image_color_state,
+                                          clip_region,
+                                          node,
+                                          &GRAPHENE_RECT_INIT (x, y,
+                                                               gsk_gpu_image_get_width (image),
+                                                               gsk_gpu_image_get_height (image)),
+                                          GSK_RENDER_PASS_EXPORT);
+
+          gsk_gpu_download_op (self,
+                               image,
+                               FALSE,
+                               do_download,
+                               g_memdup (&(Download) {
+                                   .format = format,
+                                   .color_state = color_state,
+                                   .data = data + y * stride + x * bpp,
+                                   .stride = stride
+                               }, sizeof (Download)));
+
+          gsk_gpu_frame_submit (self, GSK_RENDER_PASS_EXPORT);
+
+          cairo_region_destroy (clip_region);
+          g_object_unref (image);
+        }
+    }
+
+out:
+  gsk_render_node_unref (node);
+}
+
 void
 gsk_gpu_frame_download_texture (GskGpuFrame     *self,
                                 gint64           timestamp,
@@ -746,6 +869,12 @@ gsk_gpu_frame_download_texture (GskGpuFrame     *self,
   priv->timestamp = timestamp;
   gsk_gpu_cache_set_time (gsk_gpu_device_get_cache (priv->device), timestamp);
 
+  if (GDK_IS_TILED_TEXTURE (texture))
+    {
+      gsk_gpu_frame_download_texture_tiles (self, texture, format, color_state, data, stride);
+      return;
+    }
+
   image = gsk_gpu_cache_lookup_texture_image (gsk_gpu_device_get_cache (priv->device), texture, NULL);
   if (image == NULL)
     image = gsk_gpu_frame_upload_texture (self, FALSE, texture);
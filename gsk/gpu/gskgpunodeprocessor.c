@@ -48,6 +48,7 @@
 #include "gdk/gdkrgbaprivate.h"
 #include "gdk/gdksubsurfaceprivate.h"
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdktiledtextureprivate.h"
 
 /* the epsilon we allow pixels to be off due to rounding errors.
  * Chosen rather randomly.
@@ -839,6 +840,35 @@ gsk_gpu_node_processor_get_node_as_image (GskGpuNodeProcessor   *self,
                                     out_bounds);
 }
 
+/* The blur shader takes one sample per pixel of blur radius, so for
+ * large radii we blur a downscaled copy of the source and scale the
+ * result back up. As long as the radius stays large at the reduced
+ * resolution, the upscaling doesn't lose anything visible.
+ */
+#define MIN_DOWNSCALED_BLUR_RADIUS 16.f
+#define MAX_BLUR_DOWNSCALE 8
+
+static guint
+gsk_gpu_node_processor_get_blur_downscale (GskGpuNodeProcessor *self,
+                                           float                blur_radius)
+{
+  float device_radius;
+  guint downscale;
+
+  if (!gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_BLUR))
+    return 1;
+
+  device_radius = blur_radius * MIN (graphene_vec2_get_x (&self->scale),
+                                     graphene_vec2_get_y (&self->scale));
+
+  downscale = 1;
+  while (downscale < MAX_BLUR_DOWNSCALE &&
+         device_radius / (2 * downscale) >= MIN_DOWNSCALED_BLUR_RADIUS)
+    downscale *= 2;
+
+  return downscale;
+}
+
 static void
 gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
                                 const graphene_rect_t     *rect,
@@ -850,11 +880,12 @@ gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
                                 const graphene_rect_t     *source_rect)
 {
   GskGpuNodeProcessor other;
-  GskGpuImage *intermediate;
-  graphene_vec2_t direction;
-  graphene_rect_t clip_rect, intermediate_rect;
+  GskGpuImage *image, *intermediate;
+  graphene_vec2_t direction, scale;
+  graphene_rect_t clip_rect, intermediate_rect, image_rect;
   graphene_point_t real_offset;
   float clip_radius;
+  guint downscale;
 
   clip_radius = gsk_cairo_blur_compute_pixels (blur_radius / 2.0);
 
@@ -866,13 +897,60 @@ gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
   if (!gsk_rect_intersection (rect, &clip_rect, &intermediate_rect))
     return;
 
-  rect_round_to_pixels (&intermediate_rect, &self->scale, &self->offset, &intermediate_rect);
+  downscale = gsk_gpu_node_processor_get_blur_downscale (self, blur_radius);
+  graphene_vec2_init (&scale,
+                      graphene_vec2_get_x (&self->scale) / downscale,
+                      graphene_vec2_get_y (&self->scale) / downscale);
+
+  /* Round to the coarsest pixel grid, which all finer ones share */
+  rect_round_to_pixels (&intermediate_rect, &scale, &self->offset, &intermediate_rect);
+
+  image = g_object_ref (source_image);
+  image_rect = *source_rect;
+
+  /* Halve the size at each step. The new pixel centers fall exactly
+   * between 4 old pixels, so linear filtering averages them all.
+   */
+  for (guint i = 2; i <= downscale; i *= 2)
+    {
+      GskGpuImage *level;
+      graphene_vec2_t level_scale;
+
+      graphene_vec2_init (&level_scale,
+                          graphene_vec2_get_x (&self->scale) / i,
+                          graphene_vec2_get_y (&self->scale) / i);
+
+      level = gsk_gpu_node_processor_init_draw (&other,
+                                                self->frame,
+                                                self->ccs,
+                                                source_depth,
+                                                &level_scale,
+                                                &intermediate_rect);
+
+      gsk_gpu_node_processor_sync_globals (&other, 0);
+
+      gsk_gpu_texture_op (other.frame,
+                          gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &intermediate_rect),
+                          &other.offset,
+                          &(GskGpuShaderImage) {
+                              image,
+                              GSK_GPU_SAMPLER_TRANSPARENT,
+                              &intermediate_rect,
+                              &image_rect
+                          });
+
+      gsk_gpu_node_processor_finish_draw (&other, level);
+
+      g_object_unref (image);
+      image = level;
+      image_rect = intermediate_rect;
+    }
 
   intermediate = gsk_gpu_node_processor_init_draw (&other,
                                                    self->frame,
                                                    self->ccs,
                                                    source_depth,
-                                                   &self->scale,
+                                                   &scale,
                                                    &intermediate_rect);
 
   gsk_gpu_node_processor_sync_globals (&other, 0);
@@ -884,19 +962,77 @@ gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
                    1,
                    &other.offset,
                    &(GskGpuShaderImage) {
-                       source_image,
+                       image,
                        GSK_GPU_SAMPLER_TRANSPARENT,
                        &intermediate_rect,
-                       source_rect
+                       &image_rect
                    },
                    &direction);
 
   gsk_gpu_node_processor_finish_draw (&other, intermediate);
 
+  g_object_unref (image);
+
   real_offset = GRAPHENE_POINT_INIT (self->offset.x + shadow_offset->x,
                                      self->offset.y + shadow_offset->y);
   graphene_vec2_init (&direction, 0.0f, blur_radius);
-  if (shadow_color)
+
+  if (downscale > 1)
+    {
+      /* Do the vertical pass at the reduced size, too, and only
+       * scale up when drawing the result.
+       */
+      image = gsk_gpu_node_processor_init_draw (&other,
+                                                self->frame,
+                                                self->ccs,
+                                                source_depth,
+                                                &scale,
+                                                &intermediate_rect);
+
+      gsk_gpu_node_processor_sync_globals (&other, 0);
+
+      gsk_gpu_blur_op (other.frame,
+                       gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &intermediate_rect),
+                       other.ccs,
+                       1,
+                       &other.offset,
+                       &(GskGpuShaderImage) {
+                           intermediate,
+                           GSK_GPU_SAMPLER_TRANSPARENT,
+                           &intermediate_rect,
+                           &intermediate_rect
+                       },
+                       &direction);
+
+      gsk_gpu_node_processor_finish_draw (&other, image);
+
+      if (shadow_color)
+        gsk_gpu_colorize_op (self->frame,
+                             gsk_gpu_clip_get_shader_clip (&self->clip, &real_offset, rect),
+                             self->ccs,
+                             1,
+                             &real_offset,
+                             &(GskGpuShaderImage) {
+                                 image,
+                                 GSK_GPU_SAMPLER_TRANSPARENT,
+                                 rect,
+                                 &intermediate_rect,
+                             },
+                             shadow_color);
+      else
+        gsk_gpu_texture_op (self->frame,
+                            gsk_gpu_clip_get_shader_clip (&self->clip, &real_offset, rect),
+                            &real_offset,
+                            &(GskGpuShaderImage) {
+                                image,
+                                GSK_GPU_SAMPLER_TRANSPARENT,
+                                rect,
+                                &intermediate_rect,
+                            });
+
+      g_object_unref (image);
+    }
+  else if (shadow_color)
     {
       gsk_gpu_blur_shadow_op (self->frame,
                               gsk_gpu_clip_get_shader_clip (&self->clip, &real_offset, rect),
@@ -1927,6 +2063,11 @@ gsk_gpu_lookup_texture (GskGpuFrame    *frame,
       return image;
     }
 
+  /* Tiled textures are never uploaded in full, they are drawn
+   * tile by tile, so only the visible part gets loaded */
+  if (GDK_IS_TILED_TEXTURE (texture))
+    return NULL;
+
   image = gsk_gpu_cache_lookup_texture_image (cache, texture, NULL);
   if (image == NULL)
     image = gsk_gpu_frame_upload_texture (frame, try_mipmap, texture);
@@ -2024,14 +2165,32 @@ gsk_gpu_node_processor_draw_texture_tiles (GskGpuNodeProcessor    *self,
 
           if (tile == NULL)
             {
-              if (memtex == NULL)
-                memtex = gdk_memory_texture_from_texture (texture);
-              subtex = gdk_memory_texture_new_subtexture (memtex,
-                                                          x * tile_size,
-                                                          y * tile_size,
-                                                          MIN (tile_size, width - x * tile_size),
-                                                          MIN (tile_size, height - y * tile_size));
-              tile = gsk_gpu_upload_texture_op_try (self->frame, need_mipmap, lod_level, scaling_filter, subtex);
+              if (GDK_IS_TILED_TEXTURE (texture))
+                {
+                  /* The loader produces the tile at the right level of detail */
+                  subtex = gdk_tiled_texture_load (GDK_TILED_TEXTURE (texture),
+                                                   lod_level,
+                                                   &(cairo_rectangle_int_t) {
+                                                       x * tile_size,
+                                                       y * tile_size,
+                                                       MIN (tile_size, width - x * tile_size),
+                                                       MIN (tile_size, height - y * tile_size)
+                                                   });
+                  if (subtex == NULL)
+                    continue;
+                  tile = gsk_gpu_upload_texture_op_try (self->frame, need_mipmap, 0, scaling_filter, subtex);
+                }
+              else
+                {
+                  if (memtex == NULL)
+                    memtex = gdk_memory_texture_from_texture (texture);
+                  subtex = gdk_memory_texture_new_subtexture (memtex,
+                                                              x * tile_size,
+                                                              y * tile_size,
+                                                              MIN (tile_size, width - x * tile_size),
+                                                              MIN (tile_size, height - y * tile_size));
+                  tile = gsk_gpu_upload_texture_op_try (self->frame, need_mipmap, lod_level, scaling_filter, subtex);
+                }
               g_object_unref (subtex);
               if (tile == NULL)
                 {
@@ -3711,7 +3870,12 @@ gsk_gpu_node_processor_add_container_node (GskGpuNodeProcessor *self,
                                            GskRenderNode       *node)
 {
   GskRenderNode **children;
-  guint n_children;
+  graphene_rect_t clip, opaque;
+  cairo_rectangle_int_t device_opaque;
+  guint stack_visible[64];
+  guint *visible;
+  guint i, n_children, n_visible;
+  gboolean have_opaque;
 
   if (self->opacity < 1.0 && !gsk_container_node_is_disjoint (node))
     {
@@ -3719,9 +3883,79 @@ gsk_gpu_node_processor_add_container_node (GskGpuNodeProcessor *self,
       return;
     }
 
+  clip = self->clip.rect.bounds;
+  clip.origin.x -= self->offset.x;
+  clip.origin.y -= self->offset.y;
+
   children = gsk_container_node_get_children (node, &n_children);
-  for (guint i = 0; i < n_children; i++)
-    gsk_gpu_node_processor_add_node (self, children[i]);
+
+  /* Children can only hide each other if they overlap and
+   * at least one of them is opaque.
+   */
+  if (gsk_container_node_is_disjoint (node) ||
+      !gsk_render_node_get_opaque_rect (node, &opaque))
+    {
+      for (i = gsk_container_node_get_next_child_in_rect (node, 0, &clip);
+           i < n_children;
+           i = gsk_container_node_get_next_child_in_rect (node, i + 1, &clip))
+        gsk_gpu_node_processor_add_node (self, children[i]);
+      return;
+    }
+
+  if (n_children <= G_N_ELEMENTS (stack_visible))
+    visible = stack_visible;
+  else
+    visible = g_new (guint, n_children);
+
+  n_visible = 0;
+  for (i = gsk_container_node_get_next_child_in_rect (node, 0, &clip);
+       i < n_children;
+       i = gsk_container_node_get_next_child_in_rect (node, i + 1, &clip))
+    visible[n_visible++] = i;
+
+  /* Walk front to back, collecting the area covered by opaque
+   * children, and drop the children that are completely behind it.
+   */
+  have_opaque = FALSE;
+  for (i = n_visible; i-- > 0; )
+    {
+      GskRenderNode *child = children[visible[i]];
+      graphene_rect_t child_opaque, child_visible;
+
+      if (have_opaque &&
+          gsk_rect_intersection (&child->bounds, &clip, &child_visible) &&
+          gsk_rect_contains_rect (&opaque, &child_visible))
+        {
+          visible[i] = G_MAXUINT;
+          continue;
+        }
+
+      /* Only whole device pixels are opaque, the edges are antialiased */
+      if (gsk_render_node_get_opaque_rect (child, &child_opaque) &&
+          gsk_gpu_node_processor_rect_to_device_shrink (self, &child_opaque, &device_opaque))
+        {
+          gsk_gpu_node_processor_rect_device_to_clip (self,
+                                                      &GSK_RECT_INIT_CAIRO (&device_opaque),
+                                                      &child_opaque);
+          child_opaque.origin.x -= self->offset.x;
+          child_opaque.origin.y -= self->offset.y;
+
+          if (have_opaque)
+            gsk_rect_coverage (&opaque, &child_opaque, &opaque);
+          else
+            opaque = child_opaque;
+          have_opaque = TRUE;
+        }
+    }
+
+  for (i = 0; i < n_visible; i++)
+    {
+      if (visible[i] != G_MAXUINT)
+        gsk_gpu_node_processor_add_node (self, children[visible[i]]);
+    }
+
+  if (visible != stack_visible)
+    g_free (visible);
 }
 
 static gboolean
@@ -14,29 +14,25 @@
 
 #include "gdk/gdkcolorstateprivate.h"
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gsk/gskdebugprivate.h"
 
-static GskGpuOp *
-gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
-                                        GskGpuFrame                 *frame,
-                                        GskGpuImage                 *image,
-                                        const cairo_rectangle_int_t *area,
-                                        void           (* draw_func) (GskGpuOp *, guchar *, gsize))
+static void
+gsk_gpu_upload_op_gl_upload (GskGpuFrame                 *frame,
+                             GskGpuImage                 *image,
+                             const cairo_rectangle_int_t *area,
+                             const guchar                *data,
+                             gsize                        stride)
 {
   GskGLImage *gl_image = GSK_GL_IMAGE (image);
   GdkMemoryFormat format;
   GdkGLContext *context;
-  gsize stride, bpp;
-  guchar *data;
+  gsize bpp;
   guint gl_format, gl_type;
 
   context = GDK_GL_CONTEXT (gsk_gpu_frame_get_context (frame));
   format = gsk_gpu_image_get_format (image);
   bpp = gdk_memory_format_bytes_per_pixel (format);
-  stride = area->width * bpp;
-  data = g_malloc (area->height * stride);
-
-  draw_func (op, data, stride);
 
   gl_format = gsk_gl_image_get_gl_format (gl_image);
   gl_type = gsk_gl_image_get_gl_type (gl_image);
@@ -49,7 +45,7 @@ gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
   /* GL_UNPACK_ROW_LENGTH is available on desktop GL, OpenGL ES >= 3.0, or if
    * the GL_EXT_unpack_subimage extension for OpenGL ES 2.0 is available
    */
-  if (stride == gsk_gpu_image_get_width (image) * bpp)
+  if (stride == area->width * bpp)
     {
       glTexSubImage2D (GL_TEXTURE_2D, 0, area->x, area->y, area->width, area->height, gl_format, gl_type, data);
     }
@@ -69,6 +65,24 @@ gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
     }
 
   glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+}
+
+static GskGpuOp *
+gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
+                                        GskGpuFrame                 *frame,
+                                        GskGpuImage                 *image,
+                                        const cairo_rectangle_int_t *area,
+                                        void           (* draw_func) (GskGpuOp *, guchar *, gsize))
+{
+  gsize stride;
+  guchar *data;
+
+  stride = area->width * gdk_memory_format_bytes_per_pixel (gsk_gpu_image_get_format (image));
+  data = g_malloc (area->height * stride);
+
+  draw_func (op, data, stride);
+
+  gsk_gpu_upload_op_gl_upload (frame, image, area, data, stride);
 
   g_free (data);
 
@@ -216,6 +230,8 @@ struct _GskGpuUploadTextureOp
   GdkTexture *texture;
   guint lod_level;
   GskScalingFilter lod_filter;
+  gboolean partial;
+  cairo_rectangle_int_t area; /* only used if partial */
 };
 
 static void
@@ -238,6 +254,10 @@ gsk_gpu_upload_texture_op_print (GskGpuOp    *op,
 
   gsk_gpu_print_op (string, indent, "upload-texture");
   gsk_gpu_print_image (string, self->image);
+  if (self->partial)
+    g_string_append_printf (string, " %d,%d %dx%d",
+                            self->area.x, self->area.y,
+                            self->area.width, self->area.height);
   if (self->lod_level > 0)
     g_string_append_printf (string, " @%ux %s",
                             1 << self->lod_level,
@@ -253,6 +273,22 @@ gsk_gpu_upload_texture_op_draw (GskGpuOp *op,
   GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
   GdkTextureDownloader *downloader;
 
+  if (self->partial)
+    {
+      GdkTexture *subtex;
+
+      subtex = gdk_memory_texture_new_subtexture (GDK_MEMORY_TEXTURE (self->texture),
+                                                  self->area.x, self->area.y,
+                                                  self->area.width, self->area.height);
+      downloader = gdk_texture_downloader_new (subtex);
+      gdk_texture_downloader_set_color_state (downloader, gdk_texture_get_color_state (subtex));
+      gdk_texture_downloader_set_format (downloader, gsk_gpu_image_get_format (self->image));
+      gdk_texture_downloader_download_into (downloader, data, stride);
+      gdk_texture_downloader_free (downloader);
+      g_object_unref (subtex);
+      return;
+    }
+
   downloader = gdk_texture_downloader_new (self->texture);
   gdk_texture_downloader_set_color_state (downloader, gdk_texture_get_color_state (self->texture));
   if (self->lod_level == 0)
@@ -290,6 +326,18 @@ gsk_gpu_upload_texture_op_vk_command (GskGpuOp              *op,
 {
   GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
 
+  /* Partial uploads go to an image that previous frames may still be
+   * reading from, so they must not write to mapped image memory.
+   */
+  if (self->partial)
+    return gsk_gpu_upload_op_vk_command_with_area (op,
+                                                   frame,
+                                                   state,
+                                                   GSK_VULKAN_IMAGE (self->image),
+                                                   &self->area,
+                                                   gsk_gpu_upload_texture_op_draw,
+                                                   &self->buffer);
+
   return gsk_gpu_upload_op_vk_command (op,
                                        frame,
                                        state,
@@ -306,6 +354,44 @@ gsk_gpu_upload_texture_op_gl_command (GskGpuOp          *op,
 {
   GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
 
+  /* If the texture's memory is already in the right format, hand it
+   * to GL directly instead of copying it into a temporary buffer first.
+   * This matters for textures backed by mapped files or shared memory.
+   */
+  if (self->lod_level == 0 &&
+      GDK_IS_MEMORY_TEXTURE (self->texture) &&
+      gdk_texture_get_format (self->texture) == gsk_gpu_image_get_format (self->image))
+    {
+      cairo_rectangle_int_t area;
+      const guchar *data;
+      GBytes *bytes;
+      gsize stride;
+
+      if (self->partial)
+        area = self->area;
+      else
+        area = (cairo_rectangle_int_t) {
+                   0, 0,
+                   gsk_gpu_image_get_width (self->image),
+                   gsk_gpu_image_get_height (self->image)
+               };
+
+      bytes = gdk_memory_texture_get_bytes (GDK_MEMORY_TEXTURE (self->texture), &stride);
+      data = g_bytes_get_data (bytes, NULL);
+      data += area.y * stride + area.x * gdk_memory_format_bytes_per_pixel (gdk_texture_get_format (self->texture));
+
+      gsk_gpu_upload_op_gl_upload (frame, self->image, &area, data, stride);
+
+      return op->next;
+    }
+
+  if (self->partial)
+    return gsk_gpu_upload_op_gl_command_with_area (op,
+                                                   frame,
+                                                   self->image,
+                                                   &self->area,
+                                                   gsk_gpu_upload_texture_op_draw);
+
   return gsk_gpu_upload_op_gl_command (op,
                                        frame,
                                        self->image,
@@ -380,6 +466,29 @@ gsk_gpu_upload_texture_op_try (GskGpuFrame      *frame,
   return g_object_ref (self->image);
 }
 
+/* Uploads @area of @texture into an @image that already contains
+ * the rest of the texture, for textures that only changed partially.
+ */
+void
+gsk_gpu_upload_texture_area_op (GskGpuFrame                 *frame,
+                                GskGpuImage                 *image,
+                                GdkTexture                  *texture,
+                                const cairo_rectangle_int_t *area)
+{
+  GskGpuUploadTextureOp *self;
+
+  g_assert (GDK_IS_MEMORY_TEXTURE (texture));
+
+  self = (GskGpuUploadTextureOp *) gsk_gpu_op_alloc (frame, &GSK_GPU_UPLOAD_TEXTURE_OP_CLASS);
+
+  self->texture = g_object_ref (texture);
+  self->lod_level = 0;
+  self->lod_filter = GSK_SCALING_FILTER_NEAREST;
+  self->image = g_object_ref (image);
+  self->partial = TRUE;
+  self->area = *area;
+}
+
 typedef struct _GskGpuUploadCairoOp GskGpuUploadCairoOp;
 
 struct _GskGpuUploadCairoOp
@@ -15,6 +15,11 @@ GskGpuImage *           gsk_gpu_upload_texture_op_try                   (GskGpuF
                                                                          GskScalingFilter                lod_filter,
                                                                          GdkTexture                     *texture);
 
+void                    gsk_gpu_upload_texture_area_op                  (GskGpuFrame                    *frame,
+                                                                         GskGpuImage                    *image,
+                                                                         GdkTexture                     *texture,
+                                                                         const cairo_rectangle_int_t    *area);
+
 GskGpuImage *           gsk_gpu_upload_cairo_op                         (GskGpuFrame                    *frame,
                                                                          const graphene_vec2_t          *scale,
                                                                          const graphene_rect_t          *viewport,
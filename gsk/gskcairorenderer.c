@@ -27,8 +27,14 @@
 #include "gskrendernodeprivate.h"
 #include "gdk/gdkcolorstateprivate.h"
 #include "gdk/gdkdrawcontextprivate.h"
+#include "gdk/gdkparalleltaskprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <pango/pangocairo.h>
+
+/* Height of the bands, in pixels, that are drawn in parallel */
+#define BAND_HEIGHT 64
+
 typedef struct {
   GQuark cpu_time;
   GQuark gpu_time;
@@ -72,6 +78,270 @@ gsk_cairo_renderer_unrealize (GskRenderer *renderer)
   g_clear_object (&self->cairo_context);
 }
 
+/* Checks that drawing @node does not touch any shared state that
+ * is not thread-safe, so that it can be drawn into multiple bands
+ * at once. The textures of @node are added to @cache, so they only
+ * need to be downloaded once, and not by every band.
+ */
+static gboolean
+gsk_cairo_node_can_draw_in_thread (GskRenderNode        *node,
+                                   GskCairoTextureCache *cache)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i;
+
+        for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+          {
+            if (!gsk_cairo_node_can_draw_in_thread (gsk_container_node_get_child (node, i), cache))
+              return FALSE;
+          }
+        return TRUE;
+      }
+
+    case GSK_TEXTURE_NODE:
+    case GSK_TEXTURE_SCALE_NODE:
+      {
+        GdkTexture *texture;
+
+        if (gsk_render_node_get_node_type (node) == GSK_TEXTURE_NODE)
+          texture = gsk_texture_node_get_texture (node);
+        else
+          texture = gsk_texture_scale_node_get_texture (node);
+
+        /* Other textures may need a GL context to download */
+        if (!GDK_IS_MEMORY_TEXTURE (texture))
+          return FALSE;
+
+        gsk_cairo_texture_cache_add (cache, texture);
+        return TRUE;
+      }
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font = gsk_text_node_get_font (node);
+
+        if (!PANGO_IS_CAIRO_FONT (font))
+          return FALSE;
+
+        /* Pango creates the scaled font on first use, make sure that
+         * happens here and not in multiple threads at once.
+         */
+        return pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)) != NULL;
+      }
+
+    case GSK_CAIRO_NODE:
+      /* The surface would be used as a source in multiple threads,
+       * and cairo attaches snapshots to sources.
+       */
+      return FALSE;
+
+    case GSK_TRANSFORM_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_transform_node_get_child (node), cache);
+
+    case GSK_OPACITY_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_opacity_node_get_child (node), cache);
+
+    case GSK_COLOR_MATRIX_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_color_matrix_node_get_child (node), cache);
+
+    case GSK_REPEAT_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_repeat_node_get_child (node), cache);
+
+    case GSK_CLIP_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_clip_node_get_child (node), cache);
+
+    case GSK_ROUNDED_CLIP_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_rounded_clip_node_get_child (node), cache);
+
+    case GSK_SHADOW_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_shadow_node_get_child (node), cache);
+
+    case GSK_BLUR_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_blur_node_get_child (node), cache);
+
+    case GSK_DEBUG_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_debug_node_get_child (node), cache);
+
+    case GSK_FILL_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_fill_node_get_child (node), cache);
+
+    case GSK_STROKE_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_stroke_node_get_child (node), cache);
+
+    case GSK_SUBSURFACE_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_subsurface_node_get_child (node), cache);
+
+    case GSK_BLEND_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_blend_node_get_bottom_child (node), cache) &&
+             gsk_cairo_node_can_draw_in_thread (gsk_blend_node_get_top_child (node), cache);
+
+    case GSK_CROSS_FADE_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_cross_fade_node_get_start_child (node), cache) &&
+             gsk_cairo_node_can_draw_in_thread (gsk_cross_fade_node_get_end_child (node), cache);
+
+    case GSK_MASK_NODE:
+      return gsk_cairo_node_can_draw_in_thread (gsk_mask_node_get_source (node), cache) &&
+             gsk_cairo_node_can_draw_in_thread (gsk_mask_node_get_mask (node), cache);
+
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_GL_SHADER_NODE:
+      return TRUE;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+typedef struct _ParallelDraw ParallelDraw;
+
+struct _ParallelDraw
+{
+  GskRenderNode          *root;
+  GdkColorState          *ccs;
+  GskCairoTextureCache   *cache;
+  cairo_matrix_t          matrix;
+  cairo_rectangle_list_t *clip;
+
+  guchar                 *data;
+  cairo_format_t          format;
+  int                     width;
+  int                     stride;
+  double                  x_scale, y_scale;
+  double                  x_offset, y_offset;
+  int                     y;
+  int                     height;
+
+  /* atomic */ int        bands_done;
+};
+
+static void
+gsk_cairo_renderer_draw_bands (gpointer data)
+{
+  ParallelDraw *draw = data;
+  int band, i;
+
+  for (band = g_atomic_int_add (&draw->bands_done, 1);
+       band * BAND_HEIGHT < draw->height;
+       band = g_atomic_int_add (&draw->bands_done, 1))
+    {
+      int y = draw->y + band * BAND_HEIGHT;
+      cairo_surface_t *surface;
+      cairo_t *cr;
+
+      surface = cairo_image_surface_create_for_data (draw->data + y * draw->stride,
+                                                     draw->format,
+                                                     draw->width,
+                                                     MIN (BAND_HEIGHT, draw->y + draw->height - y),
+                                                     draw->stride);
+      cairo_surface_set_device_scale (surface, draw->x_scale, draw->y_scale);
+      cairo_surface_set_device_offset (surface, draw->x_offset, draw->y_offset - y);
+      gsk_cairo_texture_cache_attach (draw->cache, surface);
+
+      cr = cairo_create (surface);
+      cairo_set_matrix (cr, &draw->matrix);
+      for (i = 0; i < draw->clip->num_rectangles; i++)
+        {
+          const cairo_rectangle_t *r = &draw->clip->rectangles[i];
+
+          cairo_rectangle (cr, r->x, r->y, r->width, r->height);
+        }
+      cairo_clip (cr);
+
+      gsk_render_node_draw_with_color_state (draw->root, cr, draw->ccs);
+
+      cairo_destroy (cr);
+      cairo_surface_finish (surface);
+      cairo_surface_destroy (surface);
+    }
+}
+
+/* Splits the clip region of @cr into bands and draws them in
+ * parallel. Returns FALSE if that is not possible, and nothing
+ * has been drawn.
+ */
+static gboolean
+gsk_cairo_renderer_draw_parallel (cairo_t       *cr,
+                                  GdkColorState *ccs,
+                                  GskRenderNode *root)
+{
+  ParallelDraw draw;
+  cairo_surface_t *target;
+  double x1, y1, x2, y2;
+
+  target = cairo_get_target (cr);
+  if (cairo_surface_get_type (target) != CAIRO_SURFACE_TYPE_IMAGE)
+    return FALSE;
+
+  cairo_get_matrix (cr, &draw.matrix);
+  if (draw.matrix.xy != 0 || draw.matrix.yx != 0)
+    return FALSE;
+
+  cairo_surface_get_device_scale (target, &draw.x_scale, &draw.y_scale);
+  cairo_surface_get_device_offset (target, &draw.x_offset, &draw.y_offset);
+
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+  cairo_user_to_device (cr, &x1, &y1);
+  cairo_user_to_device (cr, &x2, &y2);
+  y1 = y1 * draw.y_scale + draw.y_offset;
+  y2 = y2 * draw.y_scale + draw.y_offset;
+  draw.y = MAX (0, floor (MIN (y1, y2)));
+  draw.height = MIN (cairo_image_surface_get_height (target), ceil (MAX (y1, y2))) - draw.y;
+
+  /* Not worth the overhead */
+  if (draw.height <= BAND_HEIGHT)
+    return FALSE;
+
+  draw.clip = cairo_copy_clip_rectangle_list (cr);
+  if (draw.clip->status != CAIRO_STATUS_SUCCESS)
+    {
+      cairo_rectangle_list_destroy (draw.clip);
+      return FALSE;
+    }
+
+  /* Textures are downloaded here, while we are not inside a parallel
+   * task yet, so the conversions can run in parallel themselves.
+   */
+  draw.cache = gsk_cairo_texture_cache_new (ccs);
+  if (!gsk_cairo_node_can_draw_in_thread (root, draw.cache))
+    {
+      gsk_cairo_texture_cache_free (draw.cache);
+      cairo_rectangle_list_destroy (draw.clip);
+      return FALSE;
+    }
+
+  draw.root = root;
+  draw.ccs = ccs;
+  draw.data = cairo_image_surface_get_data (target);
+  draw.format = cairo_image_surface_get_format (target);
+  draw.width = cairo_image_surface_get_width (target);
+  draw.stride = cairo_image_surface_get_stride (target);
+  draw.bands_done = 0;
+
+  cairo_surface_flush (target);
+
+  gdk_parallel_task_run (gsk_cairo_renderer_draw_bands, &draw);
+
+  cairo_surface_mark_dirty (target);
+
+  gsk_cairo_texture_cache_free (draw.cache);
+  cairo_rectangle_list_destroy (draw.clip);
+
+  return TRUE;
+}
+
 static void
 gsk_cairo_renderer_do_render (GskRenderer   *renderer,
                               cairo_t       *cr,
@@ -85,7 +355,8 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   profiler = gsk_renderer_get_profiler (renderer);
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 
-  gsk_render_node_draw_with_color_state (root, cr, ccs);
+  if (!gsk_cairo_renderer_draw_parallel (cr, ccs, root))
+    gsk_render_node_draw_with_color_state (root, cr, ccs);
 
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
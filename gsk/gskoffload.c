@@ -53,7 +53,8 @@ struct _GskOffload
 
   Clip *current_clip;
 
-  GskOffloadInfo *last_info;
+  GskOffloadInfo **offloadable;
+  gsize n_offloadable;
 };
 
 static GdkDihedral
@@ -69,22 +70,18 @@ find_texture_transform (GskTransform *transform)
   return dihedral;
 }
 
-static gboolean
-color_is_black (const GdkColor *color)
-{
-  return color->red < 255.f / 65535.f &&
-         color->green < 255.f / 65535.f &&
-         color->blue < 255.f / 65535.f &&
-         color->alpha > 65280.f / 65535.f;
-}
-
+/* @outer_clip is the clip that is in effect for the subsurface node,
+ * in the coordinate system of the subsurface node, or %NULL if the
+ * subsurface node is not clipped.
+ */
 static GdkTexture *
-find_texture_to_attach (GskOffload          *self,
-                        const GskRenderNode *subsurface_node,
-                        graphene_rect_t     *out_texture_rect,
-                        graphene_rect_t     *out_source_rect,
-                        gboolean            *has_background,
-                        GdkDihedral         *out_texture_transform)
+find_texture_to_attach (GskOffload             *self,
+                        const GskRenderNode    *subsurface_node,
+                        const graphene_rect_t  *outer_clip,
+                        graphene_rect_t        *out_texture_rect,
+                        graphene_rect_t        *out_source_rect,
+                        const GdkColor        **out_background_color,
+                        GdkDihedral            *out_texture_transform)
 {
   GdkSubsurface *subsurface;
   const GskRenderNode *node;
@@ -93,9 +90,15 @@ find_texture_to_attach (GskOffload          *self,
   GskTransform *transform = NULL;
   GdkTexture *ret = NULL;
 
-  *has_background = FALSE;
+  *out_background_color = NULL;
   *out_texture_transform = GDK_DIHEDRAL_NORMAL;
 
+  if (outer_clip)
+    {
+      clip = *outer_clip;
+      has_clip = TRUE;
+    }
+
   subsurface = gsk_subsurface_node_get_subsurface (subsurface_node);
   node = subsurface_node;
 
@@ -125,9 +128,9 @@ find_texture_to_attach (GskOffload          *self,
               gsk_transform_transform_bounds (transform, &child->bounds, &bounds);
               if (GSK_RENDER_NODE_TYPE (child) == GSK_COLOR_NODE &&
                   gsk_rect_equal (&bounds, &subsurface_node->bounds) &&
-                  color_is_black (gsk_color_node_get_color2 (child)))
+                  gdk_color_is_opaque (gsk_color_node_get_color2 (child)))
                 {
-                  *has_background = TRUE;
+                  *out_background_color = gsk_color_node_get_color2 (child);
                   node = gsk_container_node_get_child (node, 1);
                   break;
                 }
@@ -180,7 +183,6 @@ find_texture_to_attach (GskOffload          *self,
               }
             else
               {
-                gsk_transform_transform_bounds (transform, &node->bounds, out_texture_rect);
                 clip = *c;
                 has_clip = TRUE;
               }
@@ -192,6 +194,7 @@ find_texture_to_attach (GskOffload          *self,
         case GSK_TEXTURE_NODE:
           {
             GdkTexture *texture = gsk_texture_node_get_texture (node);
+            graphene_rect_t texture_rect;
             int width, height;
 
             if (gsk_transform_get_fine_category (transform) < GSK_FINE_TRANSFORM_CATEGORY_2D_DIHEDRAL)
@@ -216,23 +219,35 @@ find_texture_to_attach (GskOffload          *self,
                 height = tmp;
               }
 
+            gsk_transform_transform_bounds (transform, &node->bounds, &texture_rect);
+
             if (has_clip)
               {
-                float dx = node->bounds.origin.x;
-                float dy = node->bounds.origin.y;
-                float sx = width / node->bounds.size.width;
-                float sy = height / node->bounds.size.height;
+                float sx, sy;
 
-                gsk_rect_intersection (&node->bounds, &clip, &clip);
+                if (!gsk_rect_intersection (&node->bounds, &clip, &clip))
+                  {
+                    GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
+                                       "[%p] 🗙 Texture is clipped away", subsurface);
+                    goto out;
+                  }
 
-                out_source_rect->origin.x = (clip.origin.x - dx) * sx;
-                out_source_rect->origin.y = (clip.origin.y - dy) * sy;
-                out_source_rect->size.width = clip.size.width * sx;
-                out_source_rect->size.height = clip.size.height * sy;
+                /* The source rectangle is applied after the buffer transform,
+                 * so compute it from the transformed rectangles.
+                 */
+                gsk_transform_transform_bounds (transform, &clip, out_texture_rect);
+
+                sx = width / texture_rect.size.width;
+                sy = height / texture_rect.size.height;
+
+                out_source_rect->origin.x = (out_texture_rect->origin.x - texture_rect.origin.x) * sx;
+                out_source_rect->origin.y = (out_texture_rect->origin.y - texture_rect.origin.y) * sy;
+                out_source_rect->size.width = out_texture_rect->size.width * sx;
+                out_source_rect->size.height = out_texture_rect->size.height * sy;
               }
             else
               {
-                gsk_transform_transform_bounds (transform, &node->bounds, out_texture_rect);
+                *out_texture_rect = texture_rect;
                 out_source_rect->origin.x = 0;
                 out_source_rect->origin.y = 0;
                 out_source_rect->size.width = width;
@@ -486,22 +501,47 @@ find_subsurface_info (GskOffload    *self,
 }
 
 static void
-visit_node (GskOffload    *self,
-            GskRenderNode *node)
+lower_subsurface (GskOffload     *self,
+                  GskOffloadInfo *info)
 {
-  gboolean has_clip;
-  graphene_rect_t transformed_bounds;
+  info->can_raise = FALSE;
 
-  transform_bounds (self, &node->bounds, &transformed_bounds);
+  /* Subsurfaces drawn before this one must stay below it */
+  for (gsize i = 0; i < self->n_offloadable && self->offloadable[i] != info; i++)
+    {
+      GskOffloadInfo *below = self->offloadable[i];
 
+      if (below->can_raise &&
+          (gsk_rect_intersects (&info->background_rect, &below->texture_rect) ||
+           gsk_rect_intersects (&info->background_rect, &below->background_rect)))
+        {
+          GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
+                             "[%p]   Lowering because subsurface %p is lowered",
+                             below->subsurface, info->subsurface);
+          lower_subsurface (self, below);
+        }
+    }
+}
+
+static void
+lower_overlapped_subsurfaces (GskOffload            *self,
+                              GskRenderNode         *node,
+                              const graphene_rect_t *transformed_bounds)
+{
   for (gsize i = 0; i < self->n_subsurfaces; i++)
     {
       GskOffloadInfo *info = &self->subsurfaces[i];
 
       if (info->can_raise)
         {
-          if (gsk_rect_intersects (&transformed_bounds, &info->texture_rect) ||
-              gsk_rect_intersects (&transformed_bounds, &info->background_rect))
+          graphene_rect_t visible;
+
+          /* Content that is clipped away can't cover the subsurface */
+          if (!gsk_rect_intersection (transformed_bounds, &self->current_clip->rect.bounds, &visible))
+            continue;
+
+          if (gsk_rect_intersects (&visible, &info->texture_rect) ||
+              gsk_rect_intersects (&visible, &info->background_rect))
             {
               GskRenderNodeType type = GSK_RENDER_NODE_TYPE (node);
 
@@ -515,11 +555,27 @@ visit_node (GskOffload    *self,
                                      "[%p]   Lowering because a %s overlaps",
                                      info->subsurface,
                                      g_type_name_from_instance ((GTypeInstance *) node));
-                  info->can_raise = FALSE;
+                  lower_subsurface (self, info);
                 }
             }
         }
     }
+}
+
+static void
+visit_node (GskOffload    *self,
+            GskRenderNode *node)
+{
+  gboolean has_clip;
+  graphene_rect_t transformed_bounds;
+
+  transform_bounds (self, &node->bounds, &transformed_bounds);
+
+  /* A subsurface node only covers others if it is not offloaded,
+   * that is decided below.
+   */
+  if (GSK_RENDER_NODE_TYPE (node) != GSK_SUBSURFACE_NODE)
+    lower_overlapped_subsurfaces (self, node, &transformed_bounds);
 
   has_clip = update_clip (self, &transformed_bounds);
 
@@ -650,6 +706,7 @@ complex_clip:
       {
         GdkSubsurface *subsurface = gsk_subsurface_node_get_subsurface (node);
         GskTransform *transform;
+        gboolean offloaded = FALSE;
 
         GskOffloadInfo *info = find_subsurface_info (self, subsurface);
 
@@ -661,7 +718,16 @@ complex_clip:
                                "[%p] 🗙 Unknown subsurface",
                                subsurface);
           }
-        else if (!self->current_clip->is_fully_contained)
+        else if (info->can_offload)
+          {
+            GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
+                               "[%p] 🗙 Subsurface is used more than once",
+                               subsurface);
+          }
+        else if (!self->current_clip->is_fully_contained &&
+                 (self->current_clip->is_empty ||
+                  self->current_clip->is_complex ||
+                  !self->current_clip->is_rectilinear))
           {
             GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
                                "[%p] 🗙 Clipped",
@@ -675,26 +741,53 @@ complex_clip:
           }
         else
           {
-            gboolean has_background;
+            gboolean clipped = !self->current_clip->is_fully_contained;
+            graphene_rect_t outer_clip;
             float sx, sy, dx, dy;
             GdkDihedral context_transform;
             GdkDihedral inner_transform;
 
             gsk_transform_to_dihedral (transform, &context_transform, &sx, &sy, &dx, &dy);
 
-            info->texture = find_texture_to_attach (self, node, &info->texture_rect, &info->source_rect, &has_background, &inner_transform);
+            /* A rectangular clip can be applied by cropping the texture
+             * with the source rectangle, so map it back into the coordinate
+             * system of the subsurface node.
+             */
+            if (clipped)
+              {
+                GskTransform *inv = gsk_transform_invert (gsk_transform_ref (transform));
+                gsk_transform_transform_bounds (inv, &self->current_clip->rect.bounds, &outer_clip);
+                gsk_transform_unref (inv);
+              }
+
+            info->texture = find_texture_to_attach (self, node,
+                                                    clipped ? &outer_clip : NULL,
+                                                    &info->texture_rect,
+                                                    &info->source_rect,
+                                                    &info->background_color,
+                                                    &inner_transform);
             if (info->texture)
               {
                 info->transform = gdk_dihedral_combine (context_transform, inner_transform);
                 info->can_offload = TRUE;
                 info->can_raise = TRUE;
                 transform_bounds (self, &info->texture_rect, &info->texture_rect);
-                info->has_background = has_background;
+                info->has_background = info->background_color != NULL;
                 transform_bounds (self, &node->bounds, &info->background_rect);
-                info->place_above = self->last_info ? self->last_info->subsurface : NULL;
-                self->last_info = info;
+                if (clipped)
+                  gsk_rect_intersection (&info->background_rect,
+                                         &self->current_clip->rect.bounds,
+                                         &info->background_rect);
+                self->offloadable[self->n_offloadable++] = info;
+                offloaded = TRUE;
               }
           }
+
+        /* An offloaded subsurface is stacked above the earlier ones, but
+         * if we draw the content, it covers them like any other node.
+         */
+        if (!offloaded)
+          lower_overlapped_subsurfaces (self, node, &transformed_bounds);
       }
       break;
 
@@ -714,6 +807,8 @@ gsk_offload_new (GdkSurface     *surface,
                  cairo_region_t *diff)
 {
   GskOffload *self;
+  GdkSubsurface *last_above = NULL;
+  GdkSubsurface *last_below = NULL;
 
   self = g_new0 (GskOffload, 1);
 
@@ -721,10 +816,10 @@ gsk_offload_new (GdkSurface     *surface,
   self->transforms = NULL;
   self->clips = NULL;
 
-  self->last_info = NULL;
-
   self->n_subsurfaces = gdk_surface_get_n_subsurfaces (self->surface);
   self->subsurfaces = g_new0 (GskOffloadInfo, self->n_subsurfaces);
+  self->offloadable = g_new0 (GskOffloadInfo *, self->n_subsurfaces);
+  self->n_offloadable = 0;
 
   for (gsize i = 0; i < self->n_subsurfaces; i++)
     {
@@ -735,6 +830,7 @@ gsk_offload_new (GdkSurface     *surface,
       info->was_offloaded = gdk_subsurface_get_texture (info->subsurface) != NULL;
       info->was_above = gdk_subsurface_is_above_parent (info->subsurface);
       info->had_background = gdk_subsurface_get_background_rect (info->subsurface, &rect);
+      gdk_subsurface_get_bounds (info->subsurface, &info->old_bounds);
     }
 
   if (self->n_subsurfaces > 0)
@@ -748,35 +844,53 @@ gsk_offload_new (GdkSurface     *surface,
       pop_clip (self);
     }
 
-  for (gsize i = 0; i < self->n_subsurfaces; i++)
+  /* Attach the subsurfaces in the order they are drawn, and stack
+   * each one directly above the previous one in the same layer. That
+   * keeps the stacking stable from frame to frame, so we only restack
+   * when the order actually changes.
+   */
+  for (gsize i = 0; i < self->n_offloadable; i++)
     {
-      GskOffloadInfo *info = &self->subsurfaces[i];
-      graphene_rect_t old_bounds;
-      graphene_rect_t bounds;
-
-      gdk_subsurface_get_bounds (info->subsurface, &old_bounds);
+      GskOffloadInfo *info = self->offloadable[i];
 
-      if (info->can_offload)
+      if (info->can_raise)
         {
-          if (info->can_raise)
-            info->is_offloaded = gdk_subsurface_attach (info->subsurface,
-                                                        info->texture,
-                                                        &info->source_rect,
-                                                        &info->texture_rect,
-                                                        info->transform,
-                                                        info->has_background ? &info->background_rect : NULL,
-                                                        TRUE, NULL);
-          else
-            info->is_offloaded = gdk_subsurface_attach (info->subsurface,
-                                                        info->texture,
-                                                        &info->source_rect,
-                                                        &info->texture_rect,
-                                                        info->transform,
-                                                        info->has_background ? &info->background_rect : NULL,
-                                                        info->place_above != NULL,
-                                                        info->place_above);
+          info->place_above = last_above;
+          info->is_offloaded = gdk_subsurface_attach (info->subsurface,
+                                                      info->texture,
+                                                      &info->source_rect,
+                                                      &info->texture_rect,
+                                                      info->transform,
+                                                      info->has_background ? &info->background_rect : NULL,
+                                                      info->background_color,
+                                                      TRUE,
+                                                      info->place_above);
+          if (info->is_offloaded)
+            last_above = info->subsurface;
         }
       else
+        {
+          info->place_above = last_below;
+          info->is_offloaded = gdk_subsurface_attach (info->subsurface,
+                                                      info->texture,
+                                                      &info->source_rect,
+                                                      &info->texture_rect,
+                                                      info->transform,
+                                                      info->has_background ? &info->background_rect : NULL,
+                                                      info->background_color,
+                                                      info->place_above != NULL,
+                                                      info->place_above);
+          if (info->is_offloaded)
+            last_below = info->subsurface;
+        }
+    }
+
+  for (gsize i = 0; i < self->n_subsurfaces; i++)
+    {
+      GskOffloadInfo *info = &self->subsurfaces[i];
+      graphene_rect_t bounds;
+
+      if (!info->can_offload)
         {
           info->is_offloaded = FALSE;
           if (info->was_offloaded)
@@ -789,7 +903,7 @@ gsk_offload_new (GdkSurface     *surface,
 
       if (info->is_offloaded != info->was_offloaded ||
           info->is_above != info->was_above ||
-          (info->is_offloaded && !gsk_rect_equal (&bounds, &old_bounds)))
+          (info->is_offloaded && !gsk_rect_equal (&bounds, &info->old_bounds)))
         {
           /* We changed things, need to invalidate everything */
           cairo_rectangle_int_t rect;
@@ -801,7 +915,7 @@ gsk_offload_new (GdkSurface     *surface,
             }
           if (info->was_offloaded)
             {
-              gsk_rect_to_cairo_grow (&old_bounds, &rect);
+              gsk_rect_to_cairo_grow (&info->old_bounds, &rect);
               cairo_region_union_rectangle (diff, &rect);
             }
         }
@@ -814,6 +928,7 @@ gsk_offload_new (GdkSurface     *surface,
 void
 gsk_offload_free (GskOffload *self)
 {
+  g_free (self->offloadable);
   g_free (self->subsurfaces);
   g_free (self);
 }
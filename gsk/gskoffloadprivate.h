@@ -35,6 +35,8 @@ typedef struct
   graphene_rect_t source_rect;
   GdkDihedral transform;
   graphene_rect_t background_rect;
+  const GdkColor *background_color;
+  graphene_rect_t old_bounds;
 
   guint was_offloaded : 1;
   guint can_offload   : 1;
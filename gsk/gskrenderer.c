@@ -39,6 +39,7 @@
 #include "gskdebugprivate.h"
 #include "gskprofilerprivate.h"
 #include "gskrendernodeprivate.h"
+#include "gskrendernodeparserprivate.h"
 #include "gskoffloadprivate.h"
 
 #include "gskenumtypes.h"
@@ -81,6 +82,7 @@ typedef struct
   GskRenderNode *prev_node;
 
   GskProfiler *profiler;
+  GskRenderTraceWriter *trace;
 
   GskDebugFlags debug_flags;
 
@@ -258,6 +260,46 @@ gsk_renderer_is_realized (GskRenderer *renderer)
   return priv->is_realized;
 }
 
+static void
+gsk_renderer_start_trace (GskRenderer *renderer)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  static int n_traces = 0;
+  const char *path;
+  char *filename;
+  GFile *file;
+  GFileOutputStream *stream;
+  GError *error = NULL;
+  int n;
+
+  path = g_getenv ("GSK_TRACE");
+  if (path == NULL || *path == '\0')
+    return;
+
+  /* Every surface gets its own trace */
+  n = g_atomic_int_add (&n_traces, 1);
+  if (n == 0)
+    filename = g_strdup (path);
+  else
+    filename = g_strdup_printf ("%s.%d", path, n + 1);
+
+  file = g_file_new_for_path (filename);
+  stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &error);
+  if (stream)
+    {
+      priv->trace = gsk_render_trace_writer_new (G_OUTPUT_STREAM (stream));
+      g_object_unref (stream);
+    }
+  else
+    {
+      g_warning ("Failed to record frames to %s: %s", filename, error->message);
+      g_error_free (error);
+    }
+
+  g_object_unref (file);
+  g_free (filename);
+}
+
 static gboolean
 gsk_renderer_do_realize (GskRenderer  *renderer,
                          GdkDisplay   *display,
@@ -277,6 +319,9 @@ gsk_renderer_do_realize (GskRenderer  *renderer,
 
   priv->is_realized = TRUE;
 
+  if (surface)
+    gsk_renderer_start_trace (renderer);
+
   g_object_notify (G_OBJECT (renderer), "realized");
   if (surface)
     g_object_notify (G_OBJECT (renderer), "surface");
@@ -381,6 +426,7 @@ gsk_renderer_unrealize (GskRenderer *renderer)
 
   g_clear_object (&priv->surface);
   g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->trace, gsk_render_trace_writer_free);
 
   priv->is_realized = FALSE;
 
@@ -461,6 +507,7 @@ gsk_renderer_render (GskRenderer          *renderer,
   GskRendererClass *renderer_class;
   cairo_region_t *clip;
   GskOffload *offload;
+  gint64 start_time;
 
   g_return_if_fail (GSK_IS_RENDERER (renderer));
   g_return_if_fail (priv->is_realized);
@@ -492,8 +539,23 @@ gsk_renderer_render (GskRenderer          *renderer,
       gsk_render_node_diff (priv->prev_node, root, &(GskDiffData) { clip, priv->surface });
     }
 
+  start_time = g_get_monotonic_time ();
+
   renderer_class->render (renderer, root, clip);
 
+  if (priv->trace &&
+      !gsk_render_trace_writer_add_frame (priv->trace,
+                                          root,
+                                          clip,
+                                          gdk_surface_get_width (priv->surface),
+                                          gdk_surface_get_height (priv->surface),
+                                          start_time,
+                                          g_get_monotonic_time () - start_time))
+    {
+      g_warning ("Failed to record frame, stopping");
+      g_clear_pointer (&priv->trace, gsk_render_trace_writer_free);
+    }
+
   g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
   cairo_region_destroy (clip);
   g_clear_pointer (&offload, gsk_offload_free);
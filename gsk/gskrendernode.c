@@ -161,6 +161,20 @@ gsk_render_node_real_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, data);
 }
 
+static guint
+gsk_render_node_real_hash (GskRenderNode *node)
+{
+  /* Nodes that can't be compared structurally only equal themselves */
+  return g_direct_hash (node);
+}
+
+static gboolean
+gsk_render_node_real_equal (GskRenderNode *node1,
+                            GskRenderNode *node2)
+{
+  return FALSE;
+}
+
 static gboolean
 gsk_render_node_real_get_opaque_rect (GskRenderNode   *node,
                                       graphene_rect_t *out_opaque)
@@ -175,6 +189,8 @@ gsk_render_node_class_init (GskRenderNodeClass *klass)
   klass->finalize = gsk_render_node_finalize;
   klass->can_diff = gsk_render_node_real_can_diff;
   klass->diff = gsk_render_node_real_diff;
+  klass->hash = gsk_render_node_real_hash;
+  klass->equal = gsk_render_node_real_equal;
   klass->get_opaque_rect = gsk_render_node_real_get_opaque_rect;
 }
 
@@ -536,6 +552,64 @@ gsk_render_node_can_diff (const GskRenderNode *node1,
   return FALSE;
 }
 
+/*
+ * gsk_render_node_get_hash:
+ * @node: a `GskRenderNode`
+ *
+ * Gets a hash of the contents of @node.
+ *
+ * Nodes that render the same have the same hash, even if they
+ * were created independently. The hash of child nodes is combined
+ * into the hash of their parent, so comparing hashes of two subtrees
+ * is a quick way to find out that they differ.
+ *
+ * The hash is computed on first use and cached in the node.
+ *
+ * Returns: the hash of @node
+ */
+guint
+gsk_render_node_get_hash (GskRenderNode *node)
+{
+  guint hash;
+
+  hash = g_atomic_int_get (&node->hash);
+  if (G_UNLIKELY (hash == 0))
+    {
+      hash = GSK_RENDER_NODE_GET_CLASS (node)->hash (node);
+      if (hash == 0)
+        hash = 1;
+      g_atomic_int_set (&node->hash, hash);
+    }
+
+  return hash;
+}
+
+/*
+ * gsk_render_node_equal:
+ * @node1: a `GskRenderNode`
+ * @node2: the `GskRenderNode` to compare with
+ *
+ * Checks if two nodes are known to render the same.
+ *
+ * Nodes with different hashes are rejected right away, so
+ * this is cheap for differing nodes.
+ *
+ * Returns: %TRUE if @node1 and @node2 render the same
+ */
+gboolean
+gsk_render_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  if (node1 == node2)
+    return TRUE;
+
+  if (gsk_render_node_get_node_type (node1) != gsk_render_node_get_node_type (node2) ||
+      gsk_render_node_get_hash (node1) != gsk_render_node_get_hash (node2))
+    return FALSE;
+
+  return GSK_RENDER_NODE_GET_CLASS (node1)->equal (node1, node2);
+}
+
 static void
 rectangle_init_from_graphene (cairo_rectangle_int_t *cairo,
                               const graphene_rect_t *graphene)
@@ -582,7 +656,7 @@ gsk_render_node_diff (GskRenderNode  *node1,
                       GskRenderNode  *node2,
                       GskDiffData    *data)
 {
-  if (node1 == node2)
+  if (gsk_render_node_equal (node1, node2))
     return;
 
   if (gsk_render_node_get_node_type (node1) == gsk_render_node_get_node_type (node2))
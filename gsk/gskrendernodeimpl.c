@@ -66,6 +66,113 @@
  */
 G_LOCK_DEFINE_STATIC (rgba);
 
+/* {{{ Cairo texture cache */
+
+/* Holds textures that have been downloaded ahead of time. When a node
+ * is drawn in multiple parts, this avoids downloading and converting
+ * the same texture for every part.
+ */
+struct _GskCairoTextureCache
+{
+  GdkColorState *ccs;
+  GHashTable *surfaces;
+};
+
+static const cairo_user_data_key_t texture_cache_key;
+static const cairo_user_data_key_t texture_cache_pixels_key;
+
+GskCairoTextureCache *
+gsk_cairo_texture_cache_new (GdkColorState *ccs)
+{
+  GskCairoTextureCache *cache;
+
+  cache = g_new (GskCairoTextureCache, 1);
+  cache->ccs = gdk_color_state_ref (ccs);
+  cache->surfaces = g_hash_table_new_full (NULL, NULL,
+                                           g_object_unref,
+                                           (GDestroyNotify) cairo_surface_destroy);
+
+  return cache;
+}
+
+void
+gsk_cairo_texture_cache_free (GskCairoTextureCache *cache)
+{
+  g_hash_table_unref (cache->surfaces);
+  gdk_color_state_unref (cache->ccs);
+  g_free (cache);
+}
+
+void
+gsk_cairo_texture_cache_add (GskCairoTextureCache *cache,
+                             GdkTexture           *texture)
+{
+  /* Oversized textures are drawn in tiles */
+  if (gdk_texture_get_width (texture) > MAX_CAIRO_IMAGE_WIDTH ||
+      gdk_texture_get_height (texture) > MAX_CAIRO_IMAGE_HEIGHT)
+    return;
+
+  if (g_hash_table_contains (cache->surfaces, texture))
+    return;
+
+  g_hash_table_insert (cache->surfaces,
+                       g_object_ref (texture),
+                       gdk_texture_download_surface (texture, cache->ccs));
+}
+
+/* Makes the cache available to all drawing into @target. The cache
+ * must stay alive until that drawing is done, and it must not be
+ * changed anymore, so multiple threads can look things up. The cached
+ * surfaces themselves are never handed out, only their pixels.
+ */
+void
+gsk_cairo_texture_cache_attach (GskCairoTextureCache *cache,
+                                cairo_surface_t      *target)
+{
+  cairo_surface_set_user_data (target, &texture_cache_key, cache, NULL);
+}
+
+static cairo_surface_t *
+gsk_cairo_download_texture (cairo_t       *cr,
+                            GdkTexture    *texture,
+                            GdkColorState *ccs)
+{
+  GskCairoTextureCache *cache;
+
+  cache = cairo_surface_get_user_data (cairo_get_target (cr), &texture_cache_key);
+  if (cache && gdk_color_state_equal (cache->ccs, ccs))
+    {
+      cairo_surface_t *surface = g_hash_table_lookup (cache->surfaces, texture);
+
+      if (surface && cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS)
+        return cairo_surface_reference (surface);
+
+      if (surface)
+        {
+          cairo_surface_t *band_surface;
+
+          /* Cairo does not lock the pixman image of a surface when
+           * using it as a source, so every thread gets its own surface
+           * around the shared pixels.
+           */
+          band_surface = cairo_image_surface_create_for_data (cairo_image_surface_get_data (surface),
+                                                              cairo_image_surface_get_format (surface),
+                                                              cairo_image_surface_get_width (surface),
+                                                              cairo_image_surface_get_height (surface),
+                                                              cairo_image_surface_get_stride (surface));
+          cairo_surface_set_user_data (band_surface,
+                                       &texture_cache_pixels_key,
+                                       cairo_surface_reference (surface),
+                                       (cairo_destroy_func_t) cairo_surface_destroy);
+          return band_surface;
+        }
+    }
+
+  return gdk_texture_download_surface (texture, ccs);
+}
+
+/* }}} */
+
 static gboolean
 gsk_color_stops_are_opaque (const GskColorStop *stops,
                             gsize               n_stops)
@@ -164,6 +271,78 @@ region_union_region_affine (cairo_region_t       *region,
     }
 }
 
+/* Hashing helpers for gsk_render_node_get_hash().
+ *
+ * The hashes only need to be stable for the lifetime of the process.
+ */
+static inline guint
+hash_combine (guint hash,
+              guint value)
+{
+  return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
+static inline guint
+hash_float (guint hash,
+            float value)
+{
+  guint32 bits;
+
+  memcpy (&bits, &value, sizeof (bits));
+
+  return hash_combine (hash, bits);
+}
+
+static guint
+hash_point (guint                   hash,
+            const graphene_point_t *point)
+{
+  hash = hash_float (hash, point->x);
+  return hash_float (hash, point->y);
+}
+
+static guint
+hash_rect (guint                  hash,
+           const graphene_rect_t *rect)
+{
+  hash = hash_float (hash, rect->origin.x);
+  hash = hash_float (hash, rect->origin.y);
+  hash = hash_float (hash, rect->size.width);
+  return hash_float (hash, rect->size.height);
+}
+
+static guint
+hash_rounded_rect (guint                 hash,
+                   const GskRoundedRect *rect)
+{
+  hash = hash_rect (hash, &rect->bounds);
+  for (int i = 0; i < 4; i++)
+    {
+      hash = hash_float (hash, rect->corner[i].width);
+      hash = hash_float (hash, rect->corner[i].height);
+    }
+
+  return hash;
+}
+
+static guint
+hash_color (guint           hash,
+            const GdkColor *color)
+{
+  hash = hash_combine (hash, g_direct_hash (color->color_state));
+  for (int i = 0; i < 4; i++)
+    hash = hash_float (hash, color->values[i]);
+
+  return hash;
+}
+
+static inline guint
+hash_node (guint          hash,
+           GskRenderNode *node)
+{
+  return hash_combine (hash, gsk_render_node_get_hash (node));
+}
+
 /* {{{ GSK_COLOR_NODE */
 
 /**
@@ -215,6 +394,25 @@ gsk_color_node_diff (GskRenderNode *node1,
   gsk_render_node_diff_impossible (node1, node2, data);
 }
 
+static guint
+gsk_color_node_hash (GskRenderNode *node)
+{
+  GskColorNode *self = (GskColorNode *) node;
+
+  return hash_color (hash_rect (GSK_COLOR_NODE, &node->bounds), &self->color);
+}
+
+static gboolean
+gsk_color_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskColorNode *self1 = (GskColorNode *) node1;
+  GskColorNode *self2 = (GskColorNode *) node2;
+
+  return gsk_rect_equal (&node1->bounds, &node2->bounds) &&
+         gdk_color_equal (&self1->color, &self2->color);
+}
+
 static void
 gsk_color_node_class_init (gpointer g_class,
                            gpointer class_data)
@@ -226,6 +424,8 @@ gsk_color_node_class_init (gpointer g_class,
   node_class->finalize = gsk_color_node_finalize;
   node_class->draw = gsk_color_node_draw;
   node_class->diff = gsk_color_node_diff;
+  node_class->hash = gsk_color_node_hash;
+  node_class->equal = gsk_color_node_equal;
 }
 
 /**
@@ -1642,6 +1842,42 @@ gsk_border_node_diff (GskRenderNode *node1,
   gsk_render_node_diff_impossible (node1, node2, data);
 }
 
+static guint
+gsk_border_node_hash (GskRenderNode *node)
+{
+  GskBorderNode *self = (GskBorderNode *) node;
+  guint hash = GSK_BORDER_NODE;
+
+  hash = hash_rounded_rect (hash, &self->outline);
+  for (int i = 0; i < 4; i++)
+    {
+      hash = hash_float (hash, self->border_width[i]);
+      hash = hash_color (hash, &self->border_color[i]);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_border_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskBorderNode *self1 = (GskBorderNode *) node1;
+  GskBorderNode *self2 = (GskBorderNode *) node2;
+
+  if (!gsk_rounded_rect_equal (&self1->outline, &self2->outline))
+    return FALSE;
+
+  for (int i = 0; i < 4; i++)
+    {
+      if (self1->border_width[i] != self2->border_width[i] ||
+          !gdk_color_equal (&self1->border_color[i], &self2->border_color[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gsk_border_node_class_init (gpointer g_class,
                             gpointer class_data)
@@ -1653,6 +1889,8 @@ gsk_border_node_class_init (gpointer g_class,
   node_class->finalize = gsk_border_node_finalize;
   node_class->draw = gsk_border_node_draw;
   node_class->diff = gsk_border_node_diff;
+  node_class->hash = gsk_border_node_hash;
+  node_class->equal = gsk_border_node_equal;
 }
 
 /**
@@ -1948,7 +2186,7 @@ gsk_texture_node_draw (GskRenderNode *node,
       return;
     }
 
-  surface = gdk_texture_download_surface (self->texture, ccs);
+  surface = gsk_cairo_download_texture (cr, self->texture, ccs);
   pattern = cairo_pattern_create_for_surface (surface);
   cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
 
@@ -1999,6 +2237,28 @@ gsk_texture_node_diff (GskRenderNode *node1,
   cairo_region_destroy (sub);
 }
 
+static guint
+gsk_texture_node_hash (GskRenderNode *node)
+{
+  GskTextureNode *self = (GskTextureNode *) node;
+  guint hash = GSK_TEXTURE_NODE;
+
+  hash = hash_rect (hash, &node->bounds);
+
+  return hash_combine (hash, g_direct_hash (self->texture));
+}
+
+static gboolean
+gsk_texture_node_equal (GskRenderNode *node1,
+                        GskRenderNode *node2)
+{
+  GskTextureNode *self1 = (GskTextureNode *) node1;
+  GskTextureNode *self2 = (GskTextureNode *) node2;
+
+  return self1->texture == self2->texture &&
+         gsk_rect_equal (&node1->bounds, &node2->bounds);
+}
+
 static void
 gsk_texture_node_class_init (gpointer g_class,
                              gpointer class_data)
@@ -2010,6 +2270,8 @@ gsk_texture_node_class_init (gpointer g_class,
   node_class->finalize = gsk_texture_node_finalize;
   node_class->draw = gsk_texture_node_draw;
   node_class->diff = gsk_texture_node_diff;
+  node_class->hash = gsk_texture_node_hash;
+  node_class->equal = gsk_texture_node_equal;
 }
 
 /**
@@ -2127,7 +2389,7 @@ gsk_texture_scale_node_draw (GskRenderNode *node,
   cairo_surface_set_device_offset (surface2, -clip_rect.origin.x, -clip_rect.origin.y);
   cr2 = cairo_create (surface2);
 
-  surface = gdk_texture_download_surface (self->texture, ccs);
+  surface = gsk_cairo_download_texture (cr, self->texture, ccs);
   pattern = cairo_pattern_create_for_surface (surface);
   cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
 
@@ -2190,6 +2452,30 @@ gsk_texture_scale_node_diff (GskRenderNode *node1,
   cairo_region_destroy (sub);
 }
 
+static guint
+gsk_texture_scale_node_hash (GskRenderNode *node)
+{
+  GskTextureScaleNode *self = (GskTextureScaleNode *) node;
+  guint hash = GSK_TEXTURE_SCALE_NODE;
+
+  hash = hash_rect (hash, &node->bounds);
+  hash = hash_combine (hash, self->filter);
+
+  return hash_combine (hash, g_direct_hash (self->texture));
+}
+
+static gboolean
+gsk_texture_scale_node_equal (GskRenderNode *node1,
+                              GskRenderNode *node2)
+{
+  GskTextureScaleNode *self1 = (GskTextureScaleNode *) node1;
+  GskTextureScaleNode *self2 = (GskTextureScaleNode *) node2;
+
+  return self1->texture == self2->texture &&
+         self1->filter == self2->filter &&
+         gsk_rect_equal (&node1->bounds, &node2->bounds);
+}
+
 static void
 gsk_texture_scale_node_class_init (gpointer g_class,
                                    gpointer class_data)
@@ -2201,6 +2487,8 @@ gsk_texture_scale_node_class_init (gpointer g_class,
   node_class->finalize = gsk_texture_scale_node_finalize;
   node_class->draw = gsk_texture_scale_node_draw;
   node_class->diff = gsk_texture_scale_node_diff;
+  node_class->hash = gsk_texture_scale_node_hash;
+  node_class->equal = gsk_texture_scale_node_equal;
 }
 
 /**
@@ -2720,6 +3008,34 @@ gsk_inset_shadow_node_diff (GskRenderNode *node1,
   gsk_render_node_diff_impossible (node1, node2, data);
 }
 
+static guint
+gsk_inset_shadow_node_hash (GskRenderNode *node)
+{
+  GskInsetShadowNode *self = (GskInsetShadowNode *) node;
+  guint hash = GSK_INSET_SHADOW_NODE;
+
+  hash = hash_rounded_rect (hash, &self->outline);
+  hash = hash_color (hash, &self->color);
+  hash = hash_point (hash, &self->offset);
+  hash = hash_float (hash, self->spread);
+
+  return hash_float (hash, self->blur_radius);
+}
+
+static gboolean
+gsk_inset_shadow_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskInsetShadowNode *self1 = (GskInsetShadowNode *) node1;
+  GskInsetShadowNode *self2 = (GskInsetShadowNode *) node2;
+
+  return gsk_rounded_rect_equal (&self1->outline, &self2->outline) &&
+         gdk_color_equal (&self1->color, &self2->color) &&
+         graphene_point_equal (&self1->offset, &self2->offset) &&
+         self1->spread == self2->spread &&
+         self1->blur_radius == self2->blur_radius;
+}
+
 static void
 gsk_inset_shadow_node_class_init (gpointer g_class,
                                   gpointer class_data)
@@ -2731,6 +3047,8 @@ gsk_inset_shadow_node_class_init (gpointer g_class,
   node_class->finalize = gsk_inset_shadow_node_finalize;
   node_class->draw = gsk_inset_shadow_node_draw;
   node_class->diff = gsk_inset_shadow_node_diff;
+  node_class->hash = gsk_inset_shadow_node_hash;
+  node_class->equal = gsk_inset_shadow_node_equal;
 }
 
 /**
@@ -3116,6 +3434,34 @@ gsk_outset_shadow_node_diff (GskRenderNode *node1,
   gsk_render_node_diff_impossible (node1, node2, data);
 }
 
+static guint
+gsk_outset_shadow_node_hash (GskRenderNode *node)
+{
+  GskOutsetShadowNode *self = (GskOutsetShadowNode *) node;
+  guint hash = GSK_OUTSET_SHADOW_NODE;
+
+  hash = hash_rounded_rect (hash, &self->outline);
+  hash = hash_color (hash, &self->color);
+  hash = hash_point (hash, &self->offset);
+  hash = hash_float (hash, self->spread);
+
+  return hash_float (hash, self->blur_radius);
+}
+
+static gboolean
+gsk_outset_shadow_node_equal (GskRenderNode *node1,
+                              GskRenderNode *node2)
+{
+  GskOutsetShadowNode *self1 = (GskOutsetShadowNode *) node1;
+  GskOutsetShadowNode *self2 = (GskOutsetShadowNode *) node2;
+
+  return gsk_rounded_rect_equal (&self1->outline, &self2->outline) &&
+         gdk_color_equal (&self1->color, &self2->color) &&
+         graphene_point_equal (&self1->offset, &self2->offset) &&
+         self1->spread == self2->spread &&
+         self1->blur_radius == self2->blur_radius;
+}
+
 static void
 gsk_outset_shadow_node_class_init (gpointer g_class,
                                    gpointer class_data)
@@ -3127,6 +3473,8 @@ gsk_outset_shadow_node_class_init (gpointer g_class,
   node_class->finalize = gsk_outset_shadow_node_finalize;
   node_class->draw = gsk_outset_shadow_node_draw;
   node_class->diff = gsk_outset_shadow_node_diff;
+  node_class->hash = gsk_outset_shadow_node_hash;
+  node_class->equal = gsk_outset_shadow_node_equal;
 }
 
 /**
@@ -3522,6 +3870,16 @@ gsk_cairo_node_get_draw_context (GskRenderNode *node)
 /* }}} */
 /* {{{ GSK_CONTAINER_NODE */
 
+/* Containers with many children get an index of the bounds of blocks
+ * of CONTAINER_INDEX_BRANCH children, and of blocks of those blocks and
+ * so on, so that children outside of a rectangle can be skipped
+ * without looking at each of them.
+ */
+#define CONTAINER_INDEX_THRESHOLD 64
+#define CONTAINER_INDEX_BRANCH_BITS 3
+#define CONTAINER_INDEX_BRANCH (1u << CONTAINER_INDEX_BRANCH_BITS)
+#define CONTAINER_INDEX_MAX_LEVELS 8
+
 /**
  * GskContainerNode:
  *
@@ -3535,6 +3893,10 @@ struct _GskContainerNode
   graphene_rect_t opaque; /* Can be 0 0 0 0 to mean no opacity */
   guint n_children;
   GskRenderNode **children;
+
+  guint n_index_levels;
+  guint index_offsets[CONTAINER_INDEX_MAX_LEVELS];
+  graphene_rect_t *index;
 };
 
 static void
@@ -3547,6 +3909,7 @@ gsk_container_node_finalize (GskRenderNode *node)
     gsk_render_node_unref (container->children[i]);
 
   g_free (container->children);
+  g_free (container->index);
 
   parent_class->finalize (node);
 }
@@ -3557,9 +3920,17 @@ gsk_container_node_draw (GskRenderNode *node,
                          GdkColorState *ccs)
 {
   GskContainerNode *container = (GskContainerNode *) node;
+  graphene_rect_t clip;
+  double x1, y1, x2, y2;
   guint i;
 
-  for (i = 0; i < container->n_children; i++)
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+  graphene_rect_init (&clip, x1, y1, x2 - x1, y2 - y1);
+
+  /* Skip children that are entirely clipped away */
+  for (i = gsk_container_node_get_next_child_in_rect (node, 0, &clip);
+       i < container->n_children;
+       i = gsk_container_node_get_next_child_in_rect (node, i + 1, &clip))
     {
       gsk_render_node_draw_ccs (container->children[i], cr, ccs);
     }
@@ -3614,6 +3985,54 @@ gsk_container_node_get_diff_settings (void)
   return settings;
 }
 
+static gboolean
+gsk_render_node_diff_range (GskRenderNode **nodes1,
+                            gsize           n_nodes1,
+                            GskRenderNode **nodes2,
+                            gsize           n_nodes2,
+                            GskDiffData    *data)
+{
+  cairo_rectangle_int_t rect;
+  gsize i;
+
+  if (n_nodes1 == 0 && n_nodes2 == 0)
+    return TRUE;
+
+  if (gsk_diff ((gconstpointer *) nodes1, n_nodes1,
+                (gconstpointer *) nodes2, n_nodes2,
+                gsk_container_node_get_diff_settings (),
+                data) == GSK_DIFF_OK)
+    return TRUE;
+
+  if (cairo_region_num_rectangles (data->region) > MAX_RECTS_IN_DIFF)
+    return FALSE;
+
+  /* Too many changes to line up, but the children outside
+   * this range are known to be unchanged.
+   */
+  for (i = 0; i < n_nodes1; i++)
+    {
+      gsk_rect_to_cairo_grow (&nodes1[i]->bounds, &rect);
+      cairo_region_union_rectangle (data->region, &rect);
+    }
+  for (i = 0; i < n_nodes2; i++)
+    {
+      gsk_rect_to_cairo_grow (&nodes2[i]->bounds, &rect);
+      cairo_region_union_rectangle (data->region, &rect);
+    }
+
+  return cairo_region_num_rectangles (data->region) <= MAX_RECTS_IN_DIFF;
+}
+
+/* Widgets tend to recreate identical nodes every frame, and children
+ * get inserted and removed in the middle of long lists. Looking for
+ * children with the same hash in both lists finds the unchanged ones
+ * in linear time, and only the ranges between them need to be lined
+ * up with gsk_diff(), which gives up when there are too many changes.
+ *
+ * Equal hashes are only used to line up children, they are still
+ * diffed, so hash collisions can't cause missing damage.
+ */
 static gboolean
 gsk_render_node_diff_multiple (GskRenderNode **nodes1,
                                gsize           n_nodes1,
@@ -3621,10 +4040,126 @@ gsk_render_node_diff_multiple (GskRenderNode **nodes1,
                                gsize           n_nodes2,
                                GskDiffData    *data)
 {
-  return gsk_diff ((gconstpointer *) nodes1, n_nodes1,
-                   (gconstpointer *) nodes2, n_nodes2,
-                   gsk_container_node_get_diff_settings (),
-                   data) == GSK_DIFF_OK;
+  GHashTable *positions;
+  gsize *matches, *tails, *prev;
+  gsize i, j, k, n_matches, n_anchors, last1, last2;
+  gboolean result;
+
+  /* Skip the unchanged start and end, that's the common case */
+  while (n_nodes1 > 0 && n_nodes2 > 0 &&
+         gsk_render_node_get_hash (nodes1[0]) == gsk_render_node_get_hash (nodes2[0]))
+    {
+      gsk_render_node_diff (nodes1[0], nodes2[0], data);
+      nodes1++;
+      nodes2++;
+      n_nodes1--;
+      n_nodes2--;
+    }
+
+  while (n_nodes1 > 0 && n_nodes2 > 0 &&
+         gsk_render_node_get_hash (nodes1[n_nodes1 - 1]) == gsk_render_node_get_hash (nodes2[n_nodes2 - 1]))
+    {
+      gsk_render_node_diff (nodes1[n_nodes1 - 1], nodes2[n_nodes2 - 1], data);
+      n_nodes1--;
+      n_nodes2--;
+    }
+
+  if (n_nodes1 <= 1 || n_nodes2 <= 1)
+    return gsk_render_node_diff_range (nodes1, n_nodes1, nodes2, n_nodes2, data);
+
+  /* Map hashes that are unique among the old children to their position */
+  positions = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < n_nodes1; i++)
+    {
+      gpointer key = GUINT_TO_POINTER (gsk_render_node_get_hash (nodes1[i]));
+
+      if (g_hash_table_contains (positions, key))
+        g_hash_table_insert (positions, key, GSIZE_TO_POINTER (G_MAXSIZE));
+      else
+        g_hash_table_insert (positions, key, GSIZE_TO_POINTER (i));
+    }
+
+  /* matches[j] is the old position of new child j, or G_MAXSIZE */
+  matches = g_new (gsize, 3 * n_nodes2);
+  tails = matches + n_nodes2;
+  prev = tails + n_nodes2;
+
+  for (j = 0; j < n_nodes2; j++)
+    {
+      gpointer value;
+
+      if (g_hash_table_lookup_extended (positions,
+                                        GUINT_TO_POINTER (gsk_render_node_get_hash (nodes2[j])),
+                                        NULL, &value))
+        matches[j] = GPOINTER_TO_SIZE (value);
+      else
+        matches[j] = G_MAXSIZE;
+    }
+
+  g_hash_table_unref (positions);
+
+  /* The longest run of matches that is in the same order in both
+   * lists becomes the anchors. tails[k] is the new position ending
+   * the best run of length k + 1 found so far.
+   */
+  n_matches = 0;
+  for (j = 0; j < n_nodes2; j++)
+    {
+      gsize lo, hi;
+
+      if (matches[j] == G_MAXSIZE)
+        continue;
+
+      lo = 0;
+      hi = n_matches;
+      while (lo < hi)
+        {
+          gsize mid = (lo + hi) / 2;
+
+          if (matches[tails[mid]] < matches[j])
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      prev[j] = lo > 0 ? tails[lo - 1] : G_MAXSIZE;
+      tails[lo] = j;
+      if (lo == n_matches)
+        n_matches++;
+    }
+
+  /* Walk the run backwards, collecting the anchors at the start of tails */
+  n_anchors = n_matches;
+  for (k = n_anchors, j = n_matches > 0 ? tails[n_matches - 1] : G_MAXSIZE;
+       k > 0;
+       k--, j = prev[j])
+    tails[k - 1] = j;
+
+  result = TRUE;
+  last1 = 0;
+  last2 = 0;
+  for (k = 0; k < n_anchors && result; k++)
+    {
+      j = tails[k];
+      i = matches[j];
+
+      result = gsk_render_node_diff_range (nodes1 + last1, i - last1,
+                                           nodes2 + last2, j - last2,
+                                           data);
+      gsk_render_node_diff (nodes1[i], nodes2[j], data);
+
+      last1 = i + 1;
+      last2 = j + 1;
+    }
+
+  if (result)
+    result = gsk_render_node_diff_range (nodes1 + last1, n_nodes1 - last1,
+                                         nodes2 + last2, n_nodes2 - last2,
+                                         data);
+
+  g_free (matches);
+
+  return result && cairo_region_num_rectangles (data->region) <= MAX_RECTS_IN_DIFF;
 }
 
 void
@@ -3675,6 +4210,38 @@ gsk_container_node_get_opaque_rect (GskRenderNode   *node,
   return TRUE;
 }
 
+static guint
+gsk_container_node_hash (GskRenderNode *node)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+  guint hash = GSK_CONTAINER_NODE;
+
+  hash = hash_combine (hash, self->n_children);
+  for (guint i = 0; i < self->n_children; i++)
+    hash = hash_node (hash, self->children[i]);
+
+  return hash;
+}
+
+static gboolean
+gsk_container_node_equal (GskRenderNode *node1,
+                          GskRenderNode *node2)
+{
+  GskContainerNode *self1 = (GskContainerNode *) node1;
+  GskContainerNode *self2 = (GskContainerNode *) node2;
+
+  if (self1->n_children != self2->n_children)
+    return FALSE;
+
+  for (guint i = 0; i < self1->n_children; i++)
+    {
+      if (!gsk_render_node_equal (self1->children[i], self2->children[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gsk_container_node_class_init (gpointer g_class,
                                gpointer class_data)
@@ -3686,23 +4253,56 @@ gsk_container_node_class_init (gpointer g_class,
   node_class->finalize = gsk_container_node_finalize;
   node_class->draw = gsk_container_node_draw;
   node_class->diff = gsk_container_node_diff;
+  node_class->hash = gsk_container_node_hash;
+  node_class->equal = gsk_container_node_equal;
   node_class->get_opaque_rect = gsk_container_node_get_opaque_rect;
 }
 
-/**
- * gsk_container_node_new:
- * @children: (array length=n_children) (transfer none): The children of the node
- * @n_children: Number of children in the @children array
- *
- * Creates a new `GskRenderNode` instance for holding the given @children.
- *
- * The new node will acquire a reference to each of the children.
- *
- * Returns: (transfer full) (type GskContainerNode): the new `GskRenderNode`
- */
-GskRenderNode *
-gsk_container_node_new (GskRenderNode **children,
-                        guint           n_children)
+static void
+gsk_container_node_build_index (GskContainerNode *self)
+{
+  guint level, n, i, n_blocks, total;
+
+  total = 0;
+  n = self->n_children;
+  for (level = 0; level < CONTAINER_INDEX_MAX_LEVELS && n > 1; level++)
+    {
+      n = (n + CONTAINER_INDEX_BRANCH - 1) / CONTAINER_INDEX_BRANCH;
+      self->index_offsets[level] = total;
+      total += n;
+    }
+  self->n_index_levels = level;
+  self->index = g_new (graphene_rect_t, total);
+
+  n = self->n_children;
+  for (level = 0; level < self->n_index_levels; level++)
+    {
+      for (i = 0; i < n; i++)
+        {
+          const graphene_rect_t *rect;
+          graphene_rect_t *block;
+
+          if (level == 0)
+            rect = &self->children[i]->bounds;
+          else
+            rect = &self->index[self->index_offsets[level - 1] + i];
+
+          block = &self->index[self->index_offsets[level] + i / CONTAINER_INDEX_BRANCH];
+          if (i % CONTAINER_INDEX_BRANCH == 0)
+            *block = *rect;
+          else
+            graphene_rect_union (block, rect, block);
+        }
+
+      n_blocks = (n + CONTAINER_INDEX_BRANCH - 1) / CONTAINER_INDEX_BRANCH;
+      n = n_blocks;
+    }
+}
+
+static GskRenderNode *
+gsk_container_node_new_internal (GskRenderNode **children,
+                                 guint           n_children,
+                                 gboolean        take)
 {
   GskContainerNode *self;
   GskRenderNode *node;
@@ -3725,8 +4325,14 @@ gsk_container_node_new (GskRenderNode **children,
       gboolean is_hdr;
 
       self->children = g_malloc_n (n_children, sizeof (GskRenderNode *));
+      if (take)
+        memcpy (self->children, children, n_children * sizeof (GskRenderNode *));
+      else
+        {
+          for (guint i = 0; i < n_children; i++)
+            self->children[i] = gsk_render_node_ref (children[i]);
+        }
 
-      self->children[0] = gsk_render_node_ref (children[0]);
       node->offscreen_for_opacity = children[0]->offscreen_for_opacity;
       node->preferred_depth = children[0]->preferred_depth;
       gsk_rect_init_from_rect (&node->bounds, &(children[0]->bounds));
@@ -3735,7 +4341,6 @@ gsk_container_node_new (GskRenderNode **children,
 
       for (guint i = 1; i < n_children; i++)
         {
-          self->children[i] = gsk_render_node_ref (children[i]);
           self->disjoint = self->disjoint && !gsk_rect_intersects (&node->bounds, &(children[i]->bounds));
           graphene_rect_union (&node->bounds, &(children[i]->bounds), &node->bounds);
           node->preferred_depth = gdk_memory_depth_merge (node->preferred_depth, children[i]->preferred_depth);
@@ -3756,11 +4361,51 @@ gsk_container_node_new (GskRenderNode **children,
 
       node->offscreen_for_opacity = node->offscreen_for_opacity || !self->disjoint;
       node->is_hdr = is_hdr;
+
+      if (n_children >= CONTAINER_INDEX_THRESHOLD)
+        gsk_container_node_build_index (self);
    }
 
   return node;
 }
 
+/**
+ * gsk_container_node_new:
+ * @children: (array length=n_children) (transfer none): The children of the node
+ * @n_children: Number of children in the @children array
+ *
+ * Creates a new `GskRenderNode` instance for holding the given @children.
+ *
+ * The new node will acquire a reference to each of the children.
+ *
+ * Returns: (transfer full) (type GskContainerNode): the new `GskRenderNode`
+ */
+GskRenderNode *
+gsk_container_node_new (GskRenderNode **children,
+                        guint           n_children)
+{
+  return gsk_container_node_new_internal (children, n_children, FALSE);
+}
+
+/*< private >
+ * gsk_container_node_new_take:
+ * @children: (array length=n_children) (transfer full): The children of the node
+ * @n_children: Number of children in the @children array
+ *
+ * Like [ctor@Gsk.ContainerNode.new], but takes over the references
+ * to the @children instead of acquiring new ones.
+ *
+ * The @children array itself is not taken.
+ *
+ * Returns: (transfer full) (type GskContainerNode): the new `GskRenderNode`
+ */
+GskRenderNode *
+gsk_container_node_new_take (GskRenderNode **children,
+                             guint           n_children)
+{
+  return gsk_container_node_new_internal (children, n_children, TRUE);
+}
+
 /**
  * gsk_container_node_get_n_children:
  * @node: (type GskContainerNode): a container `GskRenderNode`
@@ -3827,6 +4472,59 @@ gsk_container_node_is_disjoint (const GskRenderNode *node)
   return self->disjoint;
 }
 
+/*< private>
+ * gsk_container_node_get_next_child_in_rect:
+ * @node: a container `GskRenderNode`
+ * @start: the index of the first child to consider
+ * @rect: the rectangle to check
+ *
+ * Finds the first child at or after @start whose bounds intersect
+ * @rect. Use this to iterate over the children that are not culled
+ * by a clip, in drawing order.
+ *
+ * For containers with many children, this uses an index to skip
+ * blocks of children that are outside of @rect.
+ *
+ * Returns: the index of the child or the number of children if
+ *   there is no such child
+ */
+guint
+gsk_container_node_get_next_child_in_rect (const GskRenderNode   *node,
+                                           guint                  start,
+                                           const graphene_rect_t *rect)
+{
+  const GskContainerNode *self = (const GskContainerNode *) node;
+  guint i = start;
+
+  while (i < self->n_children)
+    {
+      int level;
+
+      /* Skip the largest block that starts here and is outside of rect */
+      for (level = self->n_index_levels - 1; level >= 0; level--)
+        {
+          guint shift = (level + 1) * CONTAINER_INDEX_BRANCH_BITS;
+
+          if ((i & ((1u << shift) - 1)) == 0 &&
+              !gsk_rect_intersects (&self->index[self->index_offsets[level] + (i >> shift)], rect))
+            break;
+        }
+
+      if (level >= 0)
+        {
+          i += 1u << ((level + 1) * CONTAINER_INDEX_BRANCH_BITS);
+          continue;
+        }
+
+      if (gsk_rect_intersects (&self->children[i]->bounds, rect))
+        return i;
+
+      i++;
+    }
+
+  return self->n_children;
+}
+
 /* }}} */
 /* {{{ GSK_TRANSFORM_NODE */
 
@@ -3995,6 +4693,33 @@ gsk_transform_node_get_opaque_rect (GskRenderNode   *node,
   return TRUE;
 }
 
+static guint
+gsk_transform_node_hash (GskRenderNode *node)
+{
+  GskTransformNode *self = (GskTransformNode *) node;
+  guint hash = GSK_TRANSFORM_NODE;
+
+  /* The translation is cached, other transforms are only
+   * distinguished by category here and compared in full in equal()
+   */
+  hash = hash_combine (hash, gsk_transform_get_category (self->transform));
+  hash = hash_float (hash, self->dx);
+  hash = hash_float (hash, self->dy);
+
+  return hash_node (hash, self->child);
+}
+
+static gboolean
+gsk_transform_node_equal (GskRenderNode *node1,
+                          GskRenderNode *node2)
+{
+  GskTransformNode *self1 = (GskTransformNode *) node1;
+  GskTransformNode *self2 = (GskTransformNode *) node2;
+
+  return gsk_transform_equal (self1->transform, self2->transform) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static void
 gsk_transform_node_class_init (gpointer g_class,
                                gpointer class_data)
@@ -4007,6 +4732,8 @@ gsk_transform_node_class_init (gpointer g_class,
   node_class->draw = gsk_transform_node_draw;
   node_class->can_diff = gsk_transform_node_can_diff;
   node_class->diff = gsk_transform_node_diff;
+  node_class->hash = gsk_transform_node_hash;
+  node_class->equal = gsk_transform_node_equal;
   node_class->get_opaque_rect = gsk_transform_node_get_opaque_rect;
 }
 
@@ -4162,6 +4889,28 @@ gsk_opacity_node_diff (GskRenderNode *node1,
     gsk_render_node_diff_impossible (node1, node2, data);
 }
 
+static guint
+gsk_opacity_node_hash (GskRenderNode *node)
+{
+  GskOpacityNode *self = (GskOpacityNode *) node;
+  guint hash = GSK_OPACITY_NODE;
+
+  hash = hash_float (hash, self->opacity);
+
+  return hash_node (hash, self->child);
+}
+
+static gboolean
+gsk_opacity_node_equal (GskRenderNode *node1,
+                        GskRenderNode *node2)
+{
+  GskOpacityNode *self1 = (GskOpacityNode *) node1;
+  GskOpacityNode *self2 = (GskOpacityNode *) node2;
+
+  return self1->opacity == self2->opacity &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static void
 gsk_opacity_node_class_init (gpointer g_class,
                              gpointer class_data)
@@ -4173,6 +4922,8 @@ gsk_opacity_node_class_init (gpointer g_class,
   node_class->finalize = gsk_opacity_node_finalize;
   node_class->draw = gsk_opacity_node_draw;
   node_class->diff = gsk_opacity_node_diff;
+  node_class->hash = gsk_opacity_node_hash;
+  node_class->equal = gsk_opacity_node_equal;
 }
 
 /**
@@ -4869,6 +5620,28 @@ gsk_clip_node_get_opaque_rect (GskRenderNode   *node,
   return graphene_rect_intersection (&self->clip, &child_opaque, opaque);
 }
 
+static guint
+gsk_clip_node_hash (GskRenderNode *node)
+{
+  GskClipNode *self = (GskClipNode *) node;
+  guint hash = GSK_CLIP_NODE;
+
+  hash = hash_rect (hash, &self->clip);
+
+  return hash_node (hash, self->child);
+}
+
+static gboolean
+gsk_clip_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskClipNode *self1 = (GskClipNode *) node1;
+  GskClipNode *self2 = (GskClipNode *) node2;
+
+  return gsk_rect_equal (&self1->clip, &self2->clip) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static void
 gsk_clip_node_class_init (gpointer g_class,
                           gpointer class_data)
@@ -4880,6 +5653,8 @@ gsk_clip_node_class_init (gpointer g_class,
   node_class->finalize = gsk_clip_node_finalize;
   node_class->draw = gsk_clip_node_draw;
   node_class->diff = gsk_clip_node_diff;
+  node_class->hash = gsk_clip_node_hash;
+  node_class->equal = gsk_clip_node_equal;
   node_class->get_opaque_rect = gsk_clip_node_get_opaque_rect;
 }
 
@@ -5056,6 +5831,28 @@ gsk_rounded_clip_node_get_opaque_rect (GskRenderNode   *node,
   return TRUE;
 }
 
+static guint
+gsk_rounded_clip_node_hash (GskRenderNode *node)
+{
+  GskRoundedClipNode *self = (GskRoundedClipNode *) node;
+  guint hash = GSK_ROUNDED_CLIP_NODE;
+
+  hash = hash_rounded_rect (hash, &self->clip);
+
+  return hash_node (hash, self->child);
+}
+
+static gboolean
+gsk_rounded_clip_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskRoundedClipNode *self1 = (GskRoundedClipNode *) node1;
+  GskRoundedClipNode *self2 = (GskRoundedClipNode *) node2;
+
+  return gsk_rounded_rect_equal (&self1->clip, &self2->clip) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static void
 gsk_rounded_clip_node_class_init (gpointer g_class,
                                   gpointer class_data)
@@ -5067,6 +5864,8 @@ gsk_rounded_clip_node_class_init (gpointer g_class,
   node_class->finalize = gsk_rounded_clip_node_finalize;
   node_class->draw = gsk_rounded_clip_node_draw;
   node_class->diff = gsk_rounded_clip_node_diff;
+  node_class->hash = gsk_rounded_clip_node_hash;
+  node_class->equal = gsk_rounded_clip_node_equal;
   node_class->get_opaque_rect = gsk_rounded_clip_node_get_opaque_rect;
 }
 
@@ -6422,6 +7221,55 @@ gsk_text_node_diff (GskRenderNode *node1,
   gsk_render_node_diff_impossible (node1, node2, data);
 }
 
+static guint
+gsk_text_node_hash (GskRenderNode *node)
+{
+  GskTextNode *self = (GskTextNode *) node;
+  guint hash = GSK_TEXT_NODE;
+
+  hash = hash_combine (hash, g_direct_hash (self->font));
+  hash = hash_color (hash, &self->color);
+  hash = hash_point (hash, &self->offset);
+  hash = hash_combine (hash, self->num_glyphs);
+  for (guint i = 0; i < self->num_glyphs; i++)
+    {
+      hash = hash_combine (hash, self->glyphs[i].glyph);
+      hash = hash_combine (hash, self->glyphs[i].geometry.width);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_text_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskTextNode *self1 = (GskTextNode *) node1;
+  GskTextNode *self2 = (GskTextNode *) node2;
+
+  if (self1->font != self2->font ||
+      !gdk_color_equal (&self1->color, &self2->color) ||
+      !graphene_point_equal (&self1->offset, &self2->offset) ||
+      self1->num_glyphs != self2->num_glyphs)
+    return FALSE;
+
+  for (guint i = 0; i < self1->num_glyphs; i++)
+    {
+      PangoGlyphInfo *info1 = &self1->glyphs[i];
+      PangoGlyphInfo *info2 = &self2->glyphs[i];
+
+      if (info1->glyph != info2->glyph ||
+          info1->geometry.width != info2->geometry.width ||
+          info1->geometry.x_offset != info2->geometry.x_offset ||
+          info1->geometry.y_offset != info2->geometry.y_offset ||
+          info1->attr.is_cluster_start != info2->attr.is_cluster_start ||
+          info1->attr.is_color != info2->attr.is_color)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gsk_text_node_class_init (gpointer g_class,
                           gpointer class_data)
@@ -6433,6 +7281,8 @@ gsk_text_node_class_init (gpointer g_class,
   node_class->finalize = gsk_text_node_finalize;
   node_class->draw = gsk_text_node_draw;
   node_class->diff = gsk_text_node_diff;
+  node_class->hash = gsk_text_node_hash;
+  node_class->equal = gsk_text_node_equal;
 }
 
 static inline float
@@ -7350,6 +8200,26 @@ gsk_debug_node_get_opaque_rect (GskRenderNode   *node,
   return gsk_render_node_get_opaque_rect (self->child, out_opaque);
 }
 
+static guint
+gsk_debug_node_hash (GskRenderNode *node)
+{
+  GskDebugNode *self = (GskDebugNode *) node;
+  guint hash = GSK_DEBUG_NODE;
+
+  /* The message doesn't affect rendering */
+  return hash_node (hash, self->child);
+}
+
+static gboolean
+gsk_debug_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskDebugNode *self1 = (GskDebugNode *) node1;
+  GskDebugNode *self2 = (GskDebugNode *) node2;
+
+  return gsk_render_node_equal (self1->child, self2->child);
+}
+
 static void
 gsk_debug_node_class_init (gpointer g_class,
                            gpointer class_data)
@@ -7362,6 +8232,8 @@ gsk_debug_node_class_init (gpointer g_class,
   node_class->draw = gsk_debug_node_draw;
   node_class->can_diff = gsk_debug_node_can_diff;
   node_class->diff = gsk_debug_node_diff;
+  node_class->hash = gsk_debug_node_hash;
+  node_class->equal = gsk_debug_node_equal;
   node_class->get_opaque_rect = gsk_debug_node_get_opaque_rect;
 }
 
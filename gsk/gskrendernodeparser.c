@@ -4995,3 +4995,2534 @@ gsk_render_node_serialize (GskRenderNode *node)
 
   return res;
 }
+
+/* The binary format is a flat stream of records. Every record starts
+ * with a tag and only refers to records that came before it, so it can
+ * be written in a single pass and read back without tokenizing or
+ * looking ahead.
+ *
+ * Nodes are written in post-order and referred to by their index, so
+ * shared subtrees are only written once. The same goes for textures,
+ * fonts, glyph strings and color states.
+ *
+ * All numbers are little-endian. Pixel data is aligned to 16 bytes
+ * from the start of the data, so textures can be created directly on
+ * top of a mapped file.
+ */
+
+static const guchar binary_magic[8] = { 0x89, 'G', 'S', 'K', '\r', '\n', 0x1a, '\n' };
+
+#define BINARY_VERSION 1
+#define BINARY_ALIGNMENT 16
+#define BINARY_FLUSH_SIZE (64 * 1024)
+#define BINARY_CUSTOM_COLOR_STATE 0x100
+#define BINARY_NONE G_MAXUINT32
+#define BINARY_GLYPH_SIZE (5 * sizeof (guint32))
+
+/* Header flags */
+#define BINARY_FLAG_TRACE (1 << 0)
+
+typedef enum {
+  BINARY_RECORD_END,
+  BINARY_RECORD_COLOR_STATE,
+  BINARY_RECORD_TEXTURE,
+  BINARY_RECORD_FONT_FILE,
+  BINARY_RECORD_FONT,
+  BINARY_RECORD_GLYPHS,
+  BINARY_RECORD_NODE,
+  BINARY_RECORD_FRAME,
+} BinaryRecord;
+
+typedef enum {
+  BINARY_TRANSFORM_IDENTITY,
+  BINARY_TRANSFORM_TRANSLATE,
+  BINARY_TRANSFORM_AFFINE,
+  BINARY_TRANSFORM_STRING,
+} BinaryTransform;
+
+/* Number of points stored per path operation, the start point of
+ * everything but a move is implied by the previous operation.
+ */
+static const guint binary_path_points[] = {
+  [GSK_PATH_MOVE] = 1,
+  [GSK_PATH_CLOSE] = 0,
+  [GSK_PATH_LINE] = 1,
+  [GSK_PATH_QUAD] = 2,
+  [GSK_PATH_CUBIC] = 3,
+  [GSK_PATH_CONIC] = 2,
+};
+
+G_STATIC_ASSERT (sizeof (PangoGlyphVisAttr) == sizeof (guint32));
+
+typedef struct
+{
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *error;
+  GByteArray *out;
+  gsize flushed;
+  GPtrArray *payloads;
+  guint depth;
+  /* Everything the previous frame used is kept when writing
+   * traces, anything older is released.
+   */
+  GHashTable *nodes;
+  GHashTable *prev_nodes;
+  guint32 n_nodes;
+  GHashTable *textures;
+  GHashTable *prev_textures;
+  guint32 n_textures;
+  GHashTable *color_states;
+  GHashTable *prev_color_states;
+  guint32 n_color_states;
+  GHashTable *fonts;
+  GHashTable *prev_fonts;
+  guint32 n_fonts;
+  /* Checksums of embedded font files, so they are only written once
+   * without keeping the fonts alive
+   */
+  GHashTable *font_files;
+  GHashTable *glyphs;
+  GHashTable *prev_glyphs;
+  guint32 n_glyphs;
+} BinaryWriter;
+
+static void
+binary_append_u32 (GByteArray *buf,
+                   guint32     value)
+{
+  value = GUINT32_TO_LE (value);
+  g_byte_array_append (buf, (const guint8 *) &value, sizeof (value));
+}
+
+static void
+binary_append_u64 (GByteArray *buf,
+                   guint64     value)
+{
+  value = GUINT64_TO_LE (value);
+  g_byte_array_append (buf, (const guint8 *) &value, sizeof (value));
+}
+
+static void
+binary_append_float (GByteArray *buf,
+                     float       value)
+{
+  guint32 u;
+
+  memcpy (&u, &value, sizeof (u));
+  binary_append_u32 (buf, u);
+}
+
+static void
+binary_append_floats (GByteArray  *buf,
+                      const float *values,
+                      gsize        n_values)
+{
+  gsize i;
+
+  for (i = 0; i < n_values; i++)
+    binary_append_float (buf, values[i]);
+}
+
+static void
+binary_append_data (GByteArray    *buf,
+                    gconstpointer  data,
+                    gsize          size)
+{
+  binary_append_u32 (buf, size);
+  g_byte_array_append (buf, data, size);
+}
+
+static void
+binary_append_string (GByteArray *buf,
+                      const char *string)
+{
+  if (string == NULL)
+    binary_append_u32 (buf, BINARY_NONE);
+  else
+    binary_append_data (buf, string, strlen (string));
+}
+
+static void
+binary_append_point (GByteArray             *buf,
+                     const graphene_point_t *point)
+{
+  binary_append_float (buf, point->x);
+  binary_append_float (buf, point->y);
+}
+
+static void
+binary_append_rect (GByteArray            *buf,
+                    const graphene_rect_t *rect)
+{
+  binary_append_float (buf, rect->origin.x);
+  binary_append_float (buf, rect->origin.y);
+  binary_append_float (buf, rect->size.width);
+  binary_append_float (buf, rect->size.height);
+}
+
+static void
+binary_append_rounded_rect (GByteArray           *buf,
+                            const GskRoundedRect *rect)
+{
+  guint i;
+
+  binary_append_rect (buf, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      binary_append_float (buf, rect->corner[i].width);
+      binary_append_float (buf, rect->corner[i].height);
+    }
+}
+
+static void
+binary_append_stops (GByteArray         *buf,
+                     const GskColorStop *stops,
+                     gsize               n_stops)
+{
+  gsize i;
+
+  binary_append_u32 (buf, n_stops);
+  for (i = 0; i < n_stops; i++)
+    {
+      binary_append_float (buf, stops[i].offset);
+      binary_append_float (buf, stops[i].color.red);
+      binary_append_float (buf, stops[i].color.green);
+      binary_append_float (buf, stops[i].color.blue);
+      binary_append_float (buf, stops[i].color.alpha);
+    }
+}
+
+static void
+binary_append_matrix (GByteArray              *buf,
+                      const graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  graphene_matrix_to_float (matrix, values);
+  binary_append_floats (buf, values, 16);
+}
+
+static void
+binary_append_vec4 (GByteArray            *buf,
+                    const graphene_vec4_t *vec)
+{
+  float values[4];
+
+  graphene_vec4_to_float (vec, values);
+  binary_append_floats (buf, values, 4);
+}
+
+static void
+binary_append_transform (GByteArray   *buf,
+                         GskTransform *transform)
+{
+  float scale_x, scale_y, dx, dy;
+  char *s;
+
+  switch (gsk_transform_get_category (transform))
+    {
+    case GSK_TRANSFORM_CATEGORY_IDENTITY:
+      binary_append_u32 (buf, BINARY_TRANSFORM_IDENTITY);
+      break;
+
+    case GSK_TRANSFORM_CATEGORY_2D_TRANSLATE:
+      gsk_transform_to_translate (transform, &dx, &dy);
+      binary_append_u32 (buf, BINARY_TRANSFORM_TRANSLATE);
+      binary_append_float (buf, dx);
+      binary_append_float (buf, dy);
+      break;
+
+    case GSK_TRANSFORM_CATEGORY_2D_AFFINE:
+      gsk_transform_to_affine (transform, &scale_x, &scale_y, &dx, &dy);
+      binary_append_u32 (buf, BINARY_TRANSFORM_AFFINE);
+      binary_append_float (buf, scale_x);
+      binary_append_float (buf, scale_y);
+      binary_append_float (buf, dx);
+      binary_append_float (buf, dy);
+      break;
+
+    case GSK_TRANSFORM_CATEGORY_UNKNOWN:
+    case GSK_TRANSFORM_CATEGORY_ANY:
+    case GSK_TRANSFORM_CATEGORY_3D:
+    case GSK_TRANSFORM_CATEGORY_2D:
+    default:
+      /* Keep the individual steps, so the result has the same category */
+      s = gsk_transform_to_string (transform);
+      binary_append_u32 (buf, BINARY_TRANSFORM_STRING);
+      binary_append_string (buf, s);
+      g_free (s);
+      break;
+    }
+}
+
+static gboolean
+binary_append_path_operation (GskPathOperation        op,
+                              const graphene_point_t *pts,
+                              gsize                   n_pts,
+                              float                   weight,
+                              gpointer                user_data)
+{
+  GByteArray *buf = user_data;
+  gsize i;
+
+  binary_append_u32 (buf, op);
+  for (i = n_pts - binary_path_points[op]; i < n_pts; i++)
+    binary_append_point (buf, &pts[i]);
+  if (op == GSK_PATH_CONIC)
+    binary_append_float (buf, weight);
+
+  return TRUE;
+}
+
+static void
+binary_append_path (GByteArray *buf,
+                    GskPath    *path)
+{
+  gsk_path_foreach (path,
+                    GSK_PATH_FOREACH_ALLOW_QUAD |
+                    GSK_PATH_FOREACH_ALLOW_CUBIC |
+                    GSK_PATH_FOREACH_ALLOW_CONIC,
+                    binary_append_path_operation,
+                    buf);
+  binary_append_u32 (buf, BINARY_NONE);
+}
+
+static void
+binary_writer_flush (BinaryWriter *writer)
+{
+  if (writer->stream == NULL || writer->error != NULL || writer->out->len == 0)
+    return;
+
+  if (!g_output_stream_write_all (writer->stream,
+                                  writer->out->data,
+                                  writer->out->len,
+                                  NULL,
+                                  writer->cancellable,
+                                  &writer->error))
+    return;
+
+  writer->flushed += writer->out->len;
+  g_byte_array_set_size (writer->out, 0);
+}
+
+static void
+binary_writer_end_record (BinaryWriter *writer)
+{
+  if (writer->out->len >= BINARY_FLUSH_SIZE)
+    binary_writer_flush (writer);
+}
+
+static void
+binary_writer_align (BinaryWriter *writer)
+{
+  static const guint8 zeroes[BINARY_ALIGNMENT] = { 0, };
+  gsize offset;
+
+  offset = (writer->flushed + writer->out->len) % BINARY_ALIGNMENT;
+  if (offset)
+    g_byte_array_append (writer->out, zeroes, BINARY_ALIGNMENT - offset);
+}
+
+static gboolean
+binary_writer_lookup (GHashTable     *table,
+                      GHashTable     *prev_table,
+                      gpointer        key,
+                      GBoxedCopyFunc  ref_func,
+                      guint32        *index)
+{
+  gpointer value;
+
+  if (g_hash_table_lookup_extended (table, key, NULL, &value))
+    {
+      *index = GPOINTER_TO_UINT (value);
+      return TRUE;
+    }
+
+  if (prev_table && g_hash_table_lookup_extended (prev_table, key, NULL, &value))
+    {
+      g_hash_table_insert (table, ref_func (key), value);
+      *index = GPOINTER_TO_UINT (value);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Makes @table the previous table and starts an empty one */
+static void
+binary_writer_rotate (GHashTable **table,
+                      GHashTable **prev_table)
+{
+  g_clear_pointer (prev_table, g_hash_table_unref);
+  *prev_table = g_steal_pointer (table);
+  *table = g_hash_table_new_similar (*prev_table);
+}
+
+static guint32
+binary_writer_add_color_state (BinaryWriter  *writer,
+                               GdkColorState *color_state)
+{
+  const GdkCicp *cicp;
+  guint32 index;
+
+  if (GDK_IS_DEFAULT_COLOR_STATE (color_state))
+    return GDK_DEFAULT_COLOR_STATE_ID (color_state);
+
+  if (binary_writer_lookup (writer->color_states, writer->prev_color_states, color_state, (GBoxedCopyFunc) gdk_color_state_ref, &index))
+    return BINARY_CUSTOM_COLOR_STATE + index;
+
+  cicp = gdk_color_state_get_cicp (color_state);
+
+  binary_append_u32 (writer->out, BINARY_RECORD_COLOR_STATE);
+  binary_append_u32 (writer->out, cicp->color_primaries);
+  binary_append_u32 (writer->out, cicp->transfer_function);
+  binary_append_u32 (writer->out, cicp->matrix_coefficients);
+  binary_append_u32 (writer->out, cicp->range);
+  binary_writer_end_record (writer);
+
+  index = writer->n_color_states++;
+  g_hash_table_insert (writer->color_states, gdk_color_state_ref (color_state), GUINT_TO_POINTER (index));
+
+  return BINARY_CUSTOM_COLOR_STATE + index;
+}
+
+static void
+binary_writer_append_color (BinaryWriter   *writer,
+                            GByteArray     *buf,
+                            const GdkColor *color)
+{
+  binary_append_u32 (buf, binary_writer_add_color_state (writer, color->color_state));
+  binary_append_floats (buf, color->values, 4);
+}
+
+static guint32
+binary_writer_add_texture (BinaryWriter *writer,
+                           GdkTexture   *texture)
+{
+  GdkTextureDownloader *downloader;
+  GdkMemoryFormat format;
+  GBytes *bytes;
+  gsize stride;
+  guint32 color_state;
+  guint32 index;
+
+  if (binary_writer_lookup (writer->textures, writer->prev_textures, texture, g_object_ref, &index))
+    return index;
+
+  format = gdk_texture_get_format (texture);
+  color_state = binary_writer_add_color_state (writer, gdk_texture_get_color_state (texture));
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, format);
+  gdk_texture_downloader_set_color_state (downloader, gdk_texture_get_color_state (texture));
+  bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
+  gdk_texture_downloader_free (downloader);
+
+  binary_append_u32 (writer->out, BINARY_RECORD_TEXTURE);
+  binary_append_u32 (writer->out, gdk_texture_get_width (texture));
+  binary_append_u32 (writer->out, gdk_texture_get_height (texture));
+  binary_append_u32 (writer->out, format);
+  binary_append_u32 (writer->out, color_state);
+  binary_append_u32 (writer->out, stride);
+  binary_append_u64 (writer->out, g_bytes_get_size (bytes));
+  binary_writer_align (writer);
+  g_byte_array_append (writer->out, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+  binary_writer_end_record (writer);
+
+  g_bytes_unref (bytes);
+
+  index = writer->n_textures++;
+  g_hash_table_insert (writer->textures, g_object_ref (texture), GUINT_TO_POINTER (index));
+
+  return index;
+}
+
+static guint32
+binary_writer_add_font (BinaryWriter *writer,
+                        PangoFont    *font)
+{
+  PangoFontDescription *desc;
+  cairo_scaled_font_t *sf;
+  cairo_font_options_t *options;
+  hb_face_t *face;
+  gboolean custom;
+  char *s;
+  guint32 index;
+
+  if (binary_writer_lookup (writer->fonts, writer->prev_fonts, font, g_object_ref, &index))
+    return index;
+
+  /* Like the text format, only embed fonts that aren't system fonts */
+  face = hb_font_get_face (pango_font_get_hb_font (font));
+  custom = g_object_get_data (G_OBJECT (pango_font_get_font_map (font)), "font-files") != NULL;
+  if (custom)
+    {
+      hb_blob_t *blob;
+      const char *data;
+      guint length;
+      char *checksum;
+
+      blob = hb_face_reference_blob (face);
+      data = hb_blob_get_data (blob, &length);
+      checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *) data, length);
+
+      if (g_hash_table_add (writer->font_files, checksum))
+        {
+          binary_append_u32 (writer->out, BINARY_RECORD_FONT_FILE);
+          binary_append_data (writer->out, data, length);
+          binary_writer_end_record (writer);
+        }
+
+      hb_blob_destroy (blob);
+    }
+
+  desc = pango_font_describe_with_absolute_size (font);
+  s = pango_font_description_to_string (desc);
+  pango_font_description_free (desc);
+
+  sf = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font));
+  options = cairo_font_options_create ();
+  cairo_scaled_font_get_font_options (sf, options);
+
+  binary_append_u32 (writer->out, BINARY_RECORD_FONT);
+  binary_append_string (writer->out, s);
+  binary_append_u32 (writer->out, custom);
+  binary_append_u32 (writer->out, cairo_font_options_get_hint_style (options));
+  binary_append_u32 (writer->out, cairo_font_options_get_antialias (options));
+  binary_append_u32 (writer->out, cairo_font_options_get_hint_metrics (options));
+  binary_writer_end_record (writer);
+
+  cairo_font_options_destroy (options);
+  g_free (s);
+
+  index = writer->n_fonts++;
+  g_hash_table_insert (writer->fonts, g_object_ref (font), GUINT_TO_POINTER (index));
+
+  return index;
+}
+
+static guint32
+binary_writer_add_glyphs (BinaryWriter         *writer,
+                          const PangoGlyphInfo *glyphs,
+                          guint                 n_glyphs)
+{
+  GByteArray *buf;
+  GBytes *key;
+  guint32 index;
+  guint i;
+
+  buf = g_byte_array_sized_new (n_glyphs * BINARY_GLYPH_SIZE);
+  for (i = 0; i < n_glyphs; i++)
+    {
+      guint32 attr;
+
+      memcpy (&attr, &glyphs[i].attr, sizeof (attr));
+
+      binary_append_u32 (buf, glyphs[i].glyph);
+      binary_append_u32 (buf, glyphs[i].geometry.width);
+      binary_append_u32 (buf, glyphs[i].geometry.x_offset);
+      binary_append_u32 (buf, glyphs[i].geometry.y_offset);
+      binary_append_u32 (buf, attr);
+    }
+  key = g_byte_array_free_to_bytes (buf);
+
+  if (binary_writer_lookup (writer->glyphs, writer->prev_glyphs, key, (GBoxedCopyFunc) g_bytes_ref, &index))
+    {
+      g_bytes_unref (key);
+      return index;
+    }
+
+  binary_append_u32 (writer->out, BINARY_RECORD_GLYPHS);
+  binary_append_u32 (writer->out, n_glyphs);
+  g_byte_array_append (writer->out, g_bytes_get_data (key, NULL), g_bytes_get_size (key));
+  binary_writer_end_record (writer);
+
+  index = writer->n_glyphs++;
+  g_hash_table_insert (writer->glyphs, key, GUINT_TO_POINTER (index));
+
+  return index;
+}
+
+static guint32 binary_writer_add_node (BinaryWriter  *writer,
+                                       GskRenderNode *node);
+
+static void
+binary_writer_append_node (BinaryWriter  *writer,
+                           GByteArray    *buf,
+                           GskRenderNode *node)
+{
+  binary_append_u32 (buf, binary_writer_add_node (writer, node));
+}
+
+static void
+binary_writer_append_cairo (BinaryWriter  *writer,
+                            GByteArray    *buf,
+                            GskRenderNode *node)
+{
+  cairo_surface_t *surface, *image;
+  GdkTexture *texture;
+  GBytes *bytes;
+  cairo_t *cr;
+  int width, height;
+
+  surface = gsk_cairo_node_get_surface (node);
+  width = ceilf (node->bounds.size.width);
+  height = ceilf (node->bounds.size.height);
+
+  if (surface == NULL || width <= 0 || height <= 0)
+    {
+      binary_append_u32 (buf, BINARY_NONE);
+      return;
+    }
+
+  /* Recording surfaces can't be stored, so we store the pixels */
+  image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (image);
+  cairo_translate (cr, - node->bounds.origin.x, - node->bounds.origin.y);
+  cairo_set_source_surface (cr, surface, 0, 0);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (image);
+
+  bytes = g_bytes_new (cairo_image_surface_get_data (image),
+                       cairo_image_surface_get_stride (image) * height);
+  texture = gdk_memory_texture_new (width, height,
+                                    GDK_MEMORY_DEFAULT,
+                                    bytes,
+                                    cairo_image_surface_get_stride (image));
+  binary_append_u32 (buf, binary_writer_add_texture (writer, texture));
+
+  g_object_unref (texture);
+  g_bytes_unref (bytes);
+  cairo_surface_destroy (image);
+}
+
+static void
+binary_writer_append_gl_shader (BinaryWriter  *writer,
+                                GByteArray    *buf,
+                                GskRenderNode *node)
+{
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  GskGLShader *shader = gsk_gl_shader_node_get_shader (node);
+  GBytes *source = gsk_gl_shader_get_source (shader);
+  GBytes *args = gsk_gl_shader_node_get_args (node);
+  guint i, n_children;
+
+  binary_append_rect (buf, &node->bounds);
+  binary_append_data (buf, g_bytes_get_data (source, NULL), g_bytes_get_size (source));
+  binary_append_data (buf, g_bytes_get_data (args, NULL), g_bytes_get_size (args));
+
+  n_children = gsk_gl_shader_node_get_n_children (node);
+  binary_append_u32 (buf, n_children);
+  for (i = 0; i < n_children; i++)
+    binary_writer_append_node (writer, buf, gsk_gl_shader_node_get_child (node, i));
+G_GNUC_END_IGNORE_DEPRECATIONS
+}
+
+static void
+binary_writer_append_node_data (BinaryWriter  *writer,
+                                GByteArray    *buf,
+                                GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i, n_children;
+
+        n_children = gsk_container_node_get_n_children (node);
+        binary_append_u32 (buf, n_children);
+        for (i = 0; i < n_children; i++)
+          binary_writer_append_node (writer, buf, gsk_container_node_get_child (node, i));
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_writer_append_cairo (writer, buf, node);
+      break;
+
+    case GSK_COLOR_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_writer_append_color (writer, buf, gsk_color_node_get_color2 (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_append_point (buf, gsk_linear_gradient_node_get_start (node));
+      binary_append_point (buf, gsk_linear_gradient_node_get_end (node));
+      binary_append_stops (buf,
+                           gsk_linear_gradient_node_get_color_stops (node, NULL),
+                           gsk_linear_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_append_point (buf, gsk_radial_gradient_node_get_center (node));
+      binary_append_float (buf, gsk_radial_gradient_node_get_hradius (node));
+      binary_append_float (buf, gsk_radial_gradient_node_get_vradius (node));
+      binary_append_float (buf, gsk_radial_gradient_node_get_start (node));
+      binary_append_float (buf, gsk_radial_gradient_node_get_end (node));
+      binary_append_stops (buf,
+                           gsk_radial_gradient_node_get_color_stops (node, NULL),
+                           gsk_radial_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_append_point (buf, gsk_conic_gradient_node_get_center (node));
+      binary_append_float (buf, gsk_conic_gradient_node_get_rotation (node));
+      binary_append_stops (buf,
+                           gsk_conic_gradient_node_get_color_stops (node, NULL),
+                           gsk_conic_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        const GdkColor *colors = gsk_border_node_get_colors2 (node);
+        guint i;
+
+        binary_append_rounded_rect (buf, gsk_border_node_get_outline (node));
+        binary_append_floats (buf, gsk_border_node_get_widths (node), 4);
+        for (i = 0; i < 4; i++)
+          binary_writer_append_color (writer, buf, &colors[i]);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_append_u32 (buf, binary_writer_add_texture (writer, gsk_texture_node_get_texture (node)));
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      binary_append_rounded_rect (buf, gsk_inset_shadow_node_get_outline (node));
+      binary_writer_append_color (writer, buf, gsk_inset_shadow_node_get_color2 (node));
+      binary_append_point (buf, gsk_inset_shadow_node_get_offset (node));
+      binary_append_float (buf, gsk_inset_shadow_node_get_spread (node));
+      binary_append_float (buf, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      binary_append_rounded_rect (buf, gsk_outset_shadow_node_get_outline (node));
+      binary_writer_append_color (writer, buf, gsk_outset_shadow_node_get_color2 (node));
+      binary_append_point (buf, gsk_outset_shadow_node_get_offset (node));
+      binary_append_float (buf, gsk_outset_shadow_node_get_spread (node));
+      binary_append_float (buf, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      binary_append_transform (buf, gsk_transform_node_get_transform (node));
+      binary_writer_append_node (writer, buf, gsk_transform_node_get_child (node));
+      break;
+
+    case GSK_OPACITY_NODE:
+      binary_append_float (buf, gsk_opacity_node_get_opacity (node));
+      binary_writer_append_node (writer, buf, gsk_opacity_node_get_child (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      binary_append_matrix (buf, gsk_color_matrix_node_get_color_matrix (node));
+      binary_append_vec4 (buf, gsk_color_matrix_node_get_color_offset (node));
+      binary_writer_append_node (writer, buf, gsk_color_matrix_node_get_child (node));
+      break;
+
+    case GSK_REPEAT_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_append_rect (buf, gsk_repeat_node_get_child_bounds (node));
+      binary_writer_append_node (writer, buf, gsk_repeat_node_get_child (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      binary_append_rect (buf, gsk_clip_node_get_clip (node));
+      binary_writer_append_node (writer, buf, gsk_clip_node_get_child (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      binary_append_rounded_rect (buf, gsk_rounded_clip_node_get_clip (node));
+      binary_writer_append_node (writer, buf, gsk_rounded_clip_node_get_child (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        gsize i, n_shadows;
+
+        n_shadows = gsk_shadow_node_get_n_shadows (node);
+        binary_append_u32 (buf, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            const GskShadow2 *shadow = gsk_shadow_node_get_shadow2 (node, i);
+
+            binary_writer_append_color (writer, buf, &shadow->color);
+            binary_append_point (buf, &shadow->offset);
+            binary_append_float (buf, shadow->radius);
+          }
+        binary_writer_append_node (writer, buf, gsk_shadow_node_get_child (node));
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      binary_append_u32 (buf, gsk_blend_node_get_blend_mode (node));
+      binary_writer_append_node (writer, buf, gsk_blend_node_get_bottom_child (node));
+      binary_writer_append_node (writer, buf, gsk_blend_node_get_top_child (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      binary_append_float (buf, gsk_cross_fade_node_get_progress (node));
+      binary_writer_append_node (writer, buf, gsk_cross_fade_node_get_start_child (node));
+      binary_writer_append_node (writer, buf, gsk_cross_fade_node_get_end_child (node));
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        const PangoGlyphInfo *glyphs;
+        guint n_glyphs;
+
+        glyphs = gsk_text_node_get_glyphs (node, &n_glyphs);
+        binary_append_u32 (buf, binary_writer_add_font (writer, gsk_text_node_get_font (node)));
+        binary_append_u32 (buf, binary_writer_add_glyphs (writer, glyphs, n_glyphs));
+        binary_writer_append_color (writer, buf, gsk_text_node_get_color2 (node));
+        binary_append_point (buf, gsk_text_node_get_offset (node));
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      binary_append_float (buf, gsk_blur_node_get_radius (node));
+      binary_writer_append_node (writer, buf, gsk_blur_node_get_child (node));
+      break;
+
+    case GSK_DEBUG_NODE:
+      binary_append_string (buf, gsk_debug_node_get_message (node));
+      binary_writer_append_node (writer, buf, gsk_debug_node_get_child (node));
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      binary_writer_append_gl_shader (writer, buf, node);
+      break;
+
+    case GSK_TEXTURE_SCALE_NODE:
+      binary_append_rect (buf, &node->bounds);
+      binary_append_u32 (buf, gsk_texture_scale_node_get_filter (node));
+      binary_append_u32 (buf, binary_writer_add_texture (writer, gsk_texture_scale_node_get_texture (node)));
+      break;
+
+    case GSK_MASK_NODE:
+      binary_append_u32 (buf, gsk_mask_node_get_mask_mode (node));
+      binary_writer_append_node (writer, buf, gsk_mask_node_get_source (node));
+      binary_writer_append_node (writer, buf, gsk_mask_node_get_mask (node));
+      break;
+
+    case GSK_FILL_NODE:
+      binary_append_path (buf, gsk_fill_node_get_path (node));
+      binary_append_u32 (buf, gsk_fill_node_get_fill_rule (node));
+      binary_writer_append_node (writer, buf, gsk_fill_node_get_child (node));
+      break;
+
+    case GSK_STROKE_NODE:
+      {
+        const GskStroke *stroke = gsk_stroke_node_get_stroke (node);
+        const float *dash;
+        gsize n_dash;
+
+        binary_append_path (buf, gsk_stroke_node_get_path (node));
+        binary_append_float (buf, gsk_stroke_get_line_width (stroke));
+        binary_append_u32 (buf, gsk_stroke_get_line_cap (stroke));
+        binary_append_u32 (buf, gsk_stroke_get_line_join (stroke));
+        binary_append_float (buf, gsk_stroke_get_miter_limit (stroke));
+        dash = gsk_stroke_get_dash (stroke, &n_dash);
+        binary_append_u32 (buf, n_dash);
+        binary_append_floats (buf, dash, n_dash);
+        binary_append_float (buf, gsk_stroke_get_dash_offset (stroke));
+        binary_writer_append_node (writer, buf, gsk_stroke_node_get_child (node));
+      }
+      break;
+
+    case GSK_SUBSURFACE_NODE:
+      binary_writer_append_node (writer, buf, gsk_subsurface_node_get_child (node));
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+static guint32
+binary_writer_add_node (BinaryWriter  *writer,
+                        GskRenderNode *node)
+{
+  GByteArray *buf;
+  guint32 index;
+
+  if (binary_writer_lookup (writer->nodes, writer->prev_nodes, node, (GBoxedCopyFunc) gsk_render_node_ref, &index))
+    return index;
+
+  /* Children are written while we collect the data of their parent,
+   * so every level of the tree gets its own buffer.
+   */
+  if (writer->depth == writer->payloads->len)
+    g_ptr_array_add (writer->payloads, g_byte_array_new ());
+  buf = g_ptr_array_index (writer->payloads, writer->depth);
+  g_byte_array_set_size (buf, 0);
+
+  writer->depth++;
+  binary_writer_append_node_data (writer, buf, node);
+  writer->depth--;
+
+  binary_append_u32 (writer->out, BINARY_RECORD_NODE);
+  binary_append_u32 (writer->out, gsk_render_node_get_node_type (node));
+  binary_append_data (writer->out, buf->data, buf->len);
+  binary_writer_end_record (writer);
+
+  index = writer->n_nodes++;
+  g_hash_table_insert (writer->nodes, gsk_render_node_ref (node), GUINT_TO_POINTER (index));
+
+  return index;
+}
+
+static void
+binary_writer_init (BinaryWriter  *writer,
+                    GOutputStream *stream,
+                    GCancellable  *cancellable)
+{
+  memset (writer, 0, sizeof (BinaryWriter));
+
+  writer->stream = stream;
+  writer->cancellable = cancellable;
+  writer->out = g_byte_array_sized_new (BINARY_FLUSH_SIZE);
+  writer->payloads = g_ptr_array_new_with_free_func ((GDestroyNotify) g_byte_array_unref);
+  writer->nodes = g_hash_table_new_full (NULL, NULL, (GDestroyNotify) gsk_render_node_unref, NULL);
+  writer->textures = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+  writer->color_states = g_hash_table_new_full (NULL, NULL, (GDestroyNotify) gdk_color_state_unref, NULL);
+  writer->fonts = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+  writer->font_files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  writer->glyphs = g_hash_table_new_full (g_bytes_hash, g_bytes_equal, (GDestroyNotify) g_bytes_unref, NULL);
+}
+
+static void
+binary_writer_clear (BinaryWriter *writer)
+{
+  g_clear_pointer (&writer->out, g_byte_array_unref);
+  g_ptr_array_unref (writer->payloads);
+  g_hash_table_unref (writer->nodes);
+  g_clear_pointer (&writer->prev_nodes, g_hash_table_unref);
+  g_hash_table_unref (writer->textures);
+  g_clear_pointer (&writer->prev_textures, g_hash_table_unref);
+  g_hash_table_unref (writer->color_states);
+  g_clear_pointer (&writer->prev_color_states, g_hash_table_unref);
+  g_hash_table_unref (writer->fonts);
+  g_clear_pointer (&writer->prev_fonts, g_hash_table_unref);
+  g_hash_table_unref (writer->font_files);
+  g_hash_table_unref (writer->glyphs);
+  g_clear_pointer (&writer->prev_glyphs, g_hash_table_unref);
+  g_clear_error (&writer->error);
+}
+
+static void
+binary_writer_begin (BinaryWriter *writer,
+                     guint32       flags)
+{
+  g_byte_array_append (writer->out, binary_magic, sizeof (binary_magic));
+  binary_append_u32 (writer->out, BINARY_VERSION);
+  binary_append_u32 (writer->out, flags);
+}
+
+static void
+binary_writer_write (BinaryWriter  *writer,
+                     GskRenderNode *node)
+{
+  guint32 root;
+
+  binary_writer_begin (writer, 0);
+
+  root = binary_writer_add_node (writer, node);
+
+  binary_append_u32 (writer->out, BINARY_RECORD_END);
+  binary_append_u32 (writer->out, root);
+  binary_writer_flush (writer);
+}
+
+/*< private >
+ * gsk_render_node_serialize_binary:
+ * @node: a `GskRenderNode`
+ *
+ * Serializes the @node in the binary format.
+ *
+ * Like the text format produced by gsk_render_node_serialize(), the
+ * result can be loaded with gsk_render_node_deserialize(), and the
+ * same restrictions apply.
+ *
+ * Returns: a `GBytes` representing the node.
+ */
+GBytes *
+gsk_render_node_serialize_binary (GskRenderNode *node)
+{
+  BinaryWriter writer;
+  GBytes *result;
+
+  binary_writer_init (&writer, NULL, NULL);
+  binary_writer_write (&writer, node);
+
+  result = g_byte_array_free_to_bytes (g_steal_pointer (&writer.out));
+
+  binary_writer_clear (&writer);
+
+  return result;
+}
+
+/*< private >
+ * gsk_render_node_write_binary:
+ * @node: a `GskRenderNode`
+ * @stream: the stream to write to
+ * @cancellable: (nullable): a `GCancellable`
+ * @error: return location for an error
+ *
+ * Writes the @node to @stream in the binary format.
+ *
+ * Unlike gsk_render_node_serialize_binary(), the data is written while
+ * the tree is being walked, so large trees don't need to be kept in
+ * memory as a whole.
+ *
+ * Returns: %TRUE if the node was written successfully
+ */
+gboolean
+gsk_render_node_write_binary (GskRenderNode  *node,
+                              GOutputStream  *stream,
+                              GCancellable   *cancellable,
+                              GError        **error)
+{
+  BinaryWriter writer;
+  gboolean result;
+
+  binary_writer_init (&writer, stream, cancellable);
+  binary_writer_write (&writer, node);
+
+  if (writer.error)
+    {
+      g_propagate_error (error, g_steal_pointer (&writer.error));
+      result = FALSE;
+    }
+  else
+    result = TRUE;
+
+  binary_writer_clear (&writer);
+
+  return result;
+}
+
+struct _GskRenderTraceWriter
+{
+  BinaryWriter writer;
+  GOutputStream *stream;
+};
+
+/*< private >
+ * gsk_render_trace_writer_new:
+ * @stream: the stream to write to
+ *
+ * Creates a writer for a trace of frames, in the binary format.
+ *
+ * Subtrees, textures, fonts, glyphs and color states that are
+ * shared with the previous frame are only written once. Anything
+ * older is released, so memory use does not grow with the trace.
+ *
+ * Returns: (transfer full): a new `GskRenderTraceWriter`
+ */
+GskRenderTraceWriter *
+gsk_render_trace_writer_new (GOutputStream *stream)
+{
+  GskRenderTraceWriter *self;
+
+  self = g_new0 (GskRenderTraceWriter, 1);
+  self->stream = g_object_ref (stream);
+
+  binary_writer_init (&self->writer, self->stream, NULL);
+  binary_writer_begin (&self->writer, BINARY_FLAG_TRACE);
+
+  return self;
+}
+
+/*< private >
+ * gsk_render_trace_writer_add_frame:
+ * @self: a `GskRenderTraceWriter`
+ * @node: the root node of the frame
+ * @region: the region that was redrawn
+ * @width: the width of the surface
+ * @height: the height of the surface
+ * @time: the monotonic time the frame was started at
+ * @duration: the time it took to render the frame, in microseconds
+ *
+ * Writes a frame to the trace.
+ *
+ * The frame is flushed to the stream right away, so the trace
+ * stays usable if the application doesn't exit cleanly.
+ *
+ * Returns: %FALSE if writing failed. No more frames are written then.
+ */
+gboolean
+gsk_render_trace_writer_add_frame (GskRenderTraceWriter *self,
+                                   GskRenderNode        *node,
+                                   const cairo_region_t *region,
+                                   int                   width,
+                                   int                   height,
+                                   gint64                time,
+                                   gint64                duration)
+{
+  BinaryWriter *writer = &self->writer;
+  guint32 root;
+  int i, n_rects;
+
+  if (writer->error)
+    return FALSE;
+
+  /* Only keep what the previous frame used */
+  binary_writer_rotate (&writer->nodes, &writer->prev_nodes);
+  binary_writer_rotate (&writer->textures, &writer->prev_textures);
+  binary_writer_rotate (&writer->color_states, &writer->prev_color_states);
+  binary_writer_rotate (&writer->fonts, &writer->prev_fonts);
+  binary_writer_rotate (&writer->glyphs, &writer->prev_glyphs);
+
+  root = binary_writer_add_node (writer, node);
+
+  n_rects = cairo_region_num_rectangles (region);
+
+  binary_append_u32 (writer->out, BINARY_RECORD_FRAME);
+  binary_append_u32 (writer->out, root);
+  binary_append_u32 (writer->out, width);
+  binary_append_u32 (writer->out, height);
+  binary_append_u64 (writer->out, time);
+  binary_append_u64 (writer->out, duration);
+  binary_append_u32 (writer->out, n_rects);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (region, i, &rect);
+      binary_append_u32 (writer->out, rect.x);
+      binary_append_u32 (writer->out, rect.y);
+      binary_append_u32 (writer->out, rect.width);
+      binary_append_u32 (writer->out, rect.height);
+    }
+
+  binary_writer_flush (writer);
+
+  return writer->error == NULL;
+}
+
+/*< private >
+ * gsk_render_trace_writer_free:
+ * @self: a `GskRenderTraceWriter`
+ *
+ * Closes the stream and frees the writer.
+ */
+void
+gsk_render_trace_writer_free (GskRenderTraceWriter *self)
+{
+  binary_writer_flush (&self->writer);
+  binary_writer_clear (&self->writer);
+  g_output_stream_close (self->stream, NULL, NULL);
+  g_object_unref (self->stream);
+  g_free (self);
+}
+
+typedef struct
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+  gsize pos;
+  gboolean failed;
+  GskParseErrorFunc error_func;
+  gpointer user_data;
+  Context context;
+  GPtrArray *nodes;
+  GPtrArray *textures;
+  GPtrArray *color_states;
+  GPtrArray *fonts;
+  GPtrArray *glyphs;
+  GArray *frames;
+} BinaryReader;
+
+static void G_GNUC_PRINTF (2, 3)
+binary_reader_error (BinaryReader *reader,
+                     const char   *format,
+                     ...)
+{
+  GskParseLocation location;
+  GError *error;
+  va_list args;
+
+  if (reader->failed)
+    return;
+
+  reader->failed = TRUE;
+
+  if (reader->error_func == NULL)
+    return;
+
+  va_start (args, format);
+  error = g_error_new_valist (GTK_CSS_PARSER_ERROR, GTK_CSS_PARSER_ERROR_SYNTAX, format, args);
+  va_end (args);
+
+  /* There are no lines, so report the offset as the position in the first line */
+  location = (GskParseLocation) {
+    .bytes = reader->pos,
+    .chars = reader->pos,
+    .lines = 0,
+    .line_bytes = reader->pos,
+    .line_chars = reader->pos,
+  };
+
+  reader->error_func (&location, &location, error, reader->user_data);
+
+  g_error_free (error);
+}
+
+static const guchar *
+binary_reader_take (BinaryReader *reader,
+                    gsize         size)
+{
+  const guchar *result;
+
+  if (reader->failed)
+    return NULL;
+
+  if (size > reader->size - reader->pos)
+    {
+      binary_reader_error (reader, "Unexpected end of data");
+      return NULL;
+    }
+
+  result = reader->data + reader->pos;
+  reader->pos += size;
+
+  return result;
+}
+
+static gboolean
+binary_reader_has (BinaryReader *reader,
+                   guint32       n_items,
+                   gsize         item_size)
+{
+  if (reader->failed)
+    return FALSE;
+
+  if (n_items > (reader->size - reader->pos) / item_size)
+    {
+      binary_reader_error (reader, "Unexpected end of data");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static guint32
+binary_reader_u32 (BinaryReader *reader)
+{
+  const guchar *data;
+  guint32 value;
+
+  data = binary_reader_take (reader, sizeof (value));
+  if (data == NULL)
+    return 0;
+
+  memcpy (&value, data, sizeof (value));
+
+  return GUINT32_FROM_LE (value);
+}
+
+static guint64
+binary_reader_u64 (BinaryReader *reader)
+{
+  const guchar *data;
+  guint64 value;
+
+  data = binary_reader_take (reader, sizeof (value));
+  if (data == NULL)
+    return 0;
+
+  memcpy (&value, data, sizeof (value));
+
+  return GUINT64_FROM_LE (value);
+}
+
+static float
+binary_reader_float (BinaryReader *reader)
+{
+  guint32 u;
+  float value;
+
+  u = binary_reader_u32 (reader);
+  memcpy (&value, &u, sizeof (value));
+
+  return value;
+}
+
+static void
+binary_reader_floats (BinaryReader *reader,
+                      float        *values,
+                      gsize         n_values)
+{
+  gsize i;
+
+  for (i = 0; i < n_values; i++)
+    values[i] = binary_reader_float (reader);
+}
+
+static float
+binary_reader_positive_float (BinaryReader *reader)
+{
+  float value;
+
+  value = binary_reader_float (reader);
+  if (!reader->failed && !(value >= 0))
+    binary_reader_error (reader, "Expected a positive number");
+
+  return value;
+}
+
+static float
+binary_reader_strictly_positive_float (BinaryReader *reader)
+{
+  float value;
+
+  value = binary_reader_float (reader);
+  if (!reader->failed && !(value > 0))
+    binary_reader_error (reader, "Expected a strictly positive number");
+
+  return value;
+}
+
+static guint32
+binary_reader_enum (BinaryReader *reader,
+                    guint32       max)
+{
+  guint32 value;
+
+  value = binary_reader_u32 (reader);
+  if (value > max)
+    {
+      binary_reader_error (reader, "Invalid enum value %u", value);
+      return 0;
+    }
+
+  return value;
+}
+
+static GBytes *
+binary_reader_data (BinaryReader *reader)
+{
+  const guchar *data;
+  guint32 size;
+
+  size = binary_reader_u32 (reader);
+  data = binary_reader_take (reader, size);
+  if (data == NULL)
+    return NULL;
+
+  return g_bytes_new_from_bytes (reader->bytes, data - reader->data, size);
+}
+
+static char *
+binary_reader_string (BinaryReader *reader)
+{
+  const guchar *data;
+  guint32 size;
+
+  size = binary_reader_u32 (reader);
+  if (size == BINARY_NONE)
+    return NULL;
+
+  data = binary_reader_take (reader, size);
+  if (data == NULL)
+    return NULL;
+
+  return g_strndup ((const char *) data, size);
+}
+
+static void
+binary_reader_point (BinaryReader     *reader,
+                     graphene_point_t *point)
+{
+  point->x = binary_reader_float (reader);
+  point->y = binary_reader_float (reader);
+}
+
+static void
+binary_reader_rect (BinaryReader    *reader,
+                    graphene_rect_t *rect)
+{
+  rect->origin.x = binary_reader_float (reader);
+  rect->origin.y = binary_reader_float (reader);
+  rect->size.width = binary_reader_float (reader);
+  rect->size.height = binary_reader_float (reader);
+}
+
+static void
+binary_reader_rounded_rect (BinaryReader   *reader,
+                            GskRoundedRect *rect)
+{
+  guint i;
+
+  binary_reader_rect (reader, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      rect->corner[i].width = binary_reader_float (reader);
+      rect->corner[i].height = binary_reader_float (reader);
+    }
+}
+
+static GskColorStop *
+binary_reader_stops (BinaryReader *reader,
+                     gsize        *n_stops)
+{
+  GskColorStop *stops;
+  gsize i;
+
+  *n_stops = binary_reader_u32 (reader);
+  if (!binary_reader_has (reader, *n_stops, 5 * sizeof (float)))
+    return NULL;
+
+  if (*n_stops < 2)
+    {
+      binary_reader_error (reader, "At least 2 color stops need to be specified");
+      return NULL;
+    }
+
+  stops = g_new (GskColorStop, *n_stops);
+  for (i = 0; i < *n_stops; i++)
+    {
+      stops[i].offset = binary_reader_float (reader);
+      stops[i].color.red = binary_reader_float (reader);
+      stops[i].color.green = binary_reader_float (reader);
+      stops[i].color.blue = binary_reader_float (reader);
+      stops[i].color.alpha = binary_reader_float (reader);
+
+      if (i == 0 && !(stops[i].offset >= 0))
+        binary_reader_error (reader, "Color stop offset must be >= 0");
+      else if (i > 0 && !(stops[i].offset >= stops[i - 1].offset))
+        binary_reader_error (reader, "Color stop offset must be >= previous value");
+      else if (!(stops[i].offset <= 1))
+        binary_reader_error (reader, "Color stop offset must be <= 1");
+    }
+
+  if (reader->failed)
+    g_clear_pointer (&stops, g_free);
+
+  return stops;
+}
+
+static void
+binary_reader_matrix (BinaryReader      *reader,
+                      graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  binary_reader_floats (reader, values, 16);
+  graphene_matrix_init_from_float (matrix, values);
+}
+
+static void
+binary_reader_vec4 (BinaryReader    *reader,
+                    graphene_vec4_t *vec)
+{
+  float values[4];
+
+  binary_reader_floats (reader, values, 4);
+  graphene_vec4_init_from_float (vec, values);
+}
+
+static GskTransform *
+binary_reader_transform (BinaryReader *reader)
+{
+  GskTransform *transform = NULL;
+  float scale_x, scale_y, dx, dy;
+  char *s;
+
+  switch (binary_reader_enum (reader, BINARY_TRANSFORM_STRING))
+    {
+    case BINARY_TRANSFORM_IDENTITY:
+      break;
+
+    case BINARY_TRANSFORM_TRANSLATE:
+      dx = binary_reader_float (reader);
+      dy = binary_reader_float (reader);
+      transform = gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (dx, dy));
+      break;
+
+    case BINARY_TRANSFORM_AFFINE:
+      scale_x = binary_reader_float (reader);
+      scale_y = binary_reader_float (reader);
+      dx = binary_reader_float (reader);
+      dy = binary_reader_float (reader);
+      transform = gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (dx, dy));
+      transform = gsk_transform_scale (transform, scale_x, scale_y);
+      break;
+
+    case BINARY_TRANSFORM_STRING:
+      s = binary_reader_string (reader);
+      if (!reader->failed && (s == NULL || !gsk_transform_parse (s, &transform)))
+        binary_reader_error (reader, "Invalid transform");
+      g_free (s);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return transform;
+}
+
+static GskPath *
+binary_reader_path (BinaryReader *reader)
+{
+  GskPathBuilder *builder;
+  graphene_point_t pts[3];
+  guint32 op;
+  guint i;
+
+  builder = gsk_path_builder_new ();
+
+  while (!reader->failed)
+    {
+      op = binary_reader_u32 (reader);
+      if (op == BINARY_NONE)
+        break;
+
+      if (op >= G_N_ELEMENTS (binary_path_points))
+        {
+          binary_reader_error (reader, "Invalid path operation %u", op);
+          break;
+        }
+
+      for (i = 0; i < binary_path_points[op]; i++)
+        binary_reader_point (reader, &pts[i]);
+
+      switch ((GskPathOperation) op)
+        {
+        case GSK_PATH_MOVE:
+          gsk_path_builder_move_to (builder, pts[0].x, pts[0].y);
+          break;
+
+        case GSK_PATH_CLOSE:
+          gsk_path_builder_close (builder);
+          break;
+
+        case GSK_PATH_LINE:
+          gsk_path_builder_line_to (builder, pts[0].x, pts[0].y);
+          break;
+
+        case GSK_PATH_QUAD:
+          gsk_path_builder_quad_to (builder, pts[0].x, pts[0].y, pts[1].x, pts[1].y);
+          break;
+
+        case GSK_PATH_CUBIC:
+          gsk_path_builder_cubic_to (builder, pts[0].x, pts[0].y, pts[1].x, pts[1].y, pts[2].x, pts[2].y);
+          break;
+
+        case GSK_PATH_CONIC:
+          gsk_path_builder_conic_to (builder, pts[0].x, pts[0].y, pts[1].x, pts[1].y, binary_reader_float (reader));
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  return gsk_path_builder_free_to_path (builder);
+}
+
+static GdkColorState *
+binary_reader_color_state (BinaryReader *reader)
+{
+  guint32 id;
+
+  id = binary_reader_u32 (reader);
+  if (id < GDK_COLOR_STATE_N_IDS)
+    return gdk_color_state_get_by_id (id);
+
+  if (id >= BINARY_CUSTOM_COLOR_STATE &&
+      id - BINARY_CUSTOM_COLOR_STATE < reader->color_states->len)
+    return g_ptr_array_index (reader->color_states, id - BINARY_CUSTOM_COLOR_STATE);
+
+  binary_reader_error (reader, "Invalid color state reference %u", id);
+
+  return GDK_COLOR_STATE_SRGB;
+}
+
+static void
+binary_reader_color (BinaryReader *reader,
+                     GdkColor     *color)
+{
+  GdkColorState *color_state;
+  float values[4];
+
+  color_state = binary_reader_color_state (reader);
+  binary_reader_floats (reader, values, 4);
+
+  gdk_color_init (color, color_state, values);
+}
+
+static gpointer
+binary_reader_lookup (BinaryReader *reader,
+                      GPtrArray    *array,
+                      guint32       index,
+                      const char   *name)
+{
+  if (reader->failed)
+    return NULL;
+
+  if (index >= array->len)
+    {
+      binary_reader_error (reader, "Invalid %s reference %u", name, index);
+      return NULL;
+    }
+
+  return g_ptr_array_index (array, index);
+}
+
+static gpointer
+binary_reader_ref (BinaryReader *reader,
+                   GPtrArray    *array,
+                   const char   *name)
+{
+  return binary_reader_lookup (reader, array, binary_reader_u32 (reader), name);
+}
+
+#define binary_reader_node(reader) ((GskRenderNode *) binary_reader_ref ((reader), (reader)->nodes, "node"))
+#define binary_reader_texture(reader) ((GdkTexture *) binary_reader_ref ((reader), (reader)->textures, "texture"))
+#define binary_reader_font(reader) ((PangoFont *) binary_reader_ref ((reader), (reader)->fonts, "font"))
+#define binary_reader_glyphs(reader) ((PangoGlyphString *) binary_reader_ref ((reader), (reader)->glyphs, "glyphs"))
+
+static void
+binary_reader_color_state_record (BinaryReader *reader)
+{
+  GdkColorState *color_state;
+  GdkCicp cicp;
+  GError *error = NULL;
+
+  cicp.color_primaries = binary_reader_u32 (reader);
+  cicp.transfer_function = binary_reader_u32 (reader);
+  cicp.matrix_coefficients = binary_reader_u32 (reader);
+  cicp.range = binary_reader_enum (reader, GDK_CICP_RANGE_FULL);
+  if (reader->failed)
+    return;
+
+  color_state = gdk_color_state_new_for_cicp (&cicp, &error);
+  if (color_state == NULL)
+    {
+      binary_reader_error (reader, "%s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  g_ptr_array_add (reader->color_states, color_state);
+}
+
+static void
+binary_reader_texture_record (BinaryReader *reader)
+{
+  GdkMemoryTextureBuilder *builder;
+  GdkColorState *color_state;
+  GdkMemoryFormat format;
+  guint32 width, height, stride;
+  guint64 size;
+  gsize bpp, offset;
+  const guchar *data;
+  GBytes *bytes;
+
+  width = binary_reader_u32 (reader);
+  height = binary_reader_u32 (reader);
+  format = binary_reader_enum (reader, GDK_MEMORY_N_FORMATS - 1);
+  color_state = binary_reader_color_state (reader);
+  stride = binary_reader_u32 (reader);
+  size = binary_reader_u64 (reader);
+
+  offset = reader->pos % BINARY_ALIGNMENT;
+  if (offset)
+    binary_reader_take (reader, BINARY_ALIGNMENT - offset);
+
+  if (size > G_MAXSIZE)
+    {
+      binary_reader_error (reader, "Texture too large");
+      return;
+    }
+
+  data = binary_reader_take (reader, size);
+  if (data == NULL)
+    return;
+
+  bpp = gdk_memory_format_bytes_per_pixel (format);
+  if (width == 0 || height == 0 || width > G_MAXINT || height > G_MAXINT ||
+      stride / bpp < width || size < (gsize) width * bpp ||
+      (size - (gsize) width * bpp) / stride < height - 1)
+    {
+      binary_reader_error (reader, "Invalid texture data");
+      return;
+    }
+
+  bytes = g_bytes_new_from_bytes (reader->bytes, data - reader->data, size);
+
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_width (builder, width);
+  gdk_memory_texture_builder_set_height (builder, height);
+  gdk_memory_texture_builder_set_format (builder, format);
+  gdk_memory_texture_builder_set_color_state (builder, color_state);
+  gdk_memory_texture_builder_set_bytes (builder, bytes);
+  gdk_memory_texture_builder_set_stride (builder, stride);
+
+  g_ptr_array_add (reader->textures, gdk_memory_texture_builder_build (builder));
+
+  g_object_unref (builder);
+  g_bytes_unref (bytes);
+}
+
+static void
+binary_reader_font_file_record (BinaryReader *reader)
+{
+  GBytes *bytes;
+  GError *error = NULL;
+
+  bytes = binary_reader_data (reader);
+  if (bytes == NULL)
+    return;
+
+  if (!add_font_from_bytes (&reader->context, bytes, &error))
+    {
+      binary_reader_error (reader, "%s", error->message);
+      g_error_free (error);
+    }
+
+  g_bytes_unref (bytes);
+}
+
+static void
+binary_reader_font_record (BinaryReader *reader)
+{
+  PangoFont *font = NULL, *hinted;
+  cairo_hint_style_t hint_style;
+  cairo_antialias_t antialias;
+  cairo_hint_metrics_t hint_metrics;
+  gboolean custom;
+  char *name;
+
+  name = binary_reader_string (reader);
+  custom = binary_reader_u32 (reader);
+  hint_style = binary_reader_enum (reader, CAIRO_HINT_STYLE_FULL);
+  antialias = binary_reader_enum (reader, CAIRO_ANTIALIAS_BEST);
+  hint_metrics = binary_reader_enum (reader, CAIRO_HINT_METRICS_ON);
+
+  if (reader->failed)
+    {
+      g_free (name);
+      return;
+    }
+
+  if (name == NULL)
+    {
+      binary_reader_error (reader, "Missing font name");
+      return;
+    }
+
+  if (reader->context.fontmap)
+    font = font_from_string (reader->context.fontmap, name, FALSE);
+
+  if (!font && !custom)
+    font = font_from_string (pango_cairo_font_map_get_default (), name, TRUE);
+
+  if (!font)
+    {
+      binary_reader_error (reader, "The font \"%s\" does not exist", name);
+      g_free (name);
+      return;
+    }
+
+  hinted = gsk_reload_font (font, 1.0, hint_metrics, hint_style, antialias);
+  g_ptr_array_add (reader->fonts, hinted);
+
+  g_object_unref (font);
+  g_free (name);
+}
+
+static void
+binary_reader_glyphs_record (BinaryReader *reader)
+{
+  PangoGlyphString *glyphs;
+  guint32 i, n_glyphs;
+
+  n_glyphs = binary_reader_u32 (reader);
+  if (!binary_reader_has (reader, n_glyphs, BINARY_GLYPH_SIZE))
+    return;
+
+  glyphs = pango_glyph_string_new ();
+  pango_glyph_string_set_size (glyphs, n_glyphs);
+
+  for (i = 0; i < n_glyphs; i++)
+    {
+      PangoGlyphInfo *gi = &glyphs->glyphs[i];
+      guint32 attr;
+
+      gi->glyph = binary_reader_u32 (reader);
+      gi->geometry.width = (gint32) binary_reader_u32 (reader);
+      gi->geometry.x_offset = (gint32) binary_reader_u32 (reader);
+      gi->geometry.y_offset = (gint32) binary_reader_u32 (reader);
+      attr = binary_reader_u32 (reader);
+      memcpy (&gi->attr, &attr, sizeof (attr));
+    }
+
+  g_ptr_array_add (reader->glyphs, glyphs);
+}
+
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+static GskRenderNode *
+binary_reader_children_node (BinaryReader          *reader,
+                             GskRenderNodeType      type,
+                             const graphene_rect_t *bounds)
+{
+  GskRenderNode **children;
+  GskRenderNode *result = NULL;
+  GskGLShader *shader = NULL;
+  GBytes *source = NULL, *args = NULL;
+  guint32 i, n_children;
+
+  if (type == GSK_GL_SHADER_NODE)
+    {
+      source = binary_reader_data (reader);
+      args = binary_reader_data (reader);
+    }
+
+  n_children = binary_reader_u32 (reader);
+  if (!binary_reader_has (reader, n_children, sizeof (guint32)))
+    goto out;
+
+  children = g_new (GskRenderNode *, n_children);
+  for (i = 0; i < n_children; i++)
+    children[i] = binary_reader_node (reader);
+
+  if (!reader->failed)
+    {
+      if (type == GSK_CONTAINER_NODE)
+        {
+          result = gsk_container_node_new (children, n_children);
+        }
+      else
+        {
+          shader = gsk_gl_shader_new_from_bytes (source);
+          if (g_bytes_get_size (args) != gsk_gl_shader_get_args_size (shader))
+            binary_reader_error (reader, "Shader needs %zu bytes of arguments, but %zu were given",
+                                 gsk_gl_shader_get_args_size (shader), g_bytes_get_size (args));
+          else if (n_children != 0 && n_children != gsk_gl_shader_get_n_textures (shader))
+            binary_reader_error (reader, "Shader needs %d children, but %u were given",
+                                 gsk_gl_shader_get_n_textures (shader), n_children);
+          else
+            result = gsk_gl_shader_node_new (shader, bounds, args, children, n_children);
+        }
+    }
+
+  g_free (children);
+
+out:
+  g_clear_object (&shader);
+  g_clear_pointer (&source, g_bytes_unref);
+  g_clear_pointer (&args, g_bytes_unref);
+
+  return result;
+}
+G_GNUC_END_IGNORE_DEPRECATIONS
+
+static GskRenderNode *
+binary_reader_node_data (BinaryReader      *reader,
+                         GskRenderNodeType  type)
+{
+  graphene_rect_t bounds, rect;
+  graphene_point_t point, point2;
+  GskRoundedRect outline;
+  GskRenderNode *child, *child2;
+  GskColorStop *stops;
+  gsize n_stops;
+  GdkColor color;
+  float f[4];
+
+  switch (type)
+    {
+    case GSK_CONTAINER_NODE:
+      return binary_reader_children_node (reader, type, NULL);
+
+    case GSK_GL_SHADER_NODE:
+      binary_reader_rect (reader, &bounds);
+      return binary_reader_children_node (reader, type, &bounds);
+
+    case GSK_CAIRO_NODE:
+      {
+        GskRenderNode *result;
+        GdkTexture *texture = NULL;
+        cairo_surface_t *surface;
+        cairo_t *cr;
+        guint32 index;
+
+        binary_reader_rect (reader, &bounds);
+        index = binary_reader_u32 (reader);
+        if (index != BINARY_NONE)
+          texture = binary_reader_lookup (reader, reader->textures, index, "texture");
+        if (reader->failed)
+          return NULL;
+
+        result = gsk_cairo_node_new (&bounds);
+        if (texture)
+          {
+            cr = gsk_cairo_node_get_draw_context (result);
+            surface = gdk_texture_download_surface (texture, GDK_COLOR_STATE_SRGB);
+            cairo_set_source_surface (cr, surface, bounds.origin.x, bounds.origin.y);
+            cairo_paint (cr);
+            cairo_destroy (cr);
+            cairo_surface_destroy (surface);
+          }
+
+        return result;
+      }
+
+    case GSK_COLOR_NODE:
+      {
+        GskRenderNode *result;
+
+        binary_reader_rect (reader, &bounds);
+        binary_reader_color (reader, &color);
+        result = reader->failed ? NULL : gsk_color_node_new2 (&color, &bounds);
+        gdk_color_finish (&color);
+
+        return result;
+      }
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        GskRenderNode *result = NULL;
+
+        binary_reader_rect (reader, &bounds);
+        binary_reader_point (reader, &point);
+        binary_reader_point (reader, &point2);
+        stops = binary_reader_stops (reader, &n_stops);
+        if (reader->failed)
+          ;
+        else if (type == GSK_LINEAR_GRADIENT_NODE)
+          result = gsk_linear_gradient_node_new (&bounds, &point, &point2, stops, n_stops);
+        else
+          result = gsk_repeating_linear_gradient_node_new (&bounds, &point, &point2, stops, n_stops);
+        g_free (stops);
+
+        return result;
+      }
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        GskRenderNode *result = NULL;
+
+        binary_reader_rect (reader, &bounds);
+        binary_reader_point (reader, &point);
+        f[0] = binary_reader_strictly_positive_float (reader);
+        f[1] = binary_reader_strictly_positive_float (reader);
+        f[2] = binary_reader_positive_float (reader);
+        f[3] = binary_reader_positive_float (reader);
+        if (!reader->failed && !(f[3] > f[2]))
+          binary_reader_error (reader, "\"start\" must be larger than \"end\"");
+        stops = binary_reader_stops (reader, &n_stops);
+        if (reader->failed)
+          ;
+        else if (type == GSK_RADIAL_GRADIENT_NODE)
+          result = gsk_radial_gradient_node_new (&bounds, &point, f[0], f[1], f[2], f[3], stops, n_stops);
+        else
+          result = gsk_repeating_radial_gradient_node_new (&bounds, &point, f[0], f[1], f[2], f[3], stops, n_stops);
+        g_free (stops);
+
+        return result;
+      }
+
+    case GSK_CONIC_GRADIENT_NODE:
+      {
+        GskRenderNode *result = NULL;
+
+        binary_reader_rect (reader, &bounds);
+        binary_reader_point (reader, &point);
+        f[0] = binary_reader_float (reader);
+        stops = binary_reader_stops (reader, &n_stops);
+        if (!reader->failed)
+          result = gsk_conic_gradient_node_new (&bounds, &point, f[0], stops, n_stops);
+        g_free (stops);
+
+        return result;
+      }
+
+    case GSK_BORDER_NODE:
+      {
+        GskRenderNode *result;
+        GdkColor colors[4];
+        guint i;
+
+        binary_reader_rounded_rect (reader, &outline);
+        binary_reader_floats (reader, f, 4);
+        for (i = 0; i < 4; i++)
+          binary_reader_color (reader, &colors[i]);
+        result = reader->failed ? NULL : gsk_border_node_new2 (&outline, f, colors);
+        for (i = 0; i < 4; i++)
+          gdk_color_finish (&colors[i]);
+
+        return result;
+      }
+
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture;
+
+        binary_reader_rect (reader, &bounds);
+        texture = binary_reader_texture (reader);
+        if (reader->failed)
+          return NULL;
+
+        return gsk_texture_node_new (texture, &bounds);
+      }
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRenderNode *result = NULL;
+
+        binary_reader_rounded_rect (reader, &outline);
+        binary_reader_color (reader, &color);
+        binary_reader_point (reader, &point);
+        f[0] = binary_reader_float (reader);
+        f[1] = binary_reader_positive_float (reader);
+        if (reader->failed)
+          ;
+        else if (type == GSK_INSET_SHADOW_NODE)
+          result = gsk_inset_shadow_node_new2 (&outline, &color, &point, f[0], f[1]);
+        else
+          result = gsk_outset_shadow_node_new2 (&outline, &color, &point, f[0], f[1]);
+        gdk_color_finish (&color);
+
+        return result;
+      }
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskRenderNode *result = NULL;
+        GskTransform *transform;
+
+        transform = binary_reader_transform (reader);
+        child = binary_reader_node (reader);
+        if (!reader->failed)
+          result = gsk_transform_node_new (child, transform);
+        gsk_transform_unref (transform);
+
+        return result;
+      }
+
+    case GSK_OPACITY_NODE:
+      f[0] = binary_reader_float (reader);
+      child = binary_reader_node (reader);
+      if (reader->failed)
+        return NULL;
+
+      return gsk_opacity_node_new (child, f[0]);
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        graphene_matrix_t matrix;
+        graphene_vec4_t offset;
+
+        binary_reader_matrix (reader, &matrix);
+        binary_reader_vec4 (reader, &offset);
+        child = binary_reader_node (reader);
+        if (reader->failed)
+          return NULL;
+
+        return gsk_color_matrix_node_new (child, &matrix, &offset);
+      }
+
+    case GSK_REPEAT_NODE:
+      binary_reader_rect (reader, &bounds);
+      binary_reader_rect (reader, &rect);
+      child = binary_reader_node (reader);
+      if (reader->failed)
+        return NULL;
+
+      return gsk_repeat_node_new (&bounds, child, &rect);
+
+    case GSK_CLIP_NODE:
+      binary_reader_rect (reader, &rect);
+      child = binary_reader_node (reader);
+      if (reader->failed)
+        return NULL;
+
+      return gsk_clip_node_new (child, &rect);
+
+    case GSK_ROUNDED_CLIP_NODE:
+      binary_reader_rounded_rect (reader, &outline);
+      child = binary_reader_node (reader);
+      if (reader->failed)
+        return NULL;
+
+      return gsk_rounded_clip_node_new (child, &outline);
+
+    case GSK_SHADOW_NODE:
+      {
+        GskRenderNode *result = NULL;
+        GskShadow2 *shadows;
+        guint32 i, n_shadows;
+
+        n_shadows = binary_reader_u32 (reader);
+        if (!binary_reader_has (reader, n_shadows, 8 * sizeof (guint32)))
+          return NULL;
+
+        if (n_shadows == 0)
+          {
+            binary_reader_error (reader, "Shadow nodes need at least one shadow");
+            return NULL;
+          }
+
+        shadows = g_new (GskShadow2, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            binary_reader_color (reader, &shadows[i].color);
+            binary_reader_point (reader, &shadows[i].offset);
+            shadows[i].radius = binary_reader_positive_float (reader);
+          }
+        child = binary_reader_node (reader);
+        if (!reader->failed)
+          result = gsk_shadow_node_new2 (child, shadows, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          gdk_color_finish (&shadows[i].color);
+        g_free (shadows);
+
+        return result;
+      }
+
+    case GSK_BLEND_NODE:
+      {
+        GskBlendMode mode;
+
+        mode = binary_reader_enum (reader, GSK_BLEND_MODE_LUMINOSITY);
+        child = binary_reader_node (reader);
+        child2 = binary_reader_node (reader);
+        if (reader->failed)
+          return NULL;
+
+        return gsk_blend_node_new (child, child2, mode);
+      }
+
+    case GSK_CROSS_FADE_NODE:
+      f[0] = binary_reader_float (reader);
+      child = binary_reader_node (reader);
+      child2 = binary_reader_node (reader);
+      if (reader->failed)
+        return NULL;
+
+      return gsk_cross_fade_node_new (child, child2, f[0]);
+
+    case GSK_TEXT_NODE:
+      {
+        GskRenderNode *result = NULL;
+        PangoFont *font;
+        PangoGlyphString *glyphs;
+
+        font = binary_reader_font (reader);
+        glyphs = binary_reader_glyphs (reader);
+        binary_reader_color (reader, &color);
+        binary_reader_point (reader, &point);
+        if (!reader->failed)
+          {
+            result = gsk_text_node_new2 (font, glyphs, &color, &point);
+            /* The font may not have the glyphs on this system */
+            if (result == NULL)
+              result = gsk_container_node_new (NULL, 0);
+          }
+        gdk_color_finish (&color);
+
+        return result;
+      }
+
+    case GSK_BLUR_NODE:
+      f[0] = binary_reader_positive_float (reader);
+      child = binary_reader_node (reader);
+      if (reader->failed)
+        return NULL;
+
+      return gsk_blur_node_new (child, f[0]);
+
+    case GSK_DEBUG_NODE:
+      {
+        char *message;
+
+        message = binary_reader_string (reader);
+        child = binary_reader_node (reader);
+        if (reader->failed)
+          {
+            g_free (message);
+            return NULL;
+          }
+
+        return gsk_debug_node_new (child, message);
+      }
+
+    case GSK_TEXTURE_SCALE_NODE:
+      {
+        GskScalingFilter filter;
+        GdkTexture *texture;
+
+        binary_reader_rect (reader, &bounds);
+        filter = binary_reader_enum (reader, GSK_SCALING_FILTER_TRILINEAR);
+        texture = binary_reader_texture (reader);
+        if (reader->failed)
+          return NULL;
+
+        return gsk_texture_scale_node_new (texture, &bounds, filter);
+      }
+
+    case GSK_MASK_NODE:
+      {
+        GskMaskMode mode;
+
+        mode = binary_reader_enum (reader, GSK_MASK_MODE_INVERTED_LUMINANCE);
+        child = binary_reader_node (reader);
+        child2 = binary_reader_node (reader);
+        if (reader->failed)
+          return NULL;
+
+        return gsk_mask_node_new (child, child2, mode);
+      }
+
+    case GSK_FILL_NODE:
+      {
+        GskRenderNode *result = NULL;
+        GskFillRule fill_rule;
+        GskPath *path;
+
+        path = binary_reader_path (reader);
+        fill_rule = binary_reader_enum (reader, GSK_FILL_RULE_EVEN_ODD);
+        child = binary_reader_node (reader);
+        if (!reader->failed)
+          result = gsk_fill_node_new (child, path, fill_rule);
+        gsk_path_unref (path);
+
+        return result;
+      }
+
+    case GSK_STROKE_NODE:
+      {
+        GskRenderNode *result = NULL;
+        GskStroke *stroke;
+        GskPath *path;
+        GskLineCap line_cap;
+        GskLineJoin line_join;
+        float *dash = NULL;
+        guint32 i, n_dash;
+
+        path = binary_reader_path (reader);
+        f[0] = binary_reader_strictly_positive_float (reader);
+        line_cap = binary_reader_enum (reader, GSK_LINE_CAP_SQUARE);
+        line_join = binary_reader_enum (reader, GSK_LINE_JOIN_BEVEL);
+        f[1] = binary_reader_positive_float (reader);
+        n_dash = binary_reader_u32 (reader);
+        if (binary_reader_has (reader, n_dash, sizeof (float)))
+          {
+            dash = g_new (float, n_dash);
+            for (i = 0; i < n_dash; i++)
+              dash[i] = binary_reader_positive_float (reader);
+          }
+        f[2] = binary_reader_float (reader);
+        child = binary_reader_node (reader);
+        if (!reader->failed)
+          {
+            stroke = gsk_stroke_new (f[0]);
+            gsk_stroke_set_line_cap (stroke, line_cap);
+            gsk_stroke_set_line_join (stroke, line_join);
+            gsk_stroke_set_miter_limit (stroke, f[1]);
+            gsk_stroke_set_dash (stroke, dash, n_dash);
+            gsk_stroke_set_dash_offset (stroke, f[2]);
+            result = gsk_stroke_node_new (child, path, stroke);
+            gsk_stroke_free (stroke);
+          }
+        g_free (dash);
+        gsk_path_unref (path);
+
+        return result;
+      }
+
+    case GSK_SUBSURFACE_NODE:
+      child = binary_reader_node (reader);
+      if (reader->failed)
+        return NULL;
+
+      return gsk_subsurface_node_new (child, NULL);
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      binary_reader_error (reader, "Unknown node type %u", type);
+      return NULL;
+    }
+}
+
+static void
+binary_reader_node_record (BinaryReader *reader)
+{
+  GskRenderNodeType type;
+  GskRenderNode *node;
+  guint32 size;
+  gsize end;
+
+  type = binary_reader_u32 (reader);
+  size = binary_reader_u32 (reader);
+  if (!binary_reader_has (reader, size, 1))
+    return;
+
+  end = reader->pos + size;
+  node = binary_reader_node_data (reader, type);
+
+  if (node != NULL && reader->pos != end)
+    binary_reader_error (reader, "Invalid size for %s node", g_type_name_from_instance ((GTypeInstance *) node));
+  else if (node == NULL)
+    binary_reader_error (reader, "Invalid node data");
+
+  if (reader->failed)
+    {
+      g_clear_pointer (&node, gsk_render_node_unref);
+      return;
+    }
+
+  g_ptr_array_add (reader->nodes, node);
+}
+
+static void
+binary_reader_frame_record (BinaryReader *reader)
+{
+  GskRenderTraceFrame frame;
+  GskRenderNode *node;
+  guint32 i, n_rects;
+
+  node = binary_reader_node (reader);
+  frame.width = binary_reader_u32 (reader);
+  frame.height = binary_reader_u32 (reader);
+  frame.time = binary_reader_u64 (reader);
+  frame.duration = binary_reader_u64 (reader);
+  n_rects = binary_reader_u32 (reader);
+  if (node == NULL || reader->failed ||
+      !binary_reader_has (reader, n_rects, 4 * sizeof (guint32)))
+    return;
+
+  frame.region = cairo_region_create ();
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      rect.x = (gint32) binary_reader_u32 (reader);
+      rect.y = (gint32) binary_reader_u32 (reader);
+      rect.width = (gint32) binary_reader_u32 (reader);
+      rect.height = (gint32) binary_reader_u32 (reader);
+      cairo_region_union_rectangle (frame.region, &rect);
+    }
+
+  frame.node = gsk_render_node_ref (node);
+
+  g_array_append_val (reader->frames, frame);
+}
+
+static void
+gsk_render_trace_frame_clear (gpointer data)
+{
+  GskRenderTraceFrame *frame = data;
+
+  gsk_render_node_unref (frame->node);
+  cairo_region_destroy (frame->region);
+}
+
+/*< private >
+ * gsk_render_node_bytes_are_binary:
+ * @bytes: the bytes to check
+ *
+ * Checks if @bytes start like data written by
+ * gsk_render_node_serialize_binary() or a trace.
+ *
+ * Returns: %TRUE if @bytes use the binary format
+ */
+gboolean
+gsk_render_node_bytes_are_binary (GBytes *bytes)
+{
+  return g_bytes_get_size (bytes) >= sizeof (binary_magic) &&
+         memcmp (g_bytes_get_data (bytes, NULL), binary_magic, sizeof (binary_magic)) == 0;
+}
+
+static GskRenderNode *
+binary_reader_run (GBytes            *bytes,
+                   GskParseErrorFunc  error_func,
+                   gpointer           user_data,
+                   GArray            *frames)
+{
+  BinaryReader reader;
+  GskRenderNode *root = NULL;
+  const guchar *magic;
+  guint32 version, flags;
+
+  memset (&reader, 0, sizeof (BinaryReader));
+  reader.bytes = bytes;
+  reader.data = g_bytes_get_data (bytes, &reader.size);
+  reader.error_func = error_func;
+  reader.user_data = user_data;
+  reader.frames = frames;
+  context_init (&reader.context);
+  reader.nodes = g_ptr_array_new_with_free_func ((GDestroyNotify) gsk_render_node_unref);
+  reader.textures = g_ptr_array_new_with_free_func (g_object_unref);
+  reader.color_states = g_ptr_array_new_with_free_func ((GDestroyNotify) gdk_color_state_unref);
+  reader.fonts = g_ptr_array_new_with_free_func (g_object_unref);
+  reader.glyphs = g_ptr_array_new_with_free_func ((GDestroyNotify) pango_glyph_string_free);
+
+  magic = binary_reader_take (&reader, sizeof (binary_magic));
+  if (magic != NULL && memcmp (magic, binary_magic, sizeof (binary_magic)) != 0)
+    binary_reader_error (&reader, "Not in the binary render node format");
+  version = binary_reader_u32 (&reader);
+  flags = binary_reader_u32 (&reader);
+  if (!reader.failed && version != BINARY_VERSION)
+    binary_reader_error (&reader, "Unsupported version %u", version);
+
+  if (reader.frames == NULL && (flags & BINARY_FLAG_TRACE))
+    reader.frames = g_array_new (FALSE, FALSE, sizeof (GskRenderTraceFrame));
+
+  while (!reader.failed && root == NULL)
+    {
+      /* Traces have no end record, they just stop */
+      if ((flags & BINARY_FLAG_TRACE) && reader.pos == reader.size)
+        break;
+
+      switch (binary_reader_u32 (&reader))
+        {
+        case BINARY_RECORD_END:
+          root = binary_reader_node (&reader);
+          if (root)
+            gsk_render_node_ref (root);
+          else
+            binary_reader_error (&reader, "No root node");
+          break;
+
+        case BINARY_RECORD_COLOR_STATE:
+          binary_reader_color_state_record (&reader);
+          break;
+
+        case BINARY_RECORD_TEXTURE:
+          binary_reader_texture_record (&reader);
+          break;
+
+        case BINARY_RECORD_FONT_FILE:
+          binary_reader_font_file_record (&reader);
+          break;
+
+        case BINARY_RECORD_FONT:
+          binary_reader_font_record (&reader);
+          break;
+
+        case BINARY_RECORD_GLYPHS:
+          binary_reader_glyphs_record (&reader);
+          break;
+
+        case BINARY_RECORD_NODE:
+          binary_reader_node_record (&reader);
+          break;
+
+        case BINARY_RECORD_FRAME:
+          if (reader.frames)
+            binary_reader_frame_record (&reader);
+          else
+            binary_reader_error (&reader, "Unexpected frame");
+          break;
+
+        default:
+          binary_reader_error (&reader, "Unknown record type");
+          break;
+        }
+    }
+
+  /* When loading a trace as a single node, use the last frame */
+  if (reader.frames && reader.frames != frames)
+    {
+      if (reader.frames->len > 0)
+        root = gsk_render_node_ref (g_array_index (reader.frames, GskRenderTraceFrame, reader.frames->len - 1).node);
+      g_array_set_clear_func (reader.frames, gsk_render_trace_frame_clear);
+      g_array_unref (reader.frames);
+    }
+
+  g_ptr_array_unref (reader.nodes);
+  g_ptr_array_unref (reader.textures);
+  g_ptr_array_unref (reader.color_states);
+  g_ptr_array_unref (reader.fonts);
+  g_ptr_array_unref (reader.glyphs);
+  context_finish (&reader.context);
+
+  return root;
+}
+
+/*< private >
+ * gsk_render_node_deserialize_binary:
+ * @bytes: the bytes containing the data
+ * @error_func: (nullable) (scope call): Callback on parsing errors
+ * @user_data: user_data for @error_func
+ *
+ * Loads data created via gsk_render_node_serialize_binary().
+ *
+ * Unlike the text format, this format is meant for GTK's own tools
+ * and is not accepted by gsk_render_node_deserialize(). It is only
+ * checked to be well-formed, so only load data from trusted sources.
+ *
+ * If @bytes contain a trace, the node of the last frame is returned.
+ *
+ * Returns: (nullable) (transfer full): a new `GskRenderNode`
+ */
+GskRenderNode *
+gsk_render_node_deserialize_binary (GBytes            *bytes,
+                                    GskParseErrorFunc  error_func,
+                                    gpointer           user_data)
+{
+  return binary_reader_run (bytes, error_func, user_data, NULL);
+}
+
+/*< private >
+ * gsk_render_node_deserialize_trace:
+ * @bytes: the bytes containing the trace
+ * @error_func: (nullable) (scope call): Callback on parsing errors
+ * @user_data: user_data for @error_func
+ *
+ * Loads a trace written by a `GskRenderTraceWriter`.
+ *
+ * If the trace is truncated, the frames before the error are returned.
+ *
+ * Returns: (nullable) (transfer full): an array of `GskRenderTraceFrame`,
+ *   or %NULL if @bytes don't contain a trace
+ */
+GArray *
+gsk_render_node_deserialize_trace (GBytes            *bytes,
+                                   GskParseErrorFunc  error_func,
+                                   gpointer           user_data)
+{
+  GskRenderNode *root;
+  GArray *frames;
+  guint32 flags;
+
+  if (!gsk_render_node_bytes_are_binary (bytes) ||
+      g_bytes_get_size (bytes) < sizeof (binary_magic) + 2 * sizeof (guint32))
+    return NULL;
+
+  memcpy (&flags, (const guchar *) g_bytes_get_data (bytes, NULL) + sizeof (binary_magic) + sizeof (guint32), sizeof (flags));
+  if ((GUINT32_FROM_LE (flags) & BINARY_FLAG_TRACE) == 0)
+    return NULL;
+
+  frames = g_array_new (FALSE, FALSE, sizeof (GskRenderTraceFrame));
+  g_array_set_clear_func (frames, gsk_render_trace_frame_clear);
+
+  /* Traces have no end record, but don't leak the root
+   * node if the data contains one anyway
+   */
+  root = binary_reader_run (bytes, error_func, user_data, frames);
+  g_clear_pointer (&root, gsk_render_node_unref);
+
+  return frames;
+}
@@ -6,3 +6,48 @@
 GskRenderNode * gsk_render_node_deserialize_from_bytes  (GBytes            *bytes,
                                                          GskParseErrorFunc  error_func,
                                                          gpointer           user_data);
+
+GBytes *        gsk_render_node_serialize_binary        (GskRenderNode     *node);
+/* Exported for gtk4-rendernode-tool */
+GDK_AVAILABLE_IN_ALL
+gboolean        gsk_render_node_bytes_are_binary        (GBytes            *bytes);
+GDK_AVAILABLE_IN_ALL
+GskRenderNode * gsk_render_node_deserialize_binary      (GBytes            *bytes,
+                                                         GskParseErrorFunc  error_func,
+                                                         gpointer           user_data);
+/* Exported for gtk4-rendernode-tool */
+GDK_AVAILABLE_IN_ALL
+gboolean        gsk_render_node_write_binary            (GskRenderNode     *node,
+                                                         GOutputStream     *stream,
+                                                         GCancellable      *cancellable,
+                                                         GError           **error);
+
+typedef struct _GskRenderTraceFrame GskRenderTraceFrame;
+
+struct _GskRenderTraceFrame
+{
+  GskRenderNode *node;
+  cairo_region_t *region;
+  int width;
+  int height;
+  gint64 time;
+  gint64 duration;
+};
+
+GDK_AVAILABLE_IN_ALL
+GArray *        gsk_render_node_deserialize_trace       (GBytes            *bytes,
+                                                         GskParseErrorFunc  error_func,
+                                                         gpointer           user_data);
+
+typedef struct _GskRenderTraceWriter GskRenderTraceWriter;
+
+GskRenderTraceWriter *
+                gsk_render_trace_writer_new             (GOutputStream        *stream);
+gboolean        gsk_render_trace_writer_add_frame       (GskRenderTraceWriter *self,
+                                                         GskRenderNode        *node,
+                                                         const cairo_region_t *region,
+                                                         int                   width,
+                                                         int                   height,
+                                                         gint64                time,
+                                                         gint64                duration);
+void            gsk_render_trace_writer_free            (GskRenderTraceWriter *self);
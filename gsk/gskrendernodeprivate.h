@@ -33,6 +33,8 @@ struct _GskRenderNode
 
   graphene_rect_t bounds;
 
+  guint hash; /* 0 if not computed yet */
+
   guint preferred_depth : GDK_MEMORY_DEPTH_BITS;
   guint offscreen_for_opacity : 1;
   guint fully_opaque : 1;
@@ -60,6 +62,9 @@ struct _GskRenderNodeClass
   void          (* diff)                                (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          GskDiffData                 *data);
+  guint         (* hash)                                (GskRenderNode               *node);
+  gboolean      (* equal)                               (GskRenderNode               *node1,
+                                                         GskRenderNode               *node2);
   gboolean      (* get_opaque_rect)                     (GskRenderNode               *node,
                                                          graphene_rect_t             *out_opaque);
 };
@@ -79,6 +84,9 @@ gboolean        gsk_render_node_can_diff                (const GskRenderNode
 void            gsk_render_node_diff                    (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          GskDiffData                 *data);
+guint           gsk_render_node_get_hash                (GskRenderNode               *node);
+gboolean        gsk_render_node_equal                   (GskRenderNode               *node1,
+                                                         GskRenderNode               *node2);
 void            gsk_render_node_diff_impossible         (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          GskDiffData                 *data);
@@ -103,6 +111,18 @@ void            gsk_text_node_serialize_glyphs          (GskRenderNode
 cairo_hint_style_t
                 gsk_text_node_get_font_hint_style       (const GskRenderNode         *self) G_GNUC_PURE;
 
+typedef struct _GskCairoTextureCache GskCairoTextureCache;
+
+GskCairoTextureCache *
+                gsk_cairo_texture_cache_new             (GdkColorState               *ccs);
+void            gsk_cairo_texture_cache_free            (GskCairoTextureCache        *cache);
+void            gsk_cairo_texture_cache_add             (GskCairoTextureCache        *cache,
+                                                         GdkTexture                  *texture);
+void            gsk_cairo_texture_cache_attach          (GskCairoTextureCache        *cache,
+                                                         cairo_surface_t             *target);
+
+GskRenderNode * gsk_container_node_new_take             (GskRenderNode              **children,
+                                                         guint                        n_children);
 GskRenderNode ** gsk_container_node_get_children        (const GskRenderNode         *node,
                                                          guint                       *n_children);
 
@@ -113,6 +133,10 @@ GdkMemoryDepth  gsk_render_node_get_preferred_depth     (const GskRenderNode
 gboolean        gsk_render_node_is_hdr                  (const GskRenderNode         *node) G_GNUC_PURE;
 
 gboolean        gsk_container_node_is_disjoint          (const GskRenderNode         *node) G_GNUC_PURE;
+guint           gsk_container_node_get_next_child_in_rect
+                                                        (const GskRenderNode         *node,
+                                                         guint                        start,
+                                                         const graphene_rect_t       *rect) G_GNUC_PURE;
 
 gboolean        gsk_render_node_use_offscreen_for_opacity (const GskRenderNode       *node) G_GNUC_PURE;
 
@@ -22,6 +22,7 @@
 
 #include "gdk/gdktextureprivate.h"
 #include "gdk/loaders/gdkpngprivate.h"
+#include "gdk/loaders/gdkjpegprivate.h"
 
 /* {{{ Pixbuf helpers */
 
@@ -254,46 +255,29 @@ load_symbolic_svg (const char     *escaped_file_data,
 }
 
 static gboolean
-extract_plane (GdkPixbuf *src,
-               GdkPixbuf *dst,
-               int        from_plane,
-               int        to_plane)
+pixbuf_has_color (GdkPixbuf *pixbuf)
 {
-  guchar *src_data, *dst_data;
+  const guchar *data;
   int width, height;
-  gsize src_stride, dst_stride;
-  guchar *src_row, *dst_row;
-  int x, y;
-  gboolean all_clear = TRUE;
-
-  width = gdk_pixbuf_get_width (src);
-  height = gdk_pixbuf_get_height (src);
-
-  g_assert (width <= gdk_pixbuf_get_width (dst));
-  g_assert (height <= gdk_pixbuf_get_height (dst));
-
-  src_stride = gdk_pixbuf_get_rowstride (src);
-  src_data = gdk_pixbuf_get_pixels (src);
+  gsize stride;
 
-  dst_data = gdk_pixbuf_get_pixels (dst);
-  dst_stride = gdk_pixbuf_get_rowstride (dst);
+  data = gdk_pixbuf_read_pixels (pixbuf);
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  stride = gdk_pixbuf_get_rowstride (pixbuf);
 
-  for (y = 0; y < height; y++)
+  for (int y = 0; y < height; y++)
     {
-      src_row = src_data + src_stride * y;
-      dst_row = dst_data + dst_stride * y;
-      for (x = 0; x < width; x++)
+      const guchar *row = data + stride * y;
+      for (int x = 0; x < width; x++)
         {
-          if (src_row[from_plane] != 0)
-            all_clear = FALSE;
-
-          dst_row[to_plane] = src_row[from_plane];
-          src_row += 4;
-          dst_row += 4;
+          if (row[0] != 0 || row[1] != 0 || row[2] != 0)
+            return TRUE;
+          row += 4;
         }
     }
 
-  return all_clear;
+  return FALSE;
 }
 
 static void
@@ -399,8 +383,10 @@ gtk_make_symbolic_pixbuf_from_data (const char  *file_data,
                                     GError     **error)
 
 {
-  const char *r_string = "rgb(255,0,0)";
-  const char *g_string = "rgb(0,255,0)";
+  const char *fg_string = "rgb(0,0,0)";
+  const char *success_string = "rgb(255,0,0)";
+  const char *warning_string = "rgb(0,255,0)";
+  const char *error_string = "rgb(0,0,255)";
   char *icon_width_str = NULL;
   char *icon_height_str = NULL;
   char *escaped_file_data = NULL;
@@ -437,58 +423,38 @@ gtk_make_symbolic_pixbuf_from_data (const char  *file_data,
   escaped_file_data = g_base64_encode ((guchar *) file_data, file_len);
   len = strlen (escaped_file_data);
 
-  for (int plane = 0; plane < 3; plane++)
-    {
-      GdkPixbuf *loaded;
-
-      /* Here we render the svg with all colors solid, this should
-       * always make the alpha channel the same and it should match
-       * the final alpha channel for all possible renderings. We
-       * Just use it as-is for final alpha.
-       *
-       * For the 3 non-fg colors, we render once each with that
-       * color as red, and every other color as green. The resulting
-       * red will describe the amount of that color is in the
-       * opaque part of the color. We store these as the rgb
-       * channels, with the color of the fg being implicitly
-       * the "rest", as all color fractions should add up to 1.
-       */
-      loaded = load_symbolic_svg (escaped_file_data, len, width, height,
-                                  icon_width_str,
-                                  icon_height_str,
-                                  g_string,
-                                  plane == 0 ? r_string : g_string,
-                                  plane == 1 ? r_string : g_string,
-                                  plane == 2 ? r_string : g_string,
-                                  error);
-      if (loaded == NULL)
-        goto out;
-
-      if (debug_output_basename)
-        {
-          char *filename;
-
-          filename = g_strdup_printf ("%s.debug%d.png", debug_output_basename, plane);
-          g_print ("Writing %s\n", filename);
-          gdk_pixbuf_save (loaded, filename, "png", NULL, NULL);
-          g_free (filename);
-        }
-
-      if (plane == 0)
-        {
-          pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8,
-                                   gdk_pixbuf_get_width (loaded),
-                                   gdk_pixbuf_get_height (loaded));
-          memset (gdk_pixbuf_get_pixels (pixbuf), 0, gdk_pixbuf_get_byte_length (pixbuf));
-
-          extract_plane (loaded, pixbuf, 3, 3);
-        }
+  /* We render the svg once, with the foreground in black and each
+   * of the 3 other colors in its own channel. Since the colors are
+   * orthogonal, after blending, each channel describes the amount of
+   * its color in the opaque part of the pixel, which is what we
+   * want to store: success in red, warning in green and error in
+   * blue, with the fg being implicitly the "rest", as all color
+   * fractions add up to 1. The alpha channel is used as-is for
+   * the final alpha.
+   */
+  pixbuf = load_symbolic_svg (escaped_file_data, len, width, height,
+                              icon_width_str,
+                              icon_height_str,
+                              fg_string,
+                              success_string,
+                              warning_string,
+                              error_string,
+                              error);
+  if (pixbuf == NULL)
+    goto out;
 
-      only_fg &= extract_plane (loaded, pixbuf, 0, plane);
+  if (debug_output_basename)
+    {
+      char *filename;
 
-      g_object_unref (loaded);
+      filename = g_strdup_printf ("%s.debug.png", debug_output_basename);
+      g_print ("Writing %s\n", filename);
+      gdk_pixbuf_save (pixbuf, filename, "png", NULL, NULL);
+      g_free (filename);
     }
 
+  only_fg = !pixbuf_has_color (pixbuf);
+
 out:
   if (only_fg && pixbuf)
     gdk_pixbuf_set_option (pixbuf, "tEXt::only-foreground", "true");
@@ -643,6 +609,48 @@ gdk_texture_new_from_stream_with_fg (GInputStream  *stream,
   return texture;
 }
 
+/* Like gdk_texture_new_from_stream_with_fg(), but the texture is
+ * only going to be shown at up to @width x @height, so formats that
+ * support it are decoded at a reduced size. The resulting texture
+ * can still be larger than requested.
+ */
+GdkTexture *
+gdk_texture_new_from_stream_at_size_with_fg (GInputStream  *stream,
+                                             int            width,
+                                             int            height,
+                                             gboolean      *only_fg,
+                                             GCancellable  *cancellable,
+                                             GError       **error)
+{
+  GOutputStream *output;
+  GBytes *bytes;
+  GdkTexture *texture;
+
+  output = g_memory_output_stream_new_resizable ();
+  if (g_output_stream_splice (output, stream,
+                              G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                              cancellable, error) < 0)
+    {
+      g_object_unref (output);
+      return NULL;
+    }
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+  g_object_unref (output);
+
+  if (gdk_is_jpeg (bytes))
+    {
+      *only_fg = FALSE;
+      texture = gdk_load_jpeg_at_size (bytes, width, height, error);
+    }
+  else
+    texture = texture_new_from_bytes (bytes, only_fg, error);
+
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
 GdkTexture *
 gdk_texture_new_from_stream_at_scale (GInputStream  *stream,
                                       int            width,
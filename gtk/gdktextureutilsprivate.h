@@ -38,6 +38,13 @@ GdkTexture *gdk_texture_new_from_stream_with_fg     (GInputStream  *stream,
                                                      gboolean      *only_fg,
                                                      GCancellable  *cancellable,
                                                      GError       **error);
+GdkTexture *gdk_texture_new_from_stream_at_size_with_fg
+                                                    (GInputStream  *stream,
+                                                     int            width,
+                                                     int            height,
+                                                     gboolean      *only_fg,
+                                                     GCancellable  *cancellable,
+                                                     GError       **error);
 GdkTexture *gdk_texture_new_from_stream_at_scale    (GInputStream  *stream,
                                                      int            width,
                                                      int            height,
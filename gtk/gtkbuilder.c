@@ -1574,6 +1574,149 @@ gtk_builder_extend_with_template (GtkBuilder   *builder,
   return TRUE;
 }
 
+/* UI resources that get loaded over and over (dialogs, list rows,
+ * popovers) are converted to the precompiled format once they have
+ * been parsed successfully a few times, so later loads skip the XML
+ * tokenizer. The resource contents are kept to notice when a resource
+ * gets replaced. Only the most recently used resources are kept.
+ */
+#define RESOURCE_PRECOMPILE_THRESHOLD 2
+#define RESOURCE_CACHE_SIZE 64
+
+typedef struct {
+  char *path;
+  GBytes *source;
+  GBytes *precompiled;
+  guint n_loads;
+  gboolean failed;
+  GList link;
+} ResourceCacheEntry;
+
+static GHashTable *resource_cache;
+static GQueue resource_cache_lru = G_QUEUE_INIT;
+G_LOCK_DEFINE_STATIC (resource_cache);
+
+static void
+resource_cache_entry_free (gpointer data)
+{
+  ResourceCacheEntry *entry = data;
+
+  g_queue_unlink (&resource_cache_lru, &entry->link);
+  g_free (entry->path);
+  g_bytes_unref (entry->source);
+  g_clear_pointer (&entry->precompiled, g_bytes_unref);
+  g_free (entry);
+}
+
+/* Resources are usually mapped, so the data of an unchanged
+ * resource is at the same place every time it is looked up
+ */
+static gboolean
+resource_cache_entry_matches (ResourceCacheEntry *entry,
+                              GBytes             *data)
+{
+  gsize size1, size2;
+  gconstpointer data1, data2;
+
+  if (entry->source == data)
+    return TRUE;
+
+  data1 = g_bytes_get_data (entry->source, &size1);
+  data2 = g_bytes_get_data (data, &size2);
+
+  if (size1 != size2)
+    return FALSE;
+
+  return data1 == data2 || memcmp (data1, data2, size1) == 0;
+}
+
+static GBytes *
+gtk_builder_lookup_resource (const char  *resource_path,
+                             gboolean    *is_cached,
+                             GError     **error)
+{
+  ResourceCacheEntry *entry;
+  GBytes *data;
+
+  *is_cached = FALSE;
+
+  data = g_resources_lookup_data (resource_path, 0, error);
+  if (data == NULL)
+    return NULL;
+
+  G_LOCK (resource_cache);
+
+  if (resource_cache != NULL &&
+      (entry = g_hash_table_lookup (resource_cache, resource_path)) != NULL &&
+      entry->precompiled != NULL &&
+      resource_cache_entry_matches (entry, data))
+    {
+      g_queue_unlink (&resource_cache_lru, &entry->link);
+      g_queue_push_head_link (&resource_cache_lru, &entry->link);
+
+      g_bytes_unref (data);
+      data = g_bytes_ref (entry->precompiled);
+      *is_cached = TRUE;
+    }
+
+  G_UNLOCK (resource_cache);
+
+  return data;
+}
+
+static void
+gtk_builder_resource_parsed (const char *resource_path,
+                             GBytes     *data)
+{
+  ResourceCacheEntry *entry;
+
+  if (_gtk_buildable_parser_is_precompiled (g_bytes_get_data (data, NULL), g_bytes_get_size (data)))
+    return;
+
+  G_LOCK (resource_cache);
+
+  if (resource_cache == NULL)
+    resource_cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, resource_cache_entry_free);
+
+  entry = g_hash_table_lookup (resource_cache, resource_path);
+  if (entry == NULL || !resource_cache_entry_matches (entry, data))
+    {
+      if (entry != NULL)
+        g_hash_table_remove (resource_cache, resource_path);
+      else if (g_hash_table_size (resource_cache) >= RESOURCE_CACHE_SIZE)
+        {
+          ResourceCacheEntry *oldest = g_queue_peek_tail (&resource_cache_lru);
+          g_hash_table_remove (resource_cache, oldest->path);
+        }
+
+      entry = g_new0 (ResourceCacheEntry, 1);
+      entry->path = g_strdup (resource_path);
+      entry->source = g_bytes_ref (data);
+      entry->link.data = entry;
+      g_hash_table_insert (resource_cache, entry->path, entry);
+    }
+  else
+    {
+      g_queue_unlink (&resource_cache_lru, &entry->link);
+    }
+
+  g_queue_push_head_link (&resource_cache_lru, &entry->link);
+
+  entry->n_loads++;
+
+  /* Don't try again if the data could not be precompiled */
+  if (entry->precompiled == NULL && !entry->failed &&
+      entry->n_loads >= RESOURCE_PRECOMPILE_THRESHOLD)
+    {
+      entry->precompiled = _gtk_buildable_parser_precompile (g_bytes_get_data (data, NULL),
+                                                             g_bytes_get_size (data),
+                                                             NULL);
+      entry->failed = entry->precompiled == NULL;
+    }
+
+  G_UNLOCK (resource_cache);
+}
+
 /**
  * gtk_builder_add_from_resource:
  * @builder: a `GtkBuilder`
@@ -1608,6 +1751,7 @@ gtk_builder_add_from_resource (GtkBuilder   *builder,
   GBytes *data;
   char *filename_for_errors;
   char *slash;
+  gboolean is_cached;
 
   g_return_val_if_fail (GTK_IS_BUILDER (builder), 0);
   g_return_val_if_fail (resource_path != NULL, 0);
@@ -1615,7 +1759,7 @@ gtk_builder_add_from_resource (GtkBuilder   *builder,
 
   tmp_error = NULL;
 
-  data = g_resources_lookup_data (resource_path, 0, &tmp_error);
+  data = gtk_builder_lookup_resource (resource_path, &is_cached, &tmp_error);
   if (data == NULL)
     {
       g_propagate_error (error, tmp_error);
@@ -1639,6 +1783,9 @@ gtk_builder_add_from_resource (GtkBuilder   *builder,
                                     NULL,
                                     &tmp_error);
 
+  if (tmp_error == NULL && !is_cached)
+    gtk_builder_resource_parsed (resource_path, data);
+
   g_free (filename_for_errors);
   g_bytes_unref (data);
 
@@ -1683,6 +1830,7 @@ gtk_builder_add_objects_from_resource (GtkBuilder   *builder,
   GBytes *data;
   char *filename_for_errors;
   char *slash;
+  gboolean is_cached;
 
   g_return_val_if_fail (GTK_IS_BUILDER (builder), 0);
   g_return_val_if_fail (resource_path != NULL, 0);
@@ -1691,7 +1839,7 @@ gtk_builder_add_objects_from_resource (GtkBuilder   *builder,
 
   tmp_error = NULL;
 
-  data = g_resources_lookup_data (resource_path, 0, &tmp_error);
+  data = gtk_builder_lookup_resource (resource_path, &is_cached, &tmp_error);
   if (data == NULL)
     {
       g_propagate_error (error, tmp_error);
@@ -1714,6 +1862,10 @@ gtk_builder_add_objects_from_resource (GtkBuilder   *builder,
                                     g_bytes_get_data (data, NULL), g_bytes_get_size (data),
                                     object_ids,
                                     &tmp_error);
+
+  if (tmp_error == NULL && !is_cached)
+    gtk_builder_resource_parsed (resource_path, data);
+
   g_free (filename_for_errors);
   g_bytes_unref (data);
 
@@ -186,6 +186,10 @@ gtk_builder_list_item_factory_set_bytes (GtkBuilderListItemFactory *self,
           self->data = data;
         }
     }
+  else
+    {
+      self->data = g_bytes_ref (bytes);
+    }
 
   return TRUE;
 }
@@ -22,8 +22,11 @@
 #include "gtkadjustmentprivate.h"
 #include "gtkbox.h"
 #include "gtkbutton.h"
+#include "gtkcssnumbervalueprivate.h"
 #include "gtkentry.h"
 #include "gtkflowboxprivate.h"
+#include "gtkiconhelperprivate.h"
+#include "gtkiconthemeprivate.h"
 #include "gtkstack.h"
 #include "gtklabel.h"
 #include "gtkgesturelongpress.h"
@@ -1060,6 +1063,45 @@ gtk_emoji_chooser_init (GtkEmojiChooser *chooser)
   gdk_source_set_static_name_by_id (chooser->populate_idle, "[gtk] populate_emoji_chooser");
 }
 
+/* Load the section icons in parallel, before the first
+ * frame needs them. The buttons look them up like their
+ * images will, so they find the textures loaded.
+ */
+static void
+preload_section_icons (GtkEmojiChooser *chooser)
+{
+  EmojiSection *sections[] = {
+    &chooser->recent, &chooser->people, &chooser->body, &chooser->nature,
+    &chooser->food, &chooser->travel, &chooser->activities, &chooser->objects,
+    &chooser->symbols, &chooser->flags,
+  };
+  GIcon *icons[G_N_ELEMENTS (sections) + 1];
+  GtkWidget *image;
+  GtkCssStyle *style;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (sections); i++)
+    icons[i] = g_themed_icon_new (gtk_button_get_icon_name (GTK_BUTTON (sections[i]->button)));
+  icons[i] = NULL;
+
+  /* All section buttons are styled alike */
+  image = gtk_button_get_child (GTK_BUTTON (chooser->recent.button));
+  style = gtk_css_node_get_style (gtk_widget_get_css_node (image));
+
+  gtk_icon_theme_preload_icons_async (gtk_icon_theme_get_for_display (gtk_widget_get_display (image)),
+                                      icons,
+                                      gtk_css_number_value_get (style->icon->icon_size, 100),
+                                      gtk_widget_get_scale_factor (image),
+                                      gtk_widget_get_direction (image),
+                                      gtk_icon_helper_get_lookup_flags (style),
+                                      NULL,
+                                      NULL,
+                                      NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (sections); i++)
+    g_object_unref (icons[i]);
+}
+
 static void
 gtk_emoji_chooser_show (GtkWidget *widget)
 {
@@ -1068,6 +1110,8 @@ gtk_emoji_chooser_show (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_emoji_chooser_parent_class)->show (widget);
 
+  preload_section_icons (chooser);
+
   adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
   gtk_adjustment_set_value (adj, 0);
   adj_value_changed (adj, chooser);
@@ -51,9 +51,8 @@ struct _GtkIconHelper
   GdkPaintable *paintable;
 };
 
-static GtkIconLookupFlags
-get_icon_lookup_flags (GtkIconHelper *self,
-                       GtkCssStyle   *style)
+GtkIconLookupFlags
+gtk_icon_helper_get_lookup_flags (GtkCssStyle *style)
 {
   GtkIconLookupFlags flags;
   GtkCssIconStyle icon_style;
@@ -95,7 +94,7 @@ ensure_paintable_for_gicon (GtkIconHelper    *self,
   GtkIconLookupFlags flags;
 
   icon_theme = gtk_icon_theme_get_for_display (gtk_widget_get_display (self->owner));
-  flags = get_icon_lookup_flags (self, style);
+  flags = gtk_icon_helper_get_lookup_flags (style);
   if (preload)
     flags |= GTK_ICON_LOOKUP_PRELOAD;
 
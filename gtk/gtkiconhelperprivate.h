@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "gtk/gtkicontheme.h"
 #include "gtk/gtkimage.h"
 #include "gtk/gtktypes.h"
 
@@ -65,6 +66,8 @@ const char *_gtk_icon_helper_get_icon_name (GtkIconHelper *self);
 
 int gtk_icon_helper_get_size (GtkIconHelper *self);
 
+GtkIconLookupFlags gtk_icon_helper_get_lookup_flags (GtkCssStyle *style);
+
 void      gtk_icon_helper_invalidate (GtkIconHelper *self);
 void      gtk_icon_helper_invalidate_for_change (GtkIconHelper     *self,
                                                  GtkCssStyleChange *change);
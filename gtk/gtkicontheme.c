@@ -54,6 +54,8 @@
 #include "gdktextureutilsprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdkprofilerprivate.h"
+#include "gdk/gdkmemoryformatprivate.h"
+#include "gdk/gdktexturedownloaderprivate.h"
 
 #define GDK_ARRAY_ELEMENT_TYPE char *
 #define GDK_ARRAY_NULL_TERMINATED 1
@@ -425,6 +427,9 @@ struct _GtkIconPaintable
   GMutex texture_lock;
 
   GdkTexture *texture;
+
+  /* Number of loads queued on the icon loader pool, accessed atomically */
+  int load_queued;
 };
 
 typedef struct
@@ -2415,18 +2420,107 @@ choose_icon (GtkIconTheme      *self,
   return icon;
 }
 
+/* Icons are decoded on a shared pool with a bounded number of
+ * threads, so that preloading a lot of icons at once does not
+ * spawn a thread per icon or starve the GTask pool.
+ */
+#define MAX_ICON_LOADER_THREADS 8
+
+typedef struct
+{
+  GTask *task;
+  GPtrArray *icons;
+  int n_pending;
+} IconPreload;
+
+typedef struct
+{
+  GtkIconPaintable *icon;
+  IconPreload *preload;
+} IconLoadJob;
+
 static void
-load_icon_thread (GTask        *task,
-                  gpointer      source_object,
-                  gpointer      task_data,
-                  GCancellable *cancellable)
+icon_preload_job_done (IconPreload *preload)
 {
-  GtkIconPaintable *self = GTK_ICON_PAINTABLE (source_object);
+  GTask *task;
 
-  g_mutex_lock (&self->texture_lock);
-  icon_ensure_texture__locked (self, TRUE);
-  g_mutex_unlock (&self->texture_lock);
-  g_task_return_pointer (task, NULL, NULL);
+  if (!g_atomic_int_dec_and_test (&preload->n_pending))
+    return;
+
+  task = preload->task;
+
+  if (!g_task_return_error_if_cancelled (task))
+    g_task_return_pointer (task, g_ptr_array_ref (preload->icons), (GDestroyNotify) g_ptr_array_unref);
+
+  g_ptr_array_unref (preload->icons);
+  g_free (preload);
+  g_object_unref (task);
+}
+
+static void
+load_icon_thread (gpointer data,
+                  gpointer user_data)
+{
+  IconLoadJob *job = data;
+  GtkIconPaintable *icon = job->icon;
+  GCancellable *cancellable = job->preload ? g_task_get_cancellable (job->preload->task) : NULL;
+
+  if (!g_cancellable_is_cancelled (cancellable))
+    {
+      g_mutex_lock (&icon->texture_lock);
+      icon_ensure_texture__locked (icon, TRUE);
+      g_mutex_unlock (&icon->texture_lock);
+    }
+
+  g_atomic_int_add (&icon->load_queued, -1);
+
+  if (job->preload)
+    icon_preload_job_done (job->preload);
+
+  g_object_unref (icon);
+  g_free (job);
+}
+
+static void
+icon_queue_load (GtkIconPaintable *icon,
+                 IconPreload      *preload)
+{
+  static GThreadPool *pool = NULL;
+  static gsize initialized = 0;
+  IconLoadJob *job;
+
+  if (g_once_init_enter (&initialized))
+    {
+      pool = g_thread_pool_new (load_icon_thread, NULL,
+                                CLAMP (g_get_num_processors (), 1, MAX_ICON_LOADER_THREADS),
+                                FALSE,
+                                NULL);
+      g_once_init_leave (&initialized, 1);
+    }
+
+  g_atomic_int_inc (&icon->load_queued);
+
+  job = g_new (IconLoadJob, 1);
+  job->icon = g_object_ref (icon);
+  job->preload = preload;
+
+  g_thread_pool_push (pool, job, NULL);
+}
+
+static gboolean
+icon_needs_load (GtkIconPaintable *icon)
+{
+  gboolean has_texture;
+
+  /* If we fail to get the lock it is because some other thread is
+     currently loading the icon, so we need to do nothing */
+  if (!g_mutex_trylock (&icon->texture_lock))
+    return FALSE;
+
+  has_texture = icon->texture != NULL;
+  g_mutex_unlock (&icon->texture_lock);
+
+  return !has_texture;
 }
 
 /**
@@ -2487,7 +2581,7 @@ gtk_icon_theme_lookup_icon (GtkIconTheme       *self,
       memcpy (&names[1], fallbacks, sizeof (char *) * n_fallbacks);
       names[n_fallbacks + 1] = NULL;
 
-      icon = choose_icon (self, names, size, scale, direction, flags, FALSE);
+      icon = choose_icon (self, names, size, scale, direction, flags & ~GTK_ICON_LOOKUP_PRELOAD, FALSE);
 
       g_free (names);
     }
@@ -2498,32 +2592,121 @@ gtk_icon_theme_lookup_icon (GtkIconTheme       *self,
       names[0] = icon_name;
       names[1] = NULL;
 
-      icon = choose_icon (self, names, size, scale, direction, flags, FALSE);
+      icon = choose_icon (self, names, size, scale, direction, flags & ~GTK_ICON_LOOKUP_PRELOAD, FALSE);
     }
 
   gtk_icon_theme_unlock (self);
 
-  if (flags & GTK_ICON_LOOKUP_PRELOAD)
+  if ((flags & GTK_ICON_LOOKUP_PRELOAD) &&
+      g_atomic_int_get (&icon->load_queued) == 0 &&
+      icon_needs_load (icon))
+    icon_queue_load (icon, NULL);
+
+  return icon;
+}
+
+/*< private >
+ * gtk_icon_theme_preload_icons_async:
+ * @self: a `GtkIconTheme`
+ * @icons: (array zero-terminated=1): the icons to load
+ * @size: desired icon size, in application pixels
+ * @scale: the window scale the icons will be displayed on
+ * @direction: text direction the icons will be displayed in
+ * @flags: flags modifying the behavior of the icon lookup
+ * @cancellable: (nullable): a `GCancellable`
+ * @callback: (nullable): called when all icons are loaded
+ * @user_data: data to pass to @callback
+ *
+ * Looks up all of @icons like gtk_icon_theme_lookup_by_gicon()
+ * and loads their textures on a pool of worker threads.
+ *
+ * Themed icons resolve to the same paintables that later lookups
+ * with the same parameters return, so widgets showing them find
+ * their textures already loaded.
+ *
+ * Icons that resolve to the same paintable are only loaded once,
+ * and icons that are already loaded are not queued at all.
+ *
+ * Use gtk_icon_theme_preload_icons_finish() to get the
+ * paintables, in the order of @icons.
+ */
+void
+gtk_icon_theme_preload_icons_async (GtkIconTheme        *self,
+                                    GIcon * const       *icons,
+                                    int                  size,
+                                    int                  scale,
+                                    GtkTextDirection     direction,
+                                    GtkIconLookupFlags   flags,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  IconPreload *preload;
+  GHashTable *seen;
+  GPtrArray *to_load;
+  guint i;
+
+  g_return_if_fail (GTK_IS_ICON_THEME (self));
+  g_return_if_fail (icons != NULL);
+  g_return_if_fail (size > 0);
+  g_return_if_fail (scale >= 1);
+
+  preload = g_new0 (IconPreload, 1);
+  preload->task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (preload->task, gtk_icon_theme_preload_icons_async);
+  preload->icons = g_ptr_array_new_with_free_func (g_object_unref);
+
+  seen = g_hash_table_new (NULL, NULL);
+  to_load = g_ptr_array_new ();
+
+  for (i = 0; icons[i]; i++)
     {
-      gboolean has_texture = FALSE;
+      GtkIconPaintable *icon;
 
-      /* If we fail to get the lock it is because some other thread is
-         currently loading the icon, so we need to do nothing */
-      if (g_mutex_trylock (&icon->texture_lock))
-        {
-          has_texture = icon->texture != NULL;
-          g_mutex_unlock (&icon->texture_lock);
+      icon = gtk_icon_theme_lookup_by_gicon (self, icons[i], size, scale, direction, flags & ~GTK_ICON_LOOKUP_PRELOAD);
+      g_ptr_array_add (preload->icons, icon);
 
-          if (!has_texture)
-            {
-              GTask *task = g_task_new (icon, NULL, NULL, NULL);
-              g_task_run_in_thread (task, load_icon_thread);
-              g_object_unref (task);
-            }
-        }
+      /* A load that is already queued may finish before we return,
+       * so queue our own job behind it; it finds the texture loaded.
+       */
+      if (g_hash_table_add (seen, icon) &&
+          (g_atomic_int_get (&icon->load_queued) > 0 || icon_needs_load (icon)))
+        g_ptr_array_add (to_load, icon);
     }
 
-  return icon;
+  /* One extra count, so we don't finish while still queueing */
+  preload->n_pending = to_load->len + 1;
+
+  for (i = 0; i < to_load->len; i++)
+    icon_queue_load (g_ptr_array_index (to_load, i), preload);
+
+  icon_preload_job_done (preload);
+
+  g_ptr_array_unref (to_load);
+  g_hash_table_unref (seen);
+}
+
+/*< private >
+ * gtk_icon_theme_preload_icons_finish:
+ * @self: a `GtkIconTheme`
+ * @result: the `GAsyncResult`
+ * @error: return location for an error
+ *
+ * Finishes an operation started with
+ * gtk_icon_theme_preload_icons_async().
+ *
+ * Returns: (transfer container) (element-type GtkIconPaintable) (nullable):
+ *   the looked up icons, with their textures loaded
+ */
+GPtrArray *
+gtk_icon_theme_preload_icons_finish (GtkIconTheme  *self,
+                                     GAsyncResult  *result,
+                                     GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_icon_theme_preload_icons_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -3680,6 +3863,371 @@ gtk_icon_paintable_is_symbolic (GtkIconPaintable *icon)
   return icon->is_symbolic;
 }
 
+/* On-disk cache of rasterized SVG icons
+ *
+ * Rasterizing SVGs is by far the most expensive part of loading
+ * icons, and it is repeated for the same files and sizes every time
+ * an application starts. We keep the resulting pixels in the user
+ * cache dir and map them back in on the next load.
+ *
+ * Entries are keyed by the path, modification time and size of the
+ * SVG file, together with pixel size, scale and symbolic-ness, so
+ * looking up an entry only needs a stat() and the file is read only
+ * when it has to be rasterized. Entries are written on a background
+ * thread, and when the cache grows beyond its size limit, the least
+ * recently used entries are removed.
+ *
+ * The cache is off unless GTK_ICON_CACHE_SIZE is set to the limit,
+ * in megabytes.
+ */
+
+#define ICON_DISK_CACHE_MAGIC "GTKICN02"
+
+/* Entries that are used are touched at most this often, in seconds */
+#define ICON_DISK_CACHE_TOUCH_INTERVAL (24 * 60 * 60)
+
+typedef struct
+{
+  char    magic[8];
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+  guint32 format;
+  guint32 only_fg;
+  guint32 padding[3];
+} IconDiskCacheHeader;
+
+G_STATIC_ASSERT (sizeof (IconDiskCacheHeader) == 40);
+
+typedef struct
+{
+  char *path;
+  GdkTexture *texture;
+  gboolean only_fg;
+} IconDiskCacheWrite;
+
+typedef struct
+{
+  char *path;
+  gint64 mtime;
+  gsize size;
+} IconDiskCacheEntry;
+
+static gsize icon_disk_cache_limit;
+
+static GMutex icon_disk_cache_mutex;
+static GCond icon_disk_cache_cond;
+static guint icon_disk_cache_n_pending;
+
+static const char *
+icon_disk_cache_get_dir (void)
+{
+  static const char *dir = NULL;
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      const char *str;
+
+      icon_disk_cache_limit = 0;
+
+      str = g_getenv ("GTK_ICON_CACHE_SIZE");
+      if (str != NULL)
+        {
+          guint64 value;
+          GError *error = NULL;
+
+          if (!g_ascii_string_to_unsigned (str, 10, 0, G_MAXSIZE / (1024 * 1024), &value, &error))
+            {
+              g_warning ("Failed to parse GTK_ICON_CACHE_SIZE: %s", error->message);
+              g_error_free (error);
+            }
+          else
+            {
+              icon_disk_cache_limit = (gsize) value * 1024 * 1024;
+            }
+        }
+
+      if (icon_disk_cache_limit > 0)
+        {
+          char *d = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "icons", NULL);
+
+          if (g_mkdir_with_parents (d, 0700) == 0)
+            dir = d;
+          else
+            g_free (d);
+        }
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return dir;
+}
+
+static char *
+icon_disk_cache_get_path (GtkIconPaintable *icon,
+                          int               pixel_size)
+{
+  const char *dir;
+  char *key, *checksum, *name, *path;
+  GStatBuf stat_buf;
+
+  if (icon->is_resource || icon->filename == NULL || !icon->is_svg)
+    return NULL;
+
+  dir = icon_disk_cache_get_dir ();
+  if (dir == NULL)
+    return NULL;
+
+  if (g_stat (icon->filename, &stat_buf) != 0)
+    return NULL;
+
+  key = g_strdup_printf ("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT,
+                         icon->filename,
+                         (gint64) stat_buf.st_mtime,
+                         (gint64) stat_buf.st_size);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  name = g_strdup_printf ("%s-%d@%d%s",
+                          checksum, pixel_size, icon->desired_scale,
+                          icon->is_symbolic ? "-symbolic" : "");
+  path = g_build_filename (dir, name, NULL);
+
+  g_free (name);
+  g_free (checksum);
+  g_free (key);
+
+  return path;
+}
+
+static GdkTexture *
+icon_disk_cache_load (const char *path,
+                      gboolean   *only_fg)
+{
+  GMappedFile *mapped;
+  GBytes *bytes, *pixels;
+  const IconDiskCacheHeader *header;
+  GdkTexture *texture = NULL;
+  GStatBuf stat_buf;
+  gsize size, row_size, n_bytes;
+
+  mapped = g_mapped_file_new (path, FALSE, NULL);
+  if (mapped == NULL)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  size = g_bytes_get_size (bytes);
+  if (size < sizeof (IconDiskCacheHeader))
+    goto out;
+
+  header = g_bytes_get_data (bytes, NULL);
+  if (memcmp (header->magic, ICON_DISK_CACHE_MAGIC, sizeof (header->magic)) != 0 ||
+      header->format >= GDK_MEMORY_N_FORMATS ||
+      header->width == 0 || header->height == 0)
+    goto out;
+
+  /* Other processes write here too, so don't trust the header */
+  if (!g_size_checked_mul (&row_size, header->width, gdk_memory_format_bytes_per_pixel (header->format)) ||
+      header->stride < row_size ||
+      !g_size_checked_mul (&n_bytes, header->stride, header->height) ||
+      n_bytes > size - sizeof (IconDiskCacheHeader))
+    goto out;
+
+  /* Keeps the mapping alive for as long as the texture */
+  pixels = g_bytes_new_from_bytes (bytes,
+                                   sizeof (IconDiskCacheHeader),
+                                   n_bytes);
+  texture = gdk_memory_texture_new (header->width, header->height,
+                                    header->format,
+                                    pixels,
+                                    header->stride);
+  g_bytes_unref (pixels);
+
+  *only_fg = header->only_fg != 0;
+
+  /* The mtime is what eviction goes by, so keep it
+   * fresh for entries that are still in use
+   */
+  if (g_stat (path, &stat_buf) == 0 &&
+      g_get_real_time () / G_USEC_PER_SEC - stat_buf.st_mtime > ICON_DISK_CACHE_TOUCH_INTERVAL)
+    g_utime (path, NULL);
+
+out:
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static int
+icon_disk_cache_entry_compare (gconstpointer a,
+                               gconstpointer b)
+{
+  const IconDiskCacheEntry *ea = a;
+  const IconDiskCacheEntry *eb = b;
+
+  return ea->mtime < eb->mtime ? -1 : (ea->mtime > eb->mtime ? 1 : 0);
+}
+
+static void
+icon_disk_cache_prune (const char *dir)
+{
+  GDir *d;
+  GArray *entries;
+  const char *name;
+  gsize total = 0;
+  guint i;
+
+  d = g_dir_open (dir, 0, NULL);
+  if (d == NULL)
+    return;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (IconDiskCacheEntry));
+
+  while ((name = g_dir_read_name (d)))
+    {
+      IconDiskCacheEntry entry;
+      GStatBuf stat_buf;
+
+      entry.path = g_build_filename (dir, name, NULL);
+      if (g_stat (entry.path, &stat_buf) != 0 || !S_ISREG (stat_buf.st_mode))
+        {
+          g_free (entry.path);
+          continue;
+        }
+
+      entry.mtime = stat_buf.st_mtime;
+      entry.size = stat_buf.st_size;
+      total += entry.size;
+      g_array_append_val (entries, entry);
+    }
+
+  g_dir_close (d);
+
+  /* Remove the least recently used entries until we are well below
+   * the limit, so we don't have to do this again after every write.
+   */
+  if (total > icon_disk_cache_limit)
+    {
+      g_array_sort (entries, icon_disk_cache_entry_compare);
+
+      for (i = 0; i < entries->len && total > icon_disk_cache_limit / 4 * 3; i++)
+        {
+          IconDiskCacheEntry *entry = &g_array_index (entries, IconDiskCacheEntry, i);
+
+          if (g_unlink (entry->path) == 0)
+            total -= entry->size;
+        }
+    }
+
+  for (i = 0; i < entries->len; i++)
+    g_free (g_array_index (entries, IconDiskCacheEntry, i).path);
+  g_array_free (entries, TRUE);
+}
+
+static void
+icon_disk_cache_write_thread (gpointer data,
+                              gpointer user_data)
+{
+  /* Only one writer thread, so these need no locking */
+  static gboolean pruned = FALSE;
+  static gsize written = 0;
+  IconDiskCacheWrite *write = data;
+  GdkTextureDownloader downloader;
+  IconDiskCacheHeader header = { 0, };
+  GBytes *pixels;
+  gsize stride, n_pixels;
+  char *contents;
+
+  gdk_texture_downloader_init (&downloader, write->texture);
+  gdk_texture_downloader_set_format (&downloader, gdk_texture_get_format (write->texture));
+  pixels = gdk_texture_downloader_download_bytes (&downloader, &stride);
+  gdk_texture_downloader_finish (&downloader);
+
+  memcpy (header.magic, ICON_DISK_CACHE_MAGIC, sizeof (header.magic));
+  header.width = gdk_texture_get_width (write->texture);
+  header.height = gdk_texture_get_height (write->texture);
+  header.stride = stride;
+  header.format = gdk_texture_get_format (write->texture);
+  header.only_fg = write->only_fg;
+
+  n_pixels = stride * header.height;
+  contents = g_malloc (sizeof (header) + n_pixels);
+  memcpy (contents, &header, sizeof (header));
+  memcpy (contents + sizeof (header), g_bytes_get_data (pixels, NULL), n_pixels);
+
+  /* Failing to write the cache is not an error, we'll just rasterize again */
+  if (g_file_set_contents_full (write->path, contents, sizeof (header) + n_pixels,
+                                G_FILE_SET_CONTENTS_CONSISTENT, 0600, NULL))
+    written += sizeof (header) + n_pixels;
+
+  /* Other processes write to the cache too, so check
+   * once at startup and then whenever we added a fair bit
+   */
+  if (!pruned || written > icon_disk_cache_limit / 4)
+    {
+      icon_disk_cache_prune (icon_disk_cache_get_dir ());
+      pruned = TRUE;
+      written = 0;
+    }
+
+  g_free (contents);
+  g_bytes_unref (pixels);
+  g_object_unref (write->texture);
+  g_free (write->path);
+  g_free (write);
+
+  g_mutex_lock (&icon_disk_cache_mutex);
+  icon_disk_cache_n_pending--;
+  g_cond_broadcast (&icon_disk_cache_cond);
+  g_mutex_unlock (&icon_disk_cache_mutex);
+}
+
+/* Writing happens on a background thread, so that neither
+ * the texture lock nor the main thread waits for the disk
+ */
+static void
+icon_disk_cache_save (const char *path,
+                      GdkTexture *texture,
+                      gboolean    only_fg)
+{
+  static GThreadPool *pool = NULL;
+  static gsize initialized = 0;
+  IconDiskCacheWrite *write;
+
+  if (g_once_init_enter (&initialized))
+    {
+      pool = g_thread_pool_new (icon_disk_cache_write_thread, NULL, 1, FALSE, NULL);
+      g_once_init_leave (&initialized, 1);
+    }
+
+  write = g_new (IconDiskCacheWrite, 1);
+  write->path = g_strdup (path);
+  write->texture = g_object_ref (texture);
+  write->only_fg = only_fg;
+
+  g_mutex_lock (&icon_disk_cache_mutex);
+  icon_disk_cache_n_pending++;
+  g_mutex_unlock (&icon_disk_cache_mutex);
+
+  g_thread_pool_push (pool, write, NULL);
+}
+
+/*< private >
+ * gtk_icon_disk_cache_flush:
+ *
+ * Waits until all queued writes to the on-disk icon cache
+ * have finished.
+ */
+void
+gtk_icon_disk_cache_flush (void)
+{
+  g_mutex_lock (&icon_disk_cache_mutex);
+  while (icon_disk_cache_n_pending > 0)
+    g_cond_wait (&icon_disk_cache_cond, &icon_disk_cache_mutex);
+  g_mutex_unlock (&icon_disk_cache_mutex);
+}
+
 /* This function contains the complicated logic for deciding
  * on the size at which to load the icon and loading it at
  * that size.
@@ -3692,6 +4240,8 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
   int pixel_size;
   GError *load_error = NULL;
   gboolean only_fg = FALSE;
+  char *cache_path;
+  gboolean cache_miss = FALSE;
 
   icon_cache_mark_used_if_cached (icon);
 
@@ -3704,6 +4254,7 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
    * We precalculate this so we can use it as a rasterization size for svgs.
    */
   pixel_size = icon->desired_size * icon->desired_scale;
+  cache_path = icon_disk_cache_get_path (icon, pixel_size);
 
   /* At this point, we need to actually get the icon; either from the
    * builtin image or by loading the file
@@ -3737,7 +4288,17 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
     }
   else if (icon->filename)
     {
-      if (icon->is_svg)
+      if (cache_path)
+        {
+          icon->texture = icon_disk_cache_load (cache_path, &only_fg);
+          cache_miss = icon->texture == NULL;
+        }
+
+      if (icon->texture)
+        {
+          /* Found in the disk cache */
+        }
+      else if (icon->is_svg)
         {
           if (icon->is_symbolic)
             icon->texture = gdk_texture_new_from_filename_symbolic (icon->filename,
@@ -3768,6 +4329,9 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
         {
           icon->texture = gdk_texture_new_from_filename_with_fg (icon->filename, &only_fg, &load_error);
         }
+
+      if (icon->texture && cache_miss)
+        icon_disk_cache_save (cache_path, icon->texture, only_fg);
     }
   else
     {
@@ -3789,7 +4353,11 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
                                                                   NULL,
                                                                   &load_error);
           else
-            icon->texture = gdk_texture_new_from_stream_with_fg (stream, &only_fg, NULL, &load_error);
+            icon->texture = gdk_texture_new_from_stream_at_size_with_fg (stream,
+                                                                         pixel_size, pixel_size,
+                                                                         &only_fg,
+                                                                         NULL,
+                                                                         &load_error);
 
           g_object_unref (stream);
         }
@@ -3797,6 +4365,8 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
 
   icon->only_fg = only_fg;
 
+  g_free (cache_path);
+
   if (!icon->texture)
     {
       g_warning ("Failed to load icon %s: %s", icon->filename, load_error ? load_error->message : "");
@@ -28,3 +28,18 @@ const char *gtk_string_set_add (GtkStringSet *set,
 
 int gtk_icon_theme_get_serial (GtkIconTheme *self);
 
+void       gtk_icon_theme_preload_icons_async  (GtkIconTheme        *self,
+                                                GIcon * const       *icons,
+                                                int                  size,
+                                                int                  scale,
+                                                GtkTextDirection     direction,
+                                                GtkIconLookupFlags   flags,
+                                                GCancellable        *cancellable,
+                                                GAsyncReadyCallback  callback,
+                                                gpointer             user_data);
+GPtrArray *gtk_icon_theme_preload_icons_finish (GtkIconTheme        *self,
+                                                GAsyncResult        *result,
+                                                GError             **error);
+
+void       gtk_icon_disk_cache_flush           (void);
+
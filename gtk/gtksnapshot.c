@@ -39,6 +39,7 @@
 #define GDK_ARRAY_TYPE_NAME GtkSnapshotNodes
 #define GDK_ARRAY_ELEMENT_TYPE GskRenderNode *
 #define GDK_ARRAY_FREE_FUNC gsk_render_node_unref
+#define GDK_ARRAY_PREALLOC 32
 #include "gdk/gdkarrayimpl.c"
 
 /**
@@ -60,6 +61,10 @@
 
 typedef struct _GtkSnapshotState GtkSnapshotState;
 
+/* Collect funcs own the references to the collected nodes. They
+ * must either put them into the returned node or release them,
+ * usually by passing them to gtk_snapshot_collect_default().
+ */
 typedef GskRenderNode * (* GtkSnapshotCollectFunc) (GtkSnapshot      *snapshot,
                                                     GtkSnapshotState *state,
                                                     GskRenderNode   **nodes,
@@ -211,11 +216,11 @@ gtk_snapshot_collect_default (GtkSnapshot       *snapshot,
     }
   else if (n_nodes == 1)
     {
-      node = gsk_render_node_ref (nodes[0]);
+      node = nodes[0];
     }
   else
     {
-      node = gsk_container_node_new (nodes, n_nodes);
+      node = gsk_container_node_new_take (nodes, n_nodes);
     }
 
   return node;
@@ -730,7 +735,12 @@ gtk_snapshot_collect_discard_repeat (GtkSnapshot      *snapshot,
                                      GskRenderNode   **nodes,
                                      guint             n_nodes)
 {
+  guint i;
+
   /* Drop the node and return nothing.  */
+  for (i = 0; i < n_nodes; i++)
+    gsk_render_node_unref (nodes[i]);
+
   return NULL;
 }
 
@@ -937,7 +947,11 @@ gtk_snapshot_collect_gl_shader (GtkSnapshot      *snapshot,
   shader_node = NULL;
 
   if (n_collected_nodes != 0)
-    g_warning ("Unexpected children when popping gl shader.");
+    {
+      g_warning ("Unexpected children when popping gl shader.");
+      for (int i = 0; i < n_collected_nodes; i++)
+        gsk_render_node_unref (collected_nodes[i]);
+    }
 
   if (state->data.glshader.nodes)
     nodes = state->data.glshader.nodes;
@@ -1793,9 +1807,11 @@ gtk_snapshot_pop_one (GtkSnapshot *snapshot)
       /* The collect func may not modify the state stack... */
       g_assert (state_index == gtk_snapshot_states_get_size (&snapshot->state_stack) - 1);
 
-      /* Remove all the state's nodes from the list of nodes */
+      /* Remove all the state's nodes from the list of nodes,
+       * the collect func took over the references
+       */
       g_assert (state->start_node_index + state->n_nodes == gtk_snapshot_nodes_get_size (&snapshot->nodes));
-      gtk_snapshot_nodes_splice (&snapshot->nodes, state->start_node_index, state->n_nodes, FALSE, NULL, 0);
+      gtk_snapshot_nodes_splice (&snapshot->nodes, state->start_node_index, state->n_nodes, TRUE, NULL, 0);
     }
   else
     {
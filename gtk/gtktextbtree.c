@@ -208,6 +208,14 @@ struct _GtkTextBTree {
   guint end_iter_line_stamp;
   guint end_iter_segment_stamp;
 
+  /* Cache the line found by the last char offset lookup,
+   * so sequential offset lookups don't walk down the tree
+   */
+  GtkTextLine *char_line;
+  int char_line_start;
+  int char_line_count;
+  guint char_line_stamp;
+
   GHashTable *child_anchor_table;
 };
 
@@ -231,6 +239,11 @@ struct _GtkTextBTree {
    not just the line number searches.
 */
 
+/* How many lines _gtk_text_btree_get_line_at_char() walks forward
+ * from the cached line before falling back to a lookup from the root.
+ */
+#define CHAR_LINE_CACHE_MAX_WALK 8
+
 #if 1
 #define MAX_CHILDREN 12
 #define MIN_CHILDREN 6
@@ -416,6 +429,9 @@ _gtk_text_btree_new (GtkTextTagTable *table,
   tree->end_iter_segment_byte_index = 0;
   tree->end_iter_segment_char_offset = 0;
 
+  tree->char_line_stamp = tree->chars_changed_stamp - 1;
+  tree->char_line = NULL;
+
   g_object_ref (tree->table);
 
   tree->tag_changed_handler = g_signal_connect (tree->table,
@@ -2124,6 +2140,37 @@ _gtk_text_btree_get_line_at_char (GtkTextBTree      *tree,
 
   *real_char_index = char_index;
 
+  if (tree->char_line_stamp == tree->chars_changed_stamp &&
+      char_index >= tree->char_line_start)
+    {
+      int i;
+
+      /* Walk forward a few lines from the cached one; anything
+       * further away is cheaper to find by descending the tree.
+       */
+      line = tree->char_line;
+      chars_left = char_index - tree->char_line_start;
+      chars_in_line = tree->char_line_count;
+
+      for (i = 0; i < CHAR_LINE_CACHE_MAX_WALK && line != NULL; i++)
+        {
+          if (chars_left < chars_in_line)
+            {
+              tree->char_line = line;
+              tree->char_line_start = char_index - chars_left;
+              tree->char_line_count = chars_in_line;
+
+              *line_start_index = tree->char_line_start;
+              return line;
+            }
+
+          chars_left -= chars_in_line;
+          line = _gtk_text_line_next (line);
+          if (line != NULL)
+            chars_in_line = _gtk_text_line_char_count (line);
+        }
+    }
+
   /*
    * Work down through levels of the tree until a GtkTextBTreeNode is found at
    * level 0.
@@ -2146,8 +2193,9 @@ _gtk_text_btree_get_line_at_char (GtkTextBTree      *tree,
     {
       /* Start of a line */
 
+      line = node->children.line;
       *line_start_index = char_index;
-      return node->children.line;
+      goto out;
     }
 
   /*
@@ -2181,6 +2229,13 @@ _gtk_text_btree_get_line_at_char (GtkTextBTree      *tree,
   g_assert (seg != NULL);
 
   *line_start_index = char_index - chars_left;
+
+ out:
+  tree->char_line = line;
+  tree->char_line_start = *line_start_index;
+  tree->char_line_count = _gtk_text_line_char_count (line);
+  tree->char_line_stamp = tree->chars_changed_stamp;
+
   return line;
 }
 
@@ -39,6 +39,7 @@
 #include "gtkprivate.h"
 
 #define DEFAULT_MAX_UNDO 200
+#define DEFAULT_MAX_UNDO_BYTES (64 * 1024 * 1024)
 
 /**
  * GtkTextBuffer:
@@ -949,6 +950,7 @@ gtk_text_buffer_init (GtkTextBuffer *buffer)
   buffer->priv->history = gtk_text_history_new (&history_funcs, buffer);
 
   gtk_text_history_set_max_undo_levels (buffer->priv->history, DEFAULT_MAX_UNDO);
+  gtk_text_history_set_max_undo_bytes (buffer->priv->history, DEFAULT_MAX_UNDO_BYTES);
 }
 
 static void
@@ -5106,7 +5108,8 @@ gtk_text_buffer_get_enable_undo (GtkTextBuffer *buffer)
  * the buffer. Changes to tags and marks are not tracked.
  *
  * If enabled, the user will be able to undo the last number of actions
- * up to [method@Gtk.TextBuffer.get_max_undo_levels].
+ * up to [method@Gtk.TextBuffer.get_max_undo_levels]. Older actions may
+ * also be dropped when the undo history holds on to a lot of text.
  *
  * See [method@Gtk.TextBuffer.begin_irreversible_action] and
  * [method@Gtk.TextBuffer.end_irreversible_action] to create
@@ -36,6 +36,11 @@
  * gtk_text_history_end_irreversible_action() can be used to denote a
  * section of operations that cannot be undone. This will cause all previous
  * changes tracked by the GtkTextHistory to be discarded.
+ *
+ * The history can be bounded by the number of actions it contains, as well
+ * as by the number of bytes of text those actions keep around. Whenever
+ * either limit is exceeded, the oldest actions are dropped, but the most
+ * recent action is always kept so that it can be undone.
  */
 
 typedef struct _Action     Action;
@@ -99,6 +104,9 @@ struct _GtkTextHistory
   guint               in_user;
   guint               max_undo_levels;
 
+  gsize               n_bytes;
+  gsize               max_undo_bytes;
+
   guint               can_undo : 1;
   guint               can_redo : 1;
   guint               is_modified : 1;
@@ -308,6 +316,33 @@ action_free (Action *action)
   g_free (action);
 }
 
+static gsize
+action_get_n_bytes (const Action *action)
+{
+  gsize n_bytes = 0;
+
+  switch (action->kind)
+    {
+    case ACTION_KIND_INSERT:
+      return action->u.insert.istr.n_bytes;
+
+    case ACTION_KIND_DELETE_BACKSPACE:
+    case ACTION_KIND_DELETE_KEY:
+    case ACTION_KIND_DELETE_PROGRAMMATIC:
+    case ACTION_KIND_DELETE_SELECTION:
+      return action->u.delete.istr.n_bytes;
+
+    case ACTION_KIND_GROUP:
+      for (const GList *iter = action->u.group.actions.head; iter; iter = iter->next)
+        n_bytes += action_get_n_bytes (iter->data);
+      return n_bytes;
+
+    case ACTION_KIND_BARRIER:
+    default:
+      return 0;
+    }
+}
+
 static gboolean
 action_group_is_empty (const Action *action)
 {
@@ -437,7 +472,29 @@ action_chain (Action   *action,
        * have a group to coalesce. But unless each action deletes
        * a single character, the overhead isn't too bad as we embed
        * the strings in the action.
+       *
+       * Within a user action the whole group is undone at once, so
+       * we can merge runs of adjacent deletes into a single action.
        */
+      if (!in_user_action)
+        return FALSE;
+
+      if (action->u.delete.begin == other->u.delete.begin)
+        {
+          istring_append (&action->u.delete.istr, &other->u.delete.istr);
+          action->u.delete.end += other->u.delete.istr.n_chars;
+          action_free (other);
+          return TRUE;
+        }
+      else if (other->u.delete.end == action->u.delete.begin)
+        {
+          istring_prepend (&action->u.delete.istr,
+                           &other->u.delete.istr);
+          action->u.delete.begin = other->u.delete.begin;
+          action_free (other);
+          return TRUE;
+        }
+
       return FALSE;
 
     case ACTION_KIND_DELETE_SELECTION:
@@ -534,21 +591,35 @@ gtk_text_history_do_select (GtkTextHistory *self,
   self->funcs.select (self->funcs_data, selection_insert, selection_bound);
 }
 
+static void
+gtk_text_history_drop_action (GtkTextHistory *self,
+                              GQueue         *queue,
+                              Action         *action)
+{
+  gsize n_bytes = action_get_n_bytes (action);
+
+  g_assert (self->n_bytes >= n_bytes);
+
+  self->n_bytes -= n_bytes;
+  g_queue_unlink (queue, &action->link);
+  action_free (action);
+}
+
+static void
+gtk_text_history_clear_queue (GtkTextHistory *self,
+                              GQueue         *queue)
+{
+  while (queue->length > 0)
+    gtk_text_history_drop_action (self, queue, g_queue_peek_head (queue));
+}
+
 static void
 gtk_text_history_truncate_one (GtkTextHistory *self)
 {
   if (self->undo_queue.length > 0)
-    {
-      Action *action = g_queue_peek_head (&self->undo_queue);
-      g_queue_unlink (&self->undo_queue, &action->link);
-      action_free (action);
-    }
+    gtk_text_history_drop_action (self, &self->undo_queue, g_queue_peek_head (&self->undo_queue));
   else if (self->redo_queue.length > 0)
-    {
-      Action *action = g_queue_peek_tail (&self->redo_queue);
-      g_queue_unlink (&self->redo_queue, &action->link);
-      action_free (action);
-    }
+    gtk_text_history_drop_action (self, &self->redo_queue, g_queue_peek_tail (&self->redo_queue));
   else
     {
       g_assert_not_reached ();
@@ -560,11 +631,18 @@ gtk_text_history_truncate (GtkTextHistory *self)
 {
   g_assert (GTK_IS_TEXT_HISTORY (self));
 
-  if (self->max_undo_levels == 0)
-    return;
+  if (self->max_undo_levels > 0)
+    {
+      while (self->undo_queue.length + self->redo_queue.length > self->max_undo_levels)
+        gtk_text_history_truncate_one (self);
+    }
 
-  while (self->undo_queue.length + self->redo_queue.length > self->max_undo_levels)
-    gtk_text_history_truncate_one (self);
+  if (self->max_undo_bytes > 0)
+    {
+      while (self->n_bytes > self->max_undo_bytes &&
+             self->undo_queue.length + self->redo_queue.length > 1)
+        gtk_text_history_truncate_one (self);
+    }
 }
 
 static void
@@ -650,12 +728,7 @@ gtk_text_history_push (GtkTextHistory *self,
   g_assert (self->enabled);
   g_assert (action != NULL);
 
-  while (self->redo_queue.length > 0)
-    {
-      peek = g_queue_peek_head (&self->redo_queue);
-      g_queue_unlink (&self->redo_queue, &peek->link);
-      action_free (peek);
-    }
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   peek = g_queue_peek_tail (&self->undo_queue);
   in_user_action = self->in_user > 0;
@@ -951,7 +1024,7 @@ gtk_text_history_end_user_action (GtkTextHistory *self)
   return_if_applying (self);
   return_if_irreversible (self);
 
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   peek = g_queue_peek_tail (&self->undo_queue);
 
@@ -973,8 +1046,7 @@ gtk_text_history_end_user_action (GtkTextHistory *self)
   /* Unlikely, but if the group is empty, just remove it */
   if (action_group_is_empty (peek))
     {
-      g_queue_unlink (&self->undo_queue, &peek->link);
-      action_free (peek);
+      gtk_text_history_drop_action (self, &self->undo_queue, peek);
       goto update_state;
     }
 
@@ -1023,8 +1095,8 @@ gtk_text_history_begin_irreversible_action (GtkTextHistory *self)
 
   self->irreversible++;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear_queue (self, &self->undo_queue);
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   gtk_text_history_update_state (self);
 }
@@ -1045,8 +1117,8 @@ gtk_text_history_end_irreversible_action (GtkTextHistory *self)
 
   self->irreversible--;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear_queue (self, &self->undo_queue);
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   gtk_text_history_update_state (self);
 }
@@ -1157,6 +1229,7 @@ gtk_text_history_text_inserted (GtkTextHistory *self,
   action->u.insert.begin = position;
   action->u.insert.end = position + n_chars;
   istring_set (&action->u.insert.istr, text, len, n_chars);
+  self->n_bytes += len;
 
   gtk_text_history_push (self, action);
 }
@@ -1195,6 +1268,7 @@ gtk_text_history_text_deleted (GtkTextHistory *self,
   action->u.delete.selection.insert = self->selection.insert;
   action->u.delete.selection.bound = self->selection.bound;
   istring_set (&action->u.delete.istr, text, len, ABS (end - begin));
+  self->n_bytes += len;
 
   gtk_text_history_push (self, action);
 }
@@ -1223,8 +1297,8 @@ gtk_text_history_set_enabled (GtkTextHistory *self,
         {
           self->irreversible = 0;
           self->in_user = 0;
-          clear_action_queue (&self->undo_queue);
-          clear_action_queue (&self->redo_queue);
+          gtk_text_history_clear_queue (self, &self->undo_queue);
+          gtk_text_history_clear_queue (self, &self->redo_queue);
         }
 
       gtk_text_history_update_state (self);
@@ -1251,3 +1325,32 @@ gtk_text_history_set_max_undo_levels (GtkTextHistory *self,
       gtk_text_history_truncate (self);
     }
 }
+
+gsize
+gtk_text_history_get_max_undo_bytes (GtkTextHistory *self)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_HISTORY (self), 0);
+
+  return self->max_undo_bytes;
+}
+
+/*
+ * gtk_text_history_set_max_undo_bytes:
+ * @self: a GtkTextHistory
+ * @max_undo_bytes: the maximum number of bytes of text to keep, or 0
+ *
+ * Limits how much text the undo and redo history may hold on to.
+ * If 0, the history is only bounded by the maximum number of undo levels.
+ */
+void
+gtk_text_history_set_max_undo_bytes (GtkTextHistory *self,
+                                     gsize           max_undo_bytes)
+{
+  g_return_if_fail (GTK_IS_TEXT_HISTORY (self));
+
+  if (self->max_undo_bytes != max_undo_bytes)
+    {
+      self->max_undo_bytes = max_undo_bytes;
+      gtk_text_history_truncate (self);
+    }
+}
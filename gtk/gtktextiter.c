@@ -4516,6 +4516,15 @@ forward_chars_with_skipping (GtkTextIter *iter,
 
   g_return_if_fail (count >= 0);
 
+  /* Nothing to skip, so chars map 1:1 to offsets and we can
+   * let the btree move over whole segments at once.
+   */
+  if (!skip_invisible && !skip_nontext && !skip_decomp)
+    {
+      gtk_text_iter_forward_chars (iter, count);
+      return;
+    }
+
   i = count;
 
   while (i > 0)
@@ -4535,7 +4544,8 @@ forward_chars_with_skipping (GtkTextIter *iter,
           _gtk_text_btree_char_is_invisible (iter))
         ignored = TRUE;
 
-      if (!ignored && skip_decomp)
+      /* ASCII casefolds and normalizes to a single char */
+      if (!ignored && skip_decomp && gtk_text_iter_get_char (iter) >= 0x80)
         {
           /* being UTF8 correct sucks: this accounts for extra
              offsets coming from canonical decompositions of
@@ -4573,6 +4583,14 @@ pointer_from_offset_skipping_decomp (const char *str,
   while (offset > 0)
     {
       q = g_utf8_next_char (p);
+
+      if ((guchar) *p < 0x80)
+        {
+          offset -= 1;
+          p = q;
+          continue;
+        }
+
       casefold = g_utf8_casefold (p, q - p);
       normal = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
       offset -= g_utf8_strlen (normal, -1);
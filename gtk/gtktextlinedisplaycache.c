@@ -24,8 +24,11 @@
 #include "gtktextiterprivate.h"
 #include "gtktextlinedisplaycacheprivate.h"
 #include "gtkprivate.h"
+#include "gdkprofilerprivate.h"
 
 #define DEFAULT_MRU_SIZE         250
+#define MAX_MRU_GROWTH           4
+#define ADAPT_WINDOW             128
 #define BLOW_CACHE_TIMEOUT_SEC   20
 #define DEBUG_LINE_DISPLAY_CACHE 0
 
@@ -37,6 +40,14 @@ struct _GtkTextLineDisplayCache
   GQueue       mru;
   GSource     *evict_source;
   guint        mru_size;
+  guint        base_mru_size;
+
+  /* Lookups, misses and evictions since we last
+   * considered growing the cache.
+   */
+  guint        window_lookups;
+  guint        window_misses;
+  guint        window_evictions;
 
 #if DEBUG_LINE_DISPLAY_CACHE
   guint       log_source;
@@ -53,6 +64,12 @@ struct _GtkTextLineDisplayCache
 static GQueue purge_in_idle;
 static guint purge_in_idle_source;
 
+static guint hits_counter;
+static guint misses_counter;
+static guint size_counter;
+static gint64 total_hits;
+static gint64 total_misses;
+
 #if DEBUG_LINE_DISPLAY_CACHE
 # define STAT_ADD(val,n) ((val) += n)
 # define STAT_INC(val)   STAT_ADD(val,1)
@@ -84,6 +101,14 @@ gtk_text_line_display_cache_new (void)
   ret->sorted_by_line = g_sequence_new (NULL);
   ret->line_to_display = g_hash_table_new (NULL, NULL);
   ret->mru_size = DEFAULT_MRU_SIZE;
+  ret->base_mru_size = DEFAULT_MRU_SIZE;
+
+  if (hits_counter == 0)
+    {
+      hits_counter = gdk_profiler_define_int_counter ("line-display-hits", "Line display cache hits");
+      misses_counter = gdk_profiler_define_int_counter ("line-display-misses", "Line display cache misses");
+      size_counter = gdk_profiler_define_int_counter ("line-display-cache-size", "Line display cache capacity");
+    }
 
 #if DEBUG_LINE_DISPLAY_CACHE
   ret->log_source = g_timeout_add_seconds (1, dump_stats, ret);
@@ -124,6 +149,14 @@ gtk_text_line_display_cache_blow_cb (gpointer data)
 
   gtk_text_line_display_cache_invalidate (cache);
 
+  /* Nobody has been looking at lines for a while,
+   * so drop whatever we grew for scrolling.
+   */
+  cache->mru_size = cache->base_mru_size;
+  cache->window_lookups = 0;
+  cache->window_misses = 0;
+  cache->window_evictions = 0;
+
   return G_SOURCE_REMOVE;
 }
 
@@ -213,9 +246,50 @@ gtk_text_line_display_cache_take_display (GtkTextLineDisplayCache *cache,
       display = g_queue_peek_tail (&cache->mru);
 
       gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
+
+      cache->window_evictions++;
     }
 }
 
+/*
+ * The view sizes the cache from the number of lines that fit on
+ * screen, which is too small when scrolling back and forth quickly:
+ * lines get evicted and then shaped again a moment later. If most
+ * lookups over the last window missed while we were evicting, grow
+ * the cache (up to a limit). It shrinks back to the base size when
+ * the cache is blown after being idle.
+ */
+static void
+gtk_text_line_display_cache_adapt (GtkTextLineDisplayCache *cache,
+                                   gboolean                 hit)
+{
+  cache->window_lookups++;
+
+  if (hit)
+    total_hits++;
+  else
+    {
+      total_misses++;
+      cache->window_misses++;
+    }
+
+  if (cache->window_lookups < ADAPT_WINDOW)
+    return;
+
+  if (cache->window_evictions > 0 &&
+      cache->window_misses > cache->window_lookups / 2 &&
+      cache->mru_size < cache->base_mru_size * MAX_MRU_GROWTH)
+    cache->mru_size = MIN (cache->mru_size * 2, cache->base_mru_size * MAX_MRU_GROWTH);
+
+  cache->window_lookups = 0;
+  cache->window_misses = 0;
+  cache->window_evictions = 0;
+
+  gdk_profiler_set_int_counter (hits_counter, total_hits);
+  gdk_profiler_set_int_counter (misses_counter, total_misses);
+  gdk_profiler_set_int_counter (size_counter, cache->mru_size);
+}
+
 static gboolean
 purge_text_line_display_in_idle (gpointer data)
 {
@@ -342,6 +416,7 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
       if (size_only || !display->size_only)
         {
           STAT_INC (cache->hits);
+          gtk_text_line_display_cache_adapt (cache, TRUE);
 
           if (!size_only && display->line == cache->cursor_line)
             gtk_text_layout_update_display_cursors (layout, display->line, display);
@@ -364,6 +439,7 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
     }
 
   STAT_INC (cache->misses);
+  gtk_text_line_display_cache_adapt (cache, FALSE);
 
   g_assert (!g_hash_table_lookup (cache->line_to_display, line));
 
@@ -801,8 +877,9 @@ gtk_text_line_display_cache_set_mru_size (GtkTextLineDisplayCache *cache,
   if (mru_size == 0)
     mru_size = DEFAULT_MRU_SIZE;
 
-  if (mru_size != cache->mru_size)
+  if (mru_size != cache->base_mru_size)
     {
+      cache->base_mru_size = mru_size;
       cache->mru_size = mru_size;
 
       while (cache->mru.length > cache->mru_size)
@@ -813,3 +890,22 @@ gtk_text_line_display_cache_set_mru_size (GtkTextLineDisplayCache *cache,
         }
     }
 }
+
+/* The current capacity, which can be larger than
+ * the size that was set while scrolling quickly
+ */
+guint
+gtk_text_line_display_cache_get_mru_size (GtkTextLineDisplayCache *cache)
+{
+  g_assert (cache != NULL);
+
+  return cache->mru_size;
+}
+
+guint
+gtk_text_line_display_cache_get_n_displays (GtkTextLineDisplayCache *cache)
+{
+  g_assert (cache != NULL);
+
+  return cache->mru.length;
+}
@@ -55,6 +55,8 @@ void                     gtk_text_line_display_cache_invalidate_y_range (GtkText
                                                                          gboolean                 cursors_only);
 void                     gtk_text_line_display_cache_set_mru_size       (GtkTextLineDisplayCache *cache,
                                                                          guint                    mru_size);
+guint                    gtk_text_line_display_cache_get_mru_size       (GtkTextLineDisplayCache *cache);
+guint                    gtk_text_line_display_cache_get_n_displays     (GtkTextLineDisplayCache *cache);
 
 G_END_DECLS
 
@@ -656,6 +656,12 @@ static GQuark           quark_font_options = 0;
 static GQuark           quark_font_map = 0;
 static GQuark           quark_builder_set_id = 0;
 
+/* Snapshot statistics for the profiler */
+static guint            snapshot_widgets_counter;
+static guint            reused_widgets_counter;
+static guint            snapshot_widgets;
+static guint            reused_widgets;
+
 GType
 gtk_widget_get_type (void)
 {
@@ -1190,6 +1196,9 @@ gtk_widget_class_init (GtkWidgetClass *klass)
   quark_font_options = g_quark_from_static_string ("gtk-widget-font-options");
   quark_font_map = g_quark_from_static_string ("gtk-widget-font-map");
 
+  snapshot_widgets_counter = gdk_profiler_define_int_counter ("snapshot-widgets", "Widgets snapshotted per frame");
+  reused_widgets_counter = gdk_profiler_define_int_counter ("reused-widgets", "Widget render nodes reused per frame");
+
   gobject_class->constructed = gtk_widget_constructed;
   gobject_class->dispose = gtk_widget_dispose;
   gobject_class->finalize = gtk_widget_finalize;
@@ -3518,6 +3527,7 @@ gtk_widget_queue_draw (GtkWidget *widget)
 
       priv->draw_needed = TRUE;
       g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+      g_clear_pointer (&priv->transform_node, gsk_render_node_unref);
       if (GTK_IS_NATIVE (widget) && _gtk_widget_get_realized (widget))
         gdk_surface_queue_render (gtk_native_get_surface (GTK_NATIVE (widget)));
     }
@@ -7684,6 +7694,8 @@ gtk_widget_finalize (GObject *object)
 
   g_clear_pointer (&priv->transform, gsk_transform_unref);
   g_clear_pointer (&priv->allocated_transform, gsk_transform_unref);
+  g_clear_pointer (&priv->transform_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->render_node, gsk_render_node_unref);
 
   gtk_css_widget_node_widget_destroyed (GTK_CSS_WIDGET_NODE (priv->cssnode));
   g_object_unref (priv->cssnode);
@@ -11925,7 +11937,10 @@ gtk_widget_do_snapshot (GtkWidget   *widget,
   GskRenderNode *render_node;
 
   if (!priv->draw_needed)
-    return;
+    {
+      reused_widgets++;
+      return;
+    }
 
   g_assert (priv->mapped);
 
@@ -11942,9 +11957,11 @@ gtk_widget_do_snapshot (GtkWidget   *widget,
    * or when we replace a clipped area
    */
   g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->transform_node, gsk_render_node_unref);
   priv->render_node = render_node;
 
   priv->draw_needed = FALSE;
+  snapshot_widgets++;
 
   gtk_widget_pop_paintables (widget);
   gtk_widget_update_paintables (widget);
@@ -11998,8 +12015,13 @@ gtk_widget_render (GtkWidget            *widget,
     {
       before_render = GDK_PROFILER_CURRENT_TIME;
       gdk_profiler_add_mark (before_snapshot, (before_render - before_snapshot), "Widget snapshot", "");
+      gdk_profiler_set_int_counter (snapshot_widgets_counter, snapshot_widgets);
+      gdk_profiler_set_int_counter (reused_widgets_counter, reused_widgets);
     }
 
+  snapshot_widgets = 0;
+  reused_widgets = 0;
+
   if (root != NULL)
     {
       root = gtk_inspector_prepare_render (widget,
@@ -12365,11 +12387,18 @@ gtk_widget_snapshot_child (GtkWidget   *widget,
 
   if (priv->transform)
     {
-      GskRenderNode *transform_node = gsk_transform_node_new (priv->render_node,
-                                                              priv->transform);
+      /* The transform is recreated on every allocation, so keep the
+       * node around if it didn't change. That way the parent's node
+       * shares the subtree with the previous frame.
+       */
+      if (priv->transform_node == NULL ||
+          !gsk_transform_equal (gsk_transform_node_get_transform (priv->transform_node), priv->transform))
+        {
+          g_clear_pointer (&priv->transform_node, gsk_render_node_unref);
+          priv->transform_node = gsk_transform_node_new (priv->render_node, priv->transform);
+        }
 
-      gtk_snapshot_append_node (snapshot, transform_node);
-      gsk_render_node_unref (transform_node);
+      gtk_snapshot_append_node (snapshot, priv->transform_node);
     }
   else
     {
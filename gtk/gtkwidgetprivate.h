@@ -166,6 +166,9 @@ struct _GtkWidgetPrivate
 
   /* The render node we draw or %NULL if not yet created.*/
   GskRenderNode *render_node;
+  /* @render_node with @transform applied, as last appended to the
+   * parent's snapshot, or %NULL */
+  GskRenderNode *transform_node;
 
   /* The layout manager, or %NULL */
   GtkLayoutManager *layout_manager;
@@ -5,6 +5,8 @@
 #include <gdk/gdkglcontextprivate.h>
 #include <gdk/gdkdmabuffourccprivate.h>
 #include <gdk/gdkdmabuftextureprivate.h>
+#include <gdk/gdkdmabufprivate.h>
+#include <gdk/gdkmemoryformatprivate.h>
 
 static void
 test_dmabuf_formats_basic (void)
@@ -82,6 +84,114 @@ test_dmabuf_formats_builder (void)
   gdk_dmabuf_formats_unref (formats1);
 }
 
+#ifdef HAVE_DMABUF
+static guchar *
+download_planes (const GdkDmabuf *dmabuf,
+                 const guchar    *src_data[GDK_DMABUF_MAX_PLANES],
+                 gsize            sizes[GDK_DMABUF_MAX_PLANES],
+                 GdkMemoryFormat  format,
+                 gsize            width,
+                 gsize            height,
+                 gsize            band_height)
+{
+  gsize stride;
+  guchar *data;
+
+  stride = width * gdk_memory_format_bytes_per_pixel (format);
+  data = g_malloc0 (stride * height);
+
+  gdk_dmabuf_download_planes (dmabuf, src_data, sizes, format, width, height, band_height, data, stride);
+
+  return data;
+}
+#endif
+
+static void
+test_dmabuf_yuv_bands (void)
+{
+#ifdef HAVE_DMABUF
+  struct {
+    guint32 fourcc;
+    gsize bpc;
+    gsize n_planes;
+    gsize x_sub;
+    gsize y_sub;
+  } formats[] = {
+    { DRM_FORMAT_NV12, 1, 2, 2, 2 },
+    { DRM_FORMAT_YUV420, 1, 3, 2, 2 },
+    { DRM_FORMAT_YUV410, 1, 3, 4, 4 },
+    { DRM_FORMAT_P010, 2, 2, 2, 2 },
+  };
+  /* Heights that are not a multiple of the band height, an odd one among them */
+  gsize heights[] = { 64, 202, 203 };
+  const gsize width = 37;
+  gsize i, j, k, p;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    {
+      for (j = 0; j < G_N_ELEMENTS (heights); j++)
+        {
+          GdkDmabuf dmabuf = { .fourcc = formats[i].fourcc, .n_planes = formats[i].n_planes };
+          const guchar *src_data[GDK_DMABUF_MAX_PLANES];
+          gsize sizes[GDK_DMABUF_MAX_PLANES];
+          guchar *planes[GDK_DMABUF_MAX_PLANES];
+          GdkMemoryFormat format;
+          guchar *single, *banded;
+          gsize height = heights[j];
+
+          g_assert_true (gdk_dmabuf_get_memory_format (formats[i].fourcc, FALSE, &format));
+
+          for (p = 0; p < formats[i].n_planes; p++)
+            {
+              gsize plane_width, plane_height;
+
+              if (p == 0)
+                {
+                  plane_width = width;
+                  plane_height = height;
+                }
+              else
+                {
+                  plane_width = (width + formats[i].x_sub - 1) / formats[i].x_sub;
+                  plane_height = (height + formats[i].y_sub - 1) / formats[i].y_sub;
+                  /* Interleaved U and V */
+                  if (formats[i].n_planes == 2)
+                    plane_width *= 2;
+                }
+
+              dmabuf.planes[p].fd = -1;
+              dmabuf.planes[p].stride = plane_width * formats[i].bpc;
+              dmabuf.planes[p].offset = 0;
+              sizes[p] = dmabuf.planes[p].stride * plane_height;
+              planes[p] = g_malloc (sizes[p]);
+              for (k = 0; k < sizes[p]; k++)
+                planes[p][k] = g_test_rand_int_range (0, 256);
+              src_data[p] = planes[p];
+            }
+
+          single = download_planes (&dmabuf, src_data, sizes, format, width, height, 0);
+
+          banded = download_planes (&dmabuf, src_data, sizes, format, width, height, 64);
+          g_assert_cmpmem (single, width * height * gdk_memory_format_bytes_per_pixel (format),
+                           banded, width * height * gdk_memory_format_bytes_per_pixel (format));
+          g_free (banded);
+
+          /* Many bands, so a chroma row per band boundary is hit often */
+          banded = download_planes (&dmabuf, src_data, sizes, format, width, height, 8);
+          g_assert_cmpmem (single, width * height * gdk_memory_format_bytes_per_pixel (format),
+                           banded, width * height * gdk_memory_format_bytes_per_pixel (format));
+          g_free (banded);
+
+          g_free (single);
+          for (p = 0; p < formats[i].n_planes; p++)
+            g_free (planes[p]);
+        }
+    }
+#else
+  g_test_skip ("dmabuf support disabled");
+#endif
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -89,6 +199,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/dmabuf/formats/basic", test_dmabuf_formats_basic);
   g_test_add_func ("/dmabuf/formats/builder", test_dmabuf_formats_builder);
+  g_test_add_func ("/dmabuf/yuv-bands", test_dmabuf_yuv_bands);
 
   return g_test_run ();
 }
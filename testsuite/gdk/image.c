@@ -2,6 +2,8 @@
 #include "gdk/loaders/gdkpngprivate.h"
 #include "gdk/loaders/gdktiffprivate.h"
 #include "gdk/loaders/gdkjpegprivate.h"
+#include "gdk/gdktiledtextureprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 
 static void
 assert_texture_equal (GdkTexture *t1,
@@ -68,6 +70,101 @@ test_load_image (gconstpointer data)
   g_free (path);
 }
 
+static void
+test_load_jpeg_at_size (void)
+{
+  GdkTexture *texture;
+  char *path;
+  GFile *file;
+  GBytes *bytes;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.jpeg", NULL);
+  file = g_file_new_for_path (path);
+  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  texture = gdk_load_jpeg_at_size (bytes, 8, 8, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 8);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 8);
+  g_object_unref (texture);
+
+  /* Never smaller than requested */
+  texture = gdk_load_jpeg_at_size (bytes, 10, 10, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 16);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 16);
+  g_object_unref (texture);
+
+  texture = gdk_load_jpeg_at_size (bytes, 64, 64, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 32);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 32);
+  g_object_unref (texture);
+
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+  g_free (path);
+}
+
+static void
+test_load_jpeg_tiled (gconstpointer data)
+{
+  const char *filename = data;
+  GdkTexture *texture, *tiled, *tile, *expected;
+  char *path;
+  GFile *file;
+  GBytes *bytes;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", filename, NULL);
+  file = g_file_new_for_path (path);
+  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  texture = gdk_load_jpeg (bytes, &error);
+  g_assert_no_error (error);
+
+  tiled = gdk_load_jpeg_tiled (bytes, &error);
+  g_assert_no_error (error);
+  g_assert_true (GDK_IS_TILED_TEXTURE (tiled));
+  g_assert_cmpint (gdk_texture_get_format (tiled), ==, gdk_texture_get_format (texture));
+
+  /* Downloading loads everything at full size */
+  assert_texture_equal (texture, tiled);
+
+  /* An area at full size */
+  tile = gdk_tiled_texture_load (GDK_TILED_TEXTURE (tiled), 0, &(cairo_rectangle_int_t) { 8, 4, 16, 20 });
+  g_assert_nonnull (tile);
+  expected = gdk_memory_texture_new_subtexture (GDK_MEMORY_TEXTURE (texture), 8, 4, 16, 20);
+  assert_texture_equal (expected, tile);
+  g_object_unref (expected);
+  g_object_unref (tile);
+
+  /* Reduced levels are decoded at reduced size */
+  g_object_unref (texture);
+  texture = gdk_load_jpeg_at_size (bytes, 16, 16, &error);
+  g_assert_no_error (error);
+  tile = gdk_tiled_texture_load (GDK_TILED_TEXTURE (tiled), 1, &(cairo_rectangle_int_t) { 0, 0, 32, 32 });
+  g_assert_nonnull (tile);
+  assert_texture_equal (texture, tile);
+  g_object_unref (tile);
+
+  /* Beyond what the decoder can do, the rest is filtered */
+  tile = gdk_tiled_texture_load (GDK_TILED_TEXTURE (tiled), 4, &(cairo_rectangle_int_t) { 0, 0, 32, 32 });
+  g_assert_nonnull (tile);
+  g_assert_cmpint (gdk_texture_get_width (tile), ==, 2);
+  g_assert_cmpint (gdk_texture_get_height (tile), ==, 2);
+  g_object_unref (tile);
+
+  g_object_unref (tiled);
+  g_object_unref (texture);
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+  g_free (path);
+}
+
 static void
 test_save_image (gconstpointer test_data)
 {
@@ -117,6 +214,31 @@ test_save_image (gconstpointer test_data)
   g_free (path);
 }
 
+static void
+test_save_png_fast (void)
+{
+  char *path;
+  GdkTexture *texture;
+  GdkTexture *texture2;
+  GError *error = NULL;
+  GBytes *bytes;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.png", NULL);
+  texture = gdk_texture_new_from_filename (path, &error);
+  g_assert_no_error (error);
+
+  bytes = gdk_save_png_fast (texture);
+  texture2 = gdk_load_png (bytes, NULL, &error);
+  g_assert_no_error (error);
+
+  assert_texture_equal (texture, texture2);
+
+  g_bytes_unref (bytes);
+  g_object_unref (texture2);
+  g_object_unref (texture);
+  g_free (path);
+}
+
 static void
 test_load_image_fail (gconstpointer data)
 {
@@ -169,9 +291,15 @@ main (int argc, char *argv[])
      g_free (test);
    }
 
+  g_test_add_func ("/image/load/jpeg-at-size", test_load_jpeg_at_size);
+  g_test_add_data_func ("/image/load/jpeg-tiled/image.jpeg", "image.jpeg", test_load_jpeg_tiled);
+  g_test_add_data_func ("/image/load/jpeg-tiled/image-gray.jpeg", "image-gray.jpeg", test_load_jpeg_tiled);
+  g_test_add_data_func ("/image/load/jpeg-tiled/image-cmyk.jpeg", "image-cmyk.jpeg", test_load_jpeg_tiled);
+
   g_test_add_data_func ("/image/save/image.png", "image.png", test_save_image);
   g_test_add_data_func ("/image/save/image.tiff", "image.tiff", test_save_image);
   g_test_add_data_func ("/image/save/image.jpeg", "image.jpeg", test_save_image);
+  g_test_add_func ("/image/save/png-fast", test_save_png_fast);
 
   return g_test_run ();
 }
@@ -42,7 +42,7 @@ test_subsurface_basics (void)
   g_assert_true (gdk_subsurface_get_transform (sub) == GDK_DIHEDRAL_NORMAL);
 
   texture = gdk_texture_new_from_resource ("/org/gtk/libgtk/icons/16x16/actions/media-eject.png");
-  gdk_subsurface_attach (sub, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_90, &GRAPHENE_RECT_INIT (0, 0, 20, 20), TRUE, NULL);
+  gdk_subsurface_attach (sub, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_90, &GRAPHENE_RECT_INIT (0, 0, 20, 20), NULL, TRUE, NULL);
 
   g_assert_true (gdk_subsurface_get_texture (sub) == texture);
   g_assert_true (gdk_subsurface_is_above_parent (sub));
@@ -90,9 +90,9 @@ test_subsurface_stacking (void)
 
   texture = gdk_texture_new_from_resource ("/org/gtk/libgtk/icons/16x16/actions/media-eject.png");
 
-  gdk_subsurface_attach (sub0, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, TRUE, NULL);
-  gdk_subsurface_attach (sub1, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, TRUE, NULL);
-  gdk_subsurface_attach (sub2, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, TRUE, NULL);
+  gdk_subsurface_attach (sub0, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, NULL, TRUE, NULL);
+  gdk_subsurface_attach (sub1, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, NULL, TRUE, NULL);
+  gdk_subsurface_attach (sub2, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, NULL, TRUE, NULL);
 
   g_assert_true (surface->subsurfaces_above == sub2);
   g_assert_true (sub2->sibling_below == NULL);
@@ -115,7 +115,7 @@ test_subsurface_stacking (void)
   g_assert_true (sub0->sibling_above == NULL);
   g_assert_true (sub0->above_parent);
 
-  gdk_subsurface_attach (sub2, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, FALSE, NULL);
+  gdk_subsurface_attach (sub2, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, NULL, FALSE, NULL);
 
   g_assert_true (surface->subsurfaces_above == sub0);
   g_assert_true (sub0->sibling_below == NULL);
@@ -127,7 +127,7 @@ test_subsurface_stacking (void)
   g_assert_true (sub2->sibling_above == NULL);
   g_assert_false (sub2->above_parent);
 
-  gdk_subsurface_attach (sub1, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, TRUE, sub2);
+  gdk_subsurface_attach (sub1, texture, &TEXTURE_RECT (texture), &GRAPHENE_RECT_INIT (0, 0, 10, 10), GDK_DIHEDRAL_NORMAL, NULL, NULL, TRUE, sub2);
 
   g_assert_true (surface->subsurfaces_below == sub1);
   g_assert_true (sub1->sibling_above == NULL);
@@ -2,6 +2,7 @@
 
 #include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdktiledtextureprivate.h"
 
 
 #define assert_texture_diff_equal(a, b, expected) G_STMT_START { \
@@ -448,6 +449,55 @@ test_texture_downloader (void)
   g_object_unref (texture);
 }
 
+static GdkTexture *
+load_red_tile (GdkTiledTexture             *texture,
+               guint                        lod_level,
+               const cairo_rectangle_int_t *area,
+               gpointer                     data)
+{
+  guint *n_loads = data;
+
+  (*n_loads)++;
+
+  return red_texture_new ((area->width + (1 << lod_level) - 1) >> lod_level,
+                          (area->height + (1 << lod_level) - 1) >> lod_level);
+}
+
+static void
+test_texture_tiled (void)
+{
+  GdkTexture *texture, *red, *tile;
+  guint n_loads = 0;
+
+  texture = gdk_tiled_texture_new (300, 600,
+                                   GDK_MEMORY_R8G8B8A8,
+                                   GDK_COLOR_STATE_SRGB,
+                                   load_red_tile,
+                                   &n_loads,
+                                   NULL);
+
+  /* Loading a tile only loads that tile */
+  tile = gdk_tiled_texture_load (GDK_TILED_TEXTURE (texture), 0, &(cairo_rectangle_int_t) { 256, 512, 256, 256 });
+  g_assert_cmpint (n_loads, ==, 1);
+  g_assert_cmpint (gdk_texture_get_width (tile), ==, 44);
+  g_assert_cmpint (gdk_texture_get_height (tile), ==, 88);
+  g_object_unref (tile);
+
+  tile = gdk_tiled_texture_load (GDK_TILED_TEXTURE (texture), 2, &(cairo_rectangle_int_t) { 0, 0, 301, 601 });
+  g_assert_cmpint (n_loads, ==, 2);
+  g_assert_cmpint (gdk_texture_get_width (tile), ==, 75);
+  g_assert_cmpint (gdk_texture_get_height (tile), ==, 150);
+  g_object_unref (tile);
+
+  /* Downloading the whole texture assembles it from bands */
+  red = red_texture_new (300, 600);
+  compare_textures (texture, red);
+  g_assert_cmpint (n_loads, >, 2);
+
+  g_object_unref (red);
+  g_object_unref (texture);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -464,6 +514,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/texture/icon/serialize", test_texture_icon_serialize);
   g_test_add_func ("/texture/diff", test_texture_diff);
   g_test_add_func ("/texture/downloader", test_texture_downloader);
+  g_test_add_func ("/texture/tiled", test_texture_tiled);
 
   return g_test_run ();
 }
@@ -95,6 +95,91 @@ test_can_diff_transform (void)
   gsk_transform_unref (t2);
 }
 
+static GskRenderNode *
+create_tree (float red)
+{
+  GskRenderNode *color, *clip, *transform;
+  GskTransform *t;
+
+  color = gsk_color_node_new (&(GdkRGBA){ red, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  clip = gsk_clip_node_new (color, &GRAPHENE_RECT_INIT (0, 0, 5, 5));
+  t = gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (10, 10));
+  transform = gsk_transform_node_new (clip, t);
+
+  gsk_transform_unref (t);
+  gsk_render_node_unref (clip);
+  gsk_render_node_unref (color);
+
+  return transform;
+}
+
+static void
+test_hash_equal (void)
+{
+  GskRenderNode *tree1, *tree2, *tree3;
+
+  tree1 = create_tree (0);
+  tree2 = create_tree (0);
+  tree3 = create_tree (1);
+
+  /* Trees created independently compare equal */
+  g_assert_cmpuint (gsk_render_node_get_hash (tree1), ==, gsk_render_node_get_hash (tree2));
+  g_assert_true (gsk_render_node_equal (tree1, tree2));
+
+  /* A change deep in the tree changes the hash */
+  g_assert_cmpuint (gsk_render_node_get_hash (tree1), !=, gsk_render_node_get_hash (tree3));
+  g_assert_false (gsk_render_node_equal (tree1, tree3));
+
+  gsk_render_node_unref (tree1);
+  gsk_render_node_unref (tree2);
+  gsk_render_node_unref (tree3);
+}
+
+#define N_CHILDREN 50
+
+static GskRenderNode *
+create_child (guint i)
+{
+  return gsk_color_node_new (&(GdkRGBA){ 0, 0, i / (float) N_CHILDREN, 1 },
+                             &GRAPHENE_RECT_INIT (i * 10, 0, 10, 10));
+}
+
+static void
+test_diff_insert (void)
+{
+  GskRenderNode *children[N_CHILDREN];
+  GskRenderNode *container1, *container2;
+  cairo_region_t *region;
+  guint i;
+
+  for (i = 0; i < N_CHILDREN; i++)
+    children[i] = create_child (i);
+  container1 = gsk_container_node_new (children, N_CHILDREN);
+  for (i = 0; i < N_CHILDREN; i++)
+    gsk_render_node_unref (children[i]);
+
+  /* Recreate the children, insert one in front and drop the last one */
+  children[0] = gsk_color_node_new (&(GdkRGBA){ 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 20, 10, 10));
+  for (i = 0; i < N_CHILDREN - 1; i++)
+    children[i + 1] = create_child (i);
+  container2 = gsk_container_node_new (children, N_CHILDREN);
+  for (i = 0; i < N_CHILDREN; i++)
+    gsk_render_node_unref (children[i]);
+
+  region = cairo_region_create ();
+  gsk_render_node_diff (container1, container2, &(GskDiffData) { region, NULL });
+
+  /* Only the inserted and the removed child get damaged */
+  g_assert_cmpint (cairo_region_num_rectangles (region), ==, 2);
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 0, 20, 10, 10 }) == CAIRO_REGION_OVERLAP_IN);
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { (N_CHILDREN - 1) * 10, 0, 10, 10 }) == CAIRO_REGION_OVERLAP_IN);
+  g_assert_false (cairo_region_contains_point (region, 5, 5));
+
+  cairo_region_destroy (region);
+  gsk_render_node_unref (container1);
+  gsk_render_node_unref (container2);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -103,6 +188,8 @@ main (int   argc,
 
   g_test_add_func ("/node/can-diff/basic", test_can_diff_basic);
   g_test_add_func ("/node/can-diff/transform", test_can_diff_transform);
+  g_test_add_func ("/node/hash/equal", test_hash_equal);
+  g_test_add_func ("/node/diff/insert", test_diff_insert);
 
   return g_test_run ();
 }
@@ -0,0 +1,198 @@
+#include <gtk/gtk.h>
+
+#include "gsk/gpu/gskgpucacheprivate.h"
+#include "gsk/gpu/gskgpudeviceprivate.h"
+#include "gsk/gpu/gskgpuimageprivate.h"
+#include "gsk/gpu/gskgpurendererprivate.h"
+
+#define N_ITEMS 8
+#define ITEM_SIZE 64
+
+struct {
+  const char *name;
+  GskRenderer * (*create_func) (void);
+  GskRenderer *renderer;
+} renderers[] = {
+  {
+    "vulkan",
+    gsk_vulkan_renderer_new,
+  },
+  {
+    "ngl",
+    gsk_ngl_renderer_new,
+  },
+};
+
+static GdkTexture *
+create_texture (void)
+{
+  GBytes *bytes;
+  GdkTexture *texture;
+
+  bytes = g_bytes_new_take (g_malloc0 (ITEM_SIZE * ITEM_SIZE * 4), ITEM_SIZE * ITEM_SIZE * 4);
+  texture = gdk_memory_texture_new (ITEM_SIZE, ITEM_SIZE,
+                                    GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
+                                    bytes,
+                                    ITEM_SIZE * 4);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static gboolean
+is_cached (GskGpuCache *cache,
+           GdkTexture  *texture)
+{
+  GskGpuImage *image;
+
+  image = gsk_gpu_cache_lookup_texture_image (cache, texture, NULL);
+  if (image == NULL)
+    return FALSE;
+
+  g_object_unref (image);
+  return TRUE;
+}
+
+static void
+test_budget (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  GskGpuDevice *device;
+  GskGpuCache *cache;
+  GdkTexture *textures[N_ITEMS];
+  gsize item_memory = 0;
+  guint i;
+
+  device = gsk_gpu_renderer_get_device (GSK_GPU_RENDERER (renderer));
+  gsk_gpu_device_make_current (device);
+
+  /* Use our own cache, so the renderer's items don't get in the way */
+  cache = gsk_gpu_cache_new (device);
+  g_assert_cmpuint (gsk_gpu_cache_get_memory (cache), ==, 0);
+
+  /* Fill the cache without a budget, with one item per frame */
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      GskGpuImage *image;
+
+      gsk_gpu_cache_set_time (cache, (i + 1) * G_TIME_SPAN_MILLISECOND);
+
+      textures[i] = create_texture ();
+      image = gsk_gpu_device_create_upload_image (device,
+                                                  FALSE,
+                                                  GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
+                                                  FALSE,
+                                                  ITEM_SIZE, ITEM_SIZE);
+      gsk_gpu_cache_cache_texture_image (cache, textures[i], image, NULL);
+      g_object_unref (image);
+
+      if (i == 0)
+        item_memory = gsk_gpu_cache_get_memory (cache);
+
+      g_assert_cmpuint (item_memory, >=, ITEM_SIZE * ITEM_SIZE);
+      g_assert_cmpuint (gsk_gpu_cache_get_memory (cache), ==, (i + 1) * item_memory);
+    }
+
+  g_assert_false (gsk_gpu_cache_is_over_budget (cache));
+
+  /* The timeout is long enough that only the budget frees items */
+  gsk_gpu_cache_gc (cache, G_TIME_SPAN_HOUR, gsk_gpu_cache_get_time (cache));
+  g_assert_cmpuint (gsk_gpu_cache_get_memory (cache), ==, N_ITEMS * item_memory);
+
+  gsk_gpu_cache_set_budget (cache, 4 * item_memory);
+  g_assert_true (gsk_gpu_cache_is_over_budget (cache));
+
+  /* Evicts the oldest items until 3/4 of the budget are used */
+  gsk_gpu_cache_gc (cache, G_TIME_SPAN_HOUR, gsk_gpu_cache_get_time (cache));
+  g_assert_false (gsk_gpu_cache_is_over_budget (cache));
+  g_assert_cmpuint (gsk_gpu_cache_get_memory (cache), ==, 3 * item_memory);
+
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      if (i < N_ITEMS - 3)
+        g_assert_false (is_cached (cache, textures[i]));
+      else
+        g_assert_true (is_cached (cache, textures[i]));
+    }
+
+  /* Items used in the current frame are never evicted,
+   * even if that means staying over the budget
+   */
+  gsk_gpu_cache_set_budget (cache, 1);
+  gsk_gpu_cache_gc (cache, G_TIME_SPAN_HOUR, gsk_gpu_cache_get_time (cache));
+  g_assert_cmpuint (gsk_gpu_cache_get_memory (cache), ==, 3 * item_memory);
+
+  gsk_gpu_cache_set_time (cache, (N_ITEMS + 1) * G_TIME_SPAN_MILLISECOND);
+  g_assert_true (is_cached (cache, textures[N_ITEMS - 1]));
+  gsk_gpu_cache_gc (cache, G_TIME_SPAN_HOUR, gsk_gpu_cache_get_time (cache));
+  g_assert_cmpuint (gsk_gpu_cache_get_memory (cache), ==, item_memory);
+  g_assert_true (is_cached (cache, textures[N_ITEMS - 1]));
+
+  g_object_unref (cache);
+  for (i = 0; i < N_ITEMS; i++)
+    g_object_unref (textures[i]);
+}
+
+static void
+create_renderers (void)
+{
+  GError *error = NULL;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      renderers[i].renderer = renderers[i].create_func ();
+      if (!gsk_renderer_realize_for_display (renderers[i].renderer, gdk_display_get_default (), &error))
+        {
+          g_test_message ("Could not realize %s renderer: %s", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_clear_object (&renderers[i].renderer);
+        }
+    }
+}
+
+static void
+destroy_renderers (void)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      gsk_renderer_unrealize (renderers[i].renderer);
+      g_clear_object (&renderers[i].renderer);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int result;
+  gsize i;
+
+  gtk_test_init (&argc, &argv, NULL);
+  create_renderers ();
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      char *test_name;
+
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      test_name = g_strdup_printf ("/gpu-cache/budget/%s", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_budget);
+      g_free (test_name);
+    }
+
+  result = g_test_run ();
+
+  /* So the context gets actually destroyed */
+  gdk_gl_context_clear_current ();
+
+  destroy_renderers ();
+
+  return result;
+}
@@ -1,7 +1,9 @@
 #include <gtk/gtk.h>
 #include "gsk/gskrendernodeprivate.h"
+#include "gsk/gskrendernodeparserprivate.h"
 
 #include <gobject/gvaluecollector.h>
+#include <math.h>
 
 static void
 test_rendernode_gvalue (void)
@@ -149,6 +151,379 @@ test_container_disjoint (void)
   gsk_render_node_unref (nodes[1]);
 }
 
+static void
+test_container_children_in_rect (void)
+{
+  GskRenderNode *node, *nodes[1000];
+  const graphene_rect_t rects[] = {
+    GRAPHENE_RECT_INIT (0, 0, 10, 10),
+    GRAPHENE_RECT_INIT (95, 3, 20, 500),
+    GRAPHENE_RECT_INIT (-100, -100, 50, 50),
+    GRAPHENE_RECT_INIT (400, 190, 1, 1),
+    GRAPHENE_RECT_INIT (0, 0, 1000, 1000),
+  };
+  guint i, j, k;
+
+  /* A grid of 25 columns, so that blocks of children have varying shapes */
+  for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+    nodes[i] = gsk_color_node_new (&(GdkRGBA){0,1,1,1},
+                                   &GRAPHENE_RECT_INIT (i % 25 * 20, i / 25 * 20, 15, 15));
+  node = gsk_container_node_new (nodes, G_N_ELEMENTS (nodes));
+
+  for (j = 0; j < G_N_ELEMENTS (rects); j++)
+    {
+      k = gsk_container_node_get_next_child_in_rect (node, 0, &rects[j]);
+      for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+        {
+          graphene_rect_t bounds;
+
+          gsk_render_node_get_bounds (nodes[i], &bounds);
+          if (!graphene_rect_intersection (&bounds, &rects[j], NULL))
+            continue;
+
+          g_assert_cmpuint (k, ==, i);
+          k = gsk_container_node_get_next_child_in_rect (node, k + 1, &rects[j]);
+        }
+      g_assert_cmpuint (k, ==, G_N_ELEMENTS (nodes));
+    }
+
+  gsk_render_node_unref (node);
+  for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+    gsk_render_node_unref (nodes[i]);
+}
+
+static const char binary_node[] =
+  "@cicp \"cicp1\" { primaries: 1; transfer: 1; matrix: 0; }\n"
+  "color { bounds: 0 0 10 10; color: color(\"cicp1\" 1 0.5 0); }\n"
+  "transform { transform: rotate(30) translate(5, 5); child: clip { clip: 0 0 5 5; child: color { color: red; } } }\n"
+  "transform { transform: scale(2) translate(1, 2); child: blur { blur: 3; child: outset-shadow { outline: 0 0 50 50 / 5; } } }\n"
+  "border { outline: 0 0 20 20 / 3; colors: red green blue yellow; widths: 1 2 3 4; }\n"
+  "shadow { shadows: red 1 2 3, blue 2 2; child: text { font: \"Cantarell 15px\"; glyphs: \"Hello\"; } }\n"
+  "cross-fade { progress: 0.3; start: \"node1\" linear-gradient { stops: 0 red, 1 blue; } end: \"node1\"; }\n"
+  "fill { path: \"M 0 0 C 10 10 20 0 30 30 O 40 40 50 50 0.5 Z\"; child: radial-gradient { stops: 0 red, 1 blue; } }\n"
+  "stroke { path: \"M 0 0 L 10 10 Q 20 0 30 30\"; dash: 1 2; line-cap: round; child: repeat { child: inset-shadow { } } }\n"
+  "debug { message: \"hello\"; child: mask { mode: luminance; source: conic-gradient { } mask: opacity { } } }\n";
+
+static void
+count_errors (const GskParseLocation *start,
+              const GskParseLocation *end,
+              const GError           *error,
+              gpointer                user_data)
+{
+  guint *n_errors = user_data;
+
+  *n_errors += 1;
+}
+
+static void
+test_rendernode_serialize_binary (void)
+{
+  GskRenderNode *nodes[2], *node, *node2;
+  GdkTexture *texture;
+  GBytes *bytes, *text, *text2;
+  guint n_errors;
+  const guchar pixels[] = { 255, 0, 0, 255, 0, 255, 0, 128, 0, 0, 255, 0, 9, 9, 9, 9 };
+
+  bytes = g_bytes_new_static (binary_node, strlen (binary_node));
+  nodes[0] = gsk_render_node_deserialize (bytes, NULL, NULL);
+  g_assert_nonnull (nodes[0]);
+  g_bytes_unref (bytes);
+
+  bytes = g_bytes_new_static (pixels, sizeof (pixels));
+  texture = gdk_memory_texture_new (2, 2, GDK_MEMORY_R8G8B8A8, bytes, 8);
+  nodes[1] = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 20, 20));
+  g_object_unref (texture);
+  g_bytes_unref (bytes);
+
+  node = gsk_container_node_new (nodes, G_N_ELEMENTS (nodes));
+  gsk_render_node_unref (nodes[0]);
+  gsk_render_node_unref (nodes[1]);
+
+  bytes = gsk_render_node_serialize_binary (node);
+  g_assert_true (gsk_render_node_bytes_are_binary (bytes));
+  node2 = gsk_render_node_deserialize_binary (bytes, NULL, NULL);
+  g_assert_nonnull (node2);
+
+  /* The public API only accepts the text format */
+  n_errors = 0;
+  g_assert_null (gsk_render_node_deserialize (bytes, count_errors, &n_errors));
+  g_assert_cmpuint (n_errors, >, 0);
+
+  text = gsk_render_node_serialize (node);
+  text2 = gsk_render_node_serialize (node2);
+  g_assert_cmpmem (g_bytes_get_data (text, NULL), g_bytes_get_size (text),
+                   g_bytes_get_data (text2, NULL), g_bytes_get_size (text2));
+
+  g_bytes_unref (text);
+  g_bytes_unref (text2);
+  g_bytes_unref (bytes);
+  gsk_render_node_unref (node);
+  gsk_render_node_unref (node2);
+}
+
+static void
+test_rendernode_binary_truncated (void)
+{
+  const char *text =
+    "transform { transform: rotate(30); child: color { bounds: 0 0 10 10; color: red; } }\n"
+    "stroke { path: \"M 0 0 L 10 10\"; dash: 1 2; child: linear-gradient { stops: 0 red, 1 blue; } }\n"
+    "shadow { shadows: red 1 2 3; child: blur { blur: 2; child: color { } } }\n";
+  const guchar pixels[] = { 255, 0, 0, 255, 0, 255, 0, 128, 0, 0, 255, 0, 9, 9, 9, 9 };
+  GskRenderNode *nodes[2], *node;
+  GdkTexture *texture;
+  GBytes *bytes, *binary;
+  gsize i, size;
+
+  bytes = g_bytes_new_static (text, strlen (text));
+  nodes[0] = gsk_render_node_deserialize (bytes, NULL, NULL);
+  g_assert_nonnull (nodes[0]);
+  g_bytes_unref (bytes);
+
+  bytes = g_bytes_new_static (pixels, sizeof (pixels));
+  texture = gdk_memory_texture_new (2, 2, GDK_MEMORY_R8G8B8A8, bytes, 8);
+  nodes[1] = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 20, 20));
+  g_object_unref (texture);
+  g_bytes_unref (bytes);
+
+  node = gsk_container_node_new (nodes, G_N_ELEMENTS (nodes));
+  gsk_render_node_unref (nodes[0]);
+  gsk_render_node_unref (nodes[1]);
+  binary = gsk_render_node_serialize_binary (node);
+  gsk_render_node_unref (node);
+
+  size = g_bytes_get_size (binary);
+  for (i = 0; i < size; i++)
+    {
+      guint n_errors = 0;
+
+      bytes = g_bytes_new_from_bytes (binary, 0, i);
+      node = gsk_render_node_deserialize_binary (bytes, count_errors, &n_errors);
+      g_assert_null (node);
+      g_assert_cmpuint (n_errors, ==, 1);
+      g_bytes_unref (bytes);
+    }
+
+  g_bytes_unref (binary);
+}
+
+static GBytes *
+replace_float (GBytes *bytes,
+               float   from,
+               float   to)
+{
+  guchar *data;
+  gsize i, size;
+  guint32 u;
+  guchar needle[4];
+
+  memcpy (&u, &from, sizeof (u));
+  u = GUINT32_TO_LE (u);
+  memcpy (needle, &u, sizeof (needle));
+
+  data = g_bytes_unref_to_data (g_bytes_ref (bytes), &size);
+  for (i = 0; i + sizeof (needle) <= size; i++)
+    {
+      if (memcmp (data + i, needle, sizeof (needle)) == 0)
+        {
+          memcpy (&u, &to, sizeof (u));
+          u = GUINT32_TO_LE (u);
+          memcpy (data + i, &u, sizeof (u));
+          return g_bytes_new_take (data, size);
+        }
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+test_rendernode_binary_corrupted (void)
+{
+  struct {
+    const char *text;
+    float from;
+    float to;
+  } tests[] = {
+    { "linear-gradient { stops: 0.25 red, 0.75 blue; }", 0.25, -0.25 },
+    { "linear-gradient { stops: 0.25 red, 0.75 blue; }", 0.75, 0.125 },
+    { "radial-gradient { stops: 0.25 red, 0.75 blue; }", 0.75, 1.5 },
+    { "conic-gradient { stops: 0.25 red, 0.75 blue; }", 0.25, NAN },
+    { "radial-gradient { hradius: 12.5; }", 12.5, 0 },
+    { "blur { blur: 3.25; child: color { } }", 3.25, -3.25 },
+    { "shadow { shadows: red 1 2 3.25; child: color { } }", 3.25, -3.25 },
+    { "outset-shadow { blur: 3.25; }", 3.25, -3.25 },
+    { "stroke { path: \"M 0 0 L 10 10\"; line-width: 2.5; child: color { } }", 2.5, 0 },
+    { "stroke { path: \"M 0 0 L 10 10\"; line-width: 2.5; child: color { } }", 2.5, -2.5 },
+    { "stroke { path: \"M 0 0 L 10 10\"; dash: 1.5 2; child: color { } }", 1.5, -1.5 },
+  };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++)
+    {
+      GskRenderNode *node;
+      GBytes *bytes, *binary;
+      guint n_errors = 0;
+
+      bytes = g_bytes_new_static (tests[i].text, strlen (tests[i].text));
+      node = gsk_render_node_deserialize (bytes, NULL, NULL);
+      g_assert_nonnull (node);
+      g_bytes_unref (bytes);
+
+      bytes = gsk_render_node_serialize_binary (node);
+      gsk_render_node_unref (node);
+
+      /* Make sure the untouched data loads */
+      node = gsk_render_node_deserialize_binary (bytes, count_errors, &n_errors);
+      g_assert_nonnull (node);
+      g_assert_cmpuint (n_errors, ==, 0);
+      gsk_render_node_unref (node);
+
+      binary = replace_float (bytes, tests[i].from, tests[i].to);
+      g_bytes_unref (bytes);
+
+      node = gsk_render_node_deserialize_binary (binary, count_errors, &n_errors);
+      g_assert_null (node);
+      g_assert_cmpuint (n_errors, ==, 1);
+      g_bytes_unref (binary);
+    }
+}
+
+static void
+test_rendernode_trace (void)
+{
+  GskRenderNode *shared, *nodes[2], *frame1, *frame2;
+  GskRenderTraceWriter *writer;
+  GOutputStream *stream;
+  cairo_region_t *region;
+  GskRenderTraceFrame *frame;
+  GArray *frames;
+  GBytes *bytes;
+
+  shared = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  nodes[0] = shared;
+  nodes[1] = gsk_color_node_new (&(GdkRGBA) { 0, 0, 1, 1 }, &GRAPHENE_RECT_INIT (10, 0, 10, 10));
+  frame1 = gsk_container_node_new (nodes, 2);
+  gsk_render_node_unref (nodes[1]);
+  nodes[1] = gsk_color_node_new (&(GdkRGBA) { 0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (10, 0, 10, 10));
+  frame2 = gsk_container_node_new (nodes, 2);
+  gsk_render_node_unref (nodes[1]);
+  gsk_render_node_unref (shared);
+
+  stream = g_memory_output_stream_new_resizable ();
+  writer = gsk_render_trace_writer_new (stream);
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, 20, 10 });
+  g_assert_true (gsk_render_trace_writer_add_frame (writer, frame1, region, 20, 10, 1000, 50));
+  cairo_region_destroy (region);
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 10, 0, 10, 10 });
+  g_assert_true (gsk_render_trace_writer_add_frame (writer, frame2, region, 20, 10, 2000, 20));
+  gsk_render_trace_writer_free (writer);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
+  frames = gsk_render_node_deserialize_trace (bytes, NULL, NULL);
+  g_assert_nonnull (frames);
+  g_assert_cmpuint (frames->len, ==, 2);
+
+  frame = &g_array_index (frames, GskRenderTraceFrame, 1);
+  g_assert_cmpint (frame->width, ==, 20);
+  g_assert_cmpint (frame->height, ==, 10);
+  g_assert_cmpint (frame->time, ==, 2000);
+  g_assert_cmpint (frame->duration, ==, 20);
+  g_assert_true (cairo_region_contains_point (frame->region, 15, 5));
+  g_assert_false (cairo_region_contains_point (frame->region, 5, 5));
+
+  /* The unchanged child is stored once and shared between frames */
+  g_assert_true (gsk_container_node_get_child (frame->node, 0) ==
+                 gsk_container_node_get_child (g_array_index (frames, GskRenderTraceFrame, 0).node, 0));
+  g_assert_false (gsk_container_node_get_child (frame->node, 1) ==
+                  gsk_container_node_get_child (g_array_index (frames, GskRenderTraceFrame, 0).node, 1));
+
+  g_array_unref (frames);
+  g_bytes_unref (bytes);
+  g_object_unref (stream);
+  gsk_render_node_unref (frame1);
+  gsk_render_node_unref (frame2);
+}
+
+static GskRenderNode *
+create_text_node (const char *text)
+{
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoLayoutRun *run;
+  GskRenderNode *node;
+
+  context = pango_font_map_create_context (pango_cairo_font_map_get_default ());
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, text, -1);
+  run = pango_layout_get_line_readonly (layout, 0)->runs->data;
+
+  node = gsk_text_node_new (run->item->analysis.font,
+                            run->glyphs,
+                            &(GdkRGBA) { 0, 0, 0, 1 },
+                            &GRAPHENE_POINT_INIT (0, 20));
+
+  g_object_unref (layout);
+  g_object_unref (context);
+
+  return node;
+}
+
+static void
+test_rendernode_trace_rotate (void)
+{
+  GskRenderNode *nodes[3];
+  GskRenderTraceWriter *writer;
+  GOutputStream *stream;
+  cairo_region_t *region;
+  GskRenderNode *first, *last;
+  const PangoGlyphInfo *glyphs1, *glyphs3;
+  GArray *frames;
+  GBytes *bytes;
+  guint i;
+
+  /* The font and glyphs of the first frame are not used by
+   * the second one, so they are released and written again
+   * for the third.
+   */
+  nodes[0] = create_text_node ("Hello");
+  nodes[1] = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  nodes[2] = create_text_node ("Hello");
+  g_assert_nonnull (nodes[0]);
+  g_assert_nonnull (nodes[2]);
+
+  stream = g_memory_output_stream_new_resizable ();
+  writer = gsk_render_trace_writer_new (stream);
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, 100, 30 });
+  for (i = 0; i < 3; i++)
+    g_assert_true (gsk_render_trace_writer_add_frame (writer, nodes[i], region, 100, 30, i * 1000, 10));
+  cairo_region_destroy (region);
+  gsk_render_trace_writer_free (writer);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
+  frames = gsk_render_node_deserialize_trace (bytes, NULL, NULL);
+  g_assert_nonnull (frames);
+  g_assert_cmpuint (frames->len, ==, 3);
+
+  first = g_array_index (frames, GskRenderTraceFrame, 0).node;
+  last = g_array_index (frames, GskRenderTraceFrame, 2).node;
+  g_assert_cmpint (gsk_render_node_get_node_type (first), ==, GSK_TEXT_NODE);
+  g_assert_cmpint (gsk_render_node_get_node_type (last), ==, GSK_TEXT_NODE);
+  g_assert_cmpuint (gsk_text_node_get_num_glyphs (last), ==, gsk_text_node_get_num_glyphs (nodes[2]));
+
+  glyphs1 = gsk_text_node_get_glyphs (first, NULL);
+  glyphs3 = gsk_text_node_get_glyphs (last, NULL);
+  for (i = 0; i < gsk_text_node_get_num_glyphs (last); i++)
+    {
+      g_assert_cmpuint (glyphs3[i].glyph, ==, glyphs1[i].glyph);
+      g_assert_cmpint (glyphs3[i].geometry.width, ==, glyphs1[i].geometry.width);
+    }
+
+  g_array_unref (frames);
+  g_bytes_unref (bytes);
+  g_object_unref (stream);
+  for (i = 0; i < 3; i++)
+    gsk_render_node_unref (nodes[i]);
+}
+
 const char shader1[] =
 "uniform float progress;\n"
 "uniform sampler2D u_texture1;\n"
@@ -283,6 +658,12 @@ main (int argc, char *argv[])
   g_test_add_func ("/rendernode/border/uniform", test_bordernode_uniform);
   g_test_add_func ("/rendernode/conic-gradient/angle", test_conic_gradient_angle);
   g_test_add_func ("/rendernode/container/disjoint", test_container_disjoint);
+  g_test_add_func ("/rendernode/container/children-in-rect", test_container_children_in_rect);
+  g_test_add_func ("/rendernode/serialize/binary", test_rendernode_serialize_binary);
+  g_test_add_func ("/rendernode/serialize/binary-truncated", test_rendernode_binary_truncated);
+  g_test_add_func ("/rendernode/serialize/binary-corrupted", test_rendernode_binary_corrupted);
+  g_test_add_func ("/rendernode/serialize/trace", test_rendernode_trace);
+  g_test_add_func ("/rendernode/serialize/trace-rotate", test_rendernode_trace_rotate);
   g_test_add_func ("/renderer/cairo", test_cairo_renderer);
   g_test_add_func ("/renderer/gl", test_gl_renderer);
 
@@ -0,0 +1,201 @@
+#include <gtk/gtk.h>
+
+#include "testsuite/gdk/gdktestutils.h"
+
+#define SIZE 64
+
+struct {
+  const char *name;
+  GskRenderer * (*create_func) (void);
+  GskRenderer *renderer;
+} renderers[] = {
+  {
+    "cairo",
+    gsk_cairo_renderer_new,
+  },
+  {
+    "vulkan",
+    gsk_vulkan_renderer_new,
+  },
+  {
+    "ngl",
+    gsk_ngl_renderer_new,
+  },
+};
+
+static const GdkRGBA red = { 1, 0, 0, 1 };
+static const GdkRGBA blue = { 0, 0, 1, 1 };
+
+/* Creates a red texture with a blue @area. If @update is given,
+ * the new texture is an update of it, changed only in @area.
+ */
+static GdkTexture *
+create_chain_texture (GdkTexture                  *update,
+                      const cairo_rectangle_int_t *area)
+{
+  GdkMemoryTextureBuilder *builder;
+  cairo_region_t *region;
+  GdkTexture *texture;
+  GBytes *bytes;
+  guchar *data;
+  int x, y;
+
+  data = g_malloc (SIZE * SIZE * 4);
+  for (y = 0; y < SIZE; y++)
+    for (x = 0; x < SIZE; x++)
+      {
+        guchar *pixel = data + (y * SIZE + x) * 4;
+        gboolean inside = area &&
+                          x >= area->x && x < area->x + area->width &&
+                          y >= area->y && y < area->y + area->height;
+
+        pixel[0] = inside ? 0 : 255;
+        pixel[1] = 0;
+        pixel[2] = inside ? 255 : 0;
+        pixel[3] = 255;
+      }
+  bytes = g_bytes_new_take (data, SIZE * SIZE * 4);
+
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_width (builder, SIZE);
+  gdk_memory_texture_builder_set_height (builder, SIZE);
+  gdk_memory_texture_builder_set_format (builder, GDK_MEMORY_R8G8B8A8);
+  gdk_memory_texture_builder_set_bytes (builder, bytes);
+  gdk_memory_texture_builder_set_stride (builder, SIZE * 4);
+  if (update)
+    {
+      region = cairo_region_create_rectangle (area);
+      gdk_memory_texture_builder_set_update_texture (builder, update);
+      gdk_memory_texture_builder_set_update_region (builder, region);
+      cairo_region_destroy (region);
+    }
+
+  texture = gdk_memory_texture_builder_build (builder);
+
+  g_object_unref (builder);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static void
+render_and_compare (GskRenderer                 *renderer,
+                    GdkTexture                  *texture,
+                    const cairo_rectangle_int_t *area)
+{
+  GskRenderNode *node;
+  GdkTexture *output, *expected;
+  TextureBuilder builder;
+  int x, y;
+
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, SIZE, SIZE));
+  output = gsk_renderer_render_texture (renderer, node, NULL);
+
+  texture_builder_init (&builder, gdk_texture_get_format (output), SIZE, SIZE);
+  texture_builder_fill (&builder, &red);
+  if (area)
+    {
+      for (y = area->y; y < area->y + area->height; y++)
+        for (x = area->x; x < area->x + area->width; x++)
+          texture_builder_set_pixel (&builder, x, y, &blue);
+    }
+  expected = texture_builder_finish (&builder);
+
+  compare_textures (expected, output, FALSE);
+
+  g_object_unref (expected);
+  g_object_unref (output);
+  gsk_render_node_unref (node);
+}
+
+static void
+test_chain_update (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  const cairo_rectangle_int_t area1 = { 8, 8, 16, 16 };
+  const cairo_rectangle_int_t area2 = { 30, 20, 10, 30 };
+  GdkTexture *texture1, *texture2, *texture3;
+
+  texture1 = create_chain_texture (NULL, NULL);
+  render_and_compare (renderer, texture1, NULL);
+
+  /* Each frame takes over the image of the previous one
+   * and only uploads the changed area */
+  texture2 = create_chain_texture (texture1, &area1);
+  render_and_compare (renderer, texture2, &area1);
+
+  texture3 = create_chain_texture (texture2, &area2);
+  render_and_compare (renderer, texture3, &area2);
+
+  /* The older textures lost their image and need to upload again */
+  render_and_compare (renderer, texture1, NULL);
+  render_and_compare (renderer, texture2, &area1);
+
+  g_object_unref (texture3);
+  g_object_unref (texture2);
+  g_object_unref (texture1);
+}
+
+static void
+create_renderers (void)
+{
+  GError *error = NULL;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      renderers[i].renderer = renderers[i].create_func ();
+      if (!gsk_renderer_realize_for_display (renderers[i].renderer, gdk_display_get_default (), &error))
+        {
+          g_test_message ("Could not realize %s renderer: %s", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_clear_object (&renderers[i].renderer);
+        }
+    }
+}
+
+static void
+destroy_renderers (void)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      gsk_renderer_unrealize (renderers[i].renderer);
+      g_clear_object (&renderers[i].renderer);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int result;
+  gsize i;
+
+  gtk_test_init (&argc, &argv, NULL);
+  create_renderers ();
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      char *test_name;
+
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      test_name = g_strdup_printf ("/texture-chain/update/%s", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_chain_update);
+      g_free (test_name);
+    }
+
+  result = g_test_run ();
+
+  /* So the context gets actually destroyed */
+  gdk_gl_context_clear_current ();
+
+  destroy_renderers ();
+
+  return result;
+}
@@ -0,0 +1,241 @@
+#include <gtk/gtk.h>
+
+#include <string.h>
+
+#include "testsuite/gdk/gdktestutils.h"
+
+#define WIDTH 64
+#define HEIGHT 48
+
+struct {
+  const char *name;
+  GskRenderer * (*create_func) (void);
+  GskRenderer *renderer;
+} renderers[] = {
+  {
+    "cairo",
+    gsk_cairo_renderer_new,
+  },
+  {
+    "vulkan",
+    gsk_vulkan_renderer_new,
+  },
+  {
+    "ngl",
+    gsk_ngl_renderer_new,
+  },
+};
+
+/* How the rows of the texture are laid out in memory */
+typedef struct {
+  const char *name;
+  gsize padding;
+  int x;
+  int y;
+} Layout;
+
+static const Layout layouts[] = {
+  { "tight", 0, 0, 0 },
+  /* GL_UNPACK_ROW_LENGTH */
+  { "padded", 7 * 4, 0, 0 },
+  /* row by row */
+  { "unaligned", 3, 0, 0 },
+  /* like a subtexture, starts within the bytes */
+  { "offset", 5 * 4, 5, 3 },
+};
+
+/* Every pixel is different, so swapped rows or columns are detected */
+static void
+get_pixel (int     x,
+           int     y,
+           int     seed,
+           guchar  pixel[4])
+{
+  pixel[0] = x * 4;
+  pixel[1] = y * 4;
+  pixel[2] = (x + y + seed) * 8;
+  pixel[3] = 255;
+}
+
+/* Creates a texture in a format GL can take as is, with its
+ * rows laid out according to @layout. If @update is given,
+ * the new texture is an update of it, changed only in @area.
+ */
+static GdkTexture *
+create_texture (const Layout                *layout,
+                GdkTexture                  *update,
+                const cairo_rectangle_int_t *area)
+{
+  GdkMemoryTextureBuilder *builder;
+  cairo_region_t *region;
+  GdkTexture *texture;
+  GBytes *bytes, *sub_bytes;
+  guchar *data;
+  gsize stride, offset, size;
+  int x, y;
+
+  stride = (layout->x + WIDTH) * 4 + layout->padding;
+  offset = layout->y * stride + layout->x * 4;
+  size = (layout->y + HEIGHT) * stride;
+
+  /* Garbage outside of the texture shows up if it gets uploaded */
+  data = g_malloc (size);
+  memset (data, 0x55, size);
+  for (y = 0; y < HEIGHT; y++)
+    for (x = 0; x < WIDTH; x++)
+      {
+        gboolean inside = area &&
+                          x >= area->x && x < area->x + area->width &&
+                          y >= area->y && y < area->y + area->height;
+
+        get_pixel (x, y, inside ? 1 : 0, data + offset + y * stride + x * 4);
+      }
+  bytes = g_bytes_new_take (data, size);
+  sub_bytes = g_bytes_new_from_bytes (bytes, offset, size - offset);
+
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_width (builder, WIDTH);
+  gdk_memory_texture_builder_set_height (builder, HEIGHT);
+  gdk_memory_texture_builder_set_format (builder, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED);
+  gdk_memory_texture_builder_set_bytes (builder, sub_bytes);
+  gdk_memory_texture_builder_set_stride (builder, stride);
+  if (update)
+    {
+      region = cairo_region_create_rectangle (area);
+      gdk_memory_texture_builder_set_update_texture (builder, update);
+      gdk_memory_texture_builder_set_update_region (builder, region);
+      cairo_region_destroy (region);
+    }
+
+  texture = gdk_memory_texture_builder_build (builder);
+
+  g_object_unref (builder);
+  g_bytes_unref (sub_bytes);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static void
+render_and_compare (GskRenderer                 *renderer,
+                    GdkTexture                  *texture,
+                    const cairo_rectangle_int_t *area)
+{
+  GskRenderNode *node;
+  GdkTexture *output, *expected;
+  TextureBuilder builder;
+  int x, y;
+
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, WIDTH, HEIGHT));
+  output = gsk_renderer_render_texture (renderer, node, NULL);
+
+  texture_builder_init (&builder, gdk_texture_get_format (output), WIDTH, HEIGHT);
+  for (y = 0; y < HEIGHT; y++)
+    for (x = 0; x < WIDTH; x++)
+      {
+        gboolean inside = area &&
+                          x >= area->x && x < area->x + area->width &&
+                          y >= area->y && y < area->y + area->height;
+        guchar pixel[4];
+        GdkRGBA color;
+
+        get_pixel (x, y, inside ? 1 : 0, pixel);
+        color = (GdkRGBA) { pixel[0] / 255.f, pixel[1] / 255.f, pixel[2] / 255.f, 1 };
+        texture_builder_set_pixel (&builder, x, y, &color);
+      }
+  expected = texture_builder_finish (&builder);
+
+  compare_textures (expected, output, FALSE);
+
+  g_object_unref (expected);
+  g_object_unref (output);
+  gsk_render_node_unref (node);
+}
+
+static void
+test_upload (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  const cairo_rectangle_int_t area = { 10, 6, 20, 30 };
+  GdkTexture *texture1, *texture2;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (layouts); i++)
+    {
+      g_test_message ("Layout %s", layouts[i].name);
+
+      texture1 = create_texture (&layouts[i], NULL, NULL);
+      render_and_compare (renderer, texture1, NULL);
+
+      /* Only uploads @area, from the middle of the rows */
+      texture2 = create_texture (&layouts[i], texture1, &area);
+      render_and_compare (renderer, texture2, &area);
+
+      g_object_unref (texture2);
+      g_object_unref (texture1);
+    }
+}
+
+static void
+create_renderers (void)
+{
+  GError *error = NULL;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      renderers[i].renderer = renderers[i].create_func ();
+      if (!gsk_renderer_realize_for_display (renderers[i].renderer, gdk_display_get_default (), &error))
+        {
+          g_test_message ("Could not realize %s renderer: %s", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_clear_object (&renderers[i].renderer);
+        }
+    }
+}
+
+static void
+destroy_renderers (void)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      gsk_renderer_unrealize (renderers[i].renderer);
+      g_clear_object (&renderers[i].renderer);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int result;
+  gsize i;
+
+  gtk_test_init (&argc, &argv, NULL);
+  create_renderers ();
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      char *test_name;
+
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      test_name = g_strdup_printf ("/texture-upload/memory/%s", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_upload);
+      g_free (test_name);
+    }
+
+  result = g_test_run ();
+
+  /* So the context gets actually destroyed */
+  gdk_gl_context_clear_current ();
+
+  destroy_renderers ();
+
+  return result;
+}
@@ -0,0 +1,250 @@
+#include <gtk/gtk.h>
+
+#include "gdk/gdktiledtextureprivate.h"
+
+#include "testsuite/gdk/gdktestutils.h"
+
+struct {
+  const char *name;
+  GskRenderer * (*create_func) (void);
+  gboolean draws_tiles;
+  GskRenderer *renderer;
+} renderers[] = {
+  {
+    "cairo",
+    gsk_cairo_renderer_new,
+    FALSE,
+  },
+  {
+    "vulkan",
+    gsk_vulkan_renderer_new,
+    TRUE,
+  },
+  {
+    "ngl",
+    gsk_ngl_renderer_new,
+    TRUE,
+  },
+};
+
+static const GdkRGBA red = { 1, 0, 0, 1 };
+static const GdkRGBA blue = { 0, 0, 1, 1 };
+
+typedef struct {
+  int width;
+  int n_loads;
+  guint lod_levels;
+} Loader;
+
+/* The left half of the texture is red, the right half blue */
+static GdkTexture *
+load_tile (GdkTiledTexture             *texture,
+           guint                        lod_level,
+           const cairo_rectangle_int_t *area,
+           gpointer                     data)
+{
+  Loader *loader = data;
+  GdkMemoryTextureBuilder *builder;
+  GdkTexture *tile;
+  GBytes *bytes;
+  guchar *pixels;
+  int x, y, width, height;
+
+  g_atomic_int_inc (&loader->n_loads);
+  g_atomic_int_or (&loader->lod_levels, 1 << lod_level);
+
+  width = (area->width + (1 << lod_level) - 1) >> lod_level;
+  height = (area->height + (1 << lod_level) - 1) >> lod_level;
+
+  pixels = g_malloc_n (width * 4, height);
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        guchar *pixel = pixels + (y * width + x) * 4;
+        gboolean left = area->x + (x << lod_level) < loader->width / 2;
+
+        pixel[0] = left ? 255 : 0;
+        pixel[1] = 0;
+        pixel[2] = left ? 0 : 255;
+        pixel[3] = 255;
+      }
+  bytes = g_bytes_new_take (pixels, width * height * 4);
+
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_width (builder, width);
+  gdk_memory_texture_builder_set_height (builder, height);
+  gdk_memory_texture_builder_set_format (builder, GDK_MEMORY_R8G8B8A8);
+  gdk_memory_texture_builder_set_bytes (builder, bytes);
+  gdk_memory_texture_builder_set_stride (builder, width * 4);
+
+  tile = gdk_memory_texture_builder_build (builder);
+
+  g_object_unref (builder);
+  g_bytes_unref (bytes);
+
+  return tile;
+}
+
+static GdkTexture *
+create_tiled_texture (Loader *loader,
+                      int     size)
+{
+  loader->width = size;
+  loader->n_loads = 0;
+  loader->lod_levels = 0;
+
+  return gdk_tiled_texture_new (size, size,
+                                GDK_MEMORY_R8G8B8A8,
+                                GDK_COLOR_STATE_SRGB,
+                                load_tile,
+                                loader,
+                                NULL);
+}
+
+/* Creates the expected rendering of @width pixels of
+ * a texture that switches to blue at @split */
+static GdkTexture *
+create_expected (GdkMemoryFormat format,
+                 int             width,
+                 int             height,
+                 int             split)
+{
+  TextureBuilder builder;
+  int x, y;
+
+  texture_builder_init (&builder, format, width, height);
+  texture_builder_fill (&builder, &red);
+  for (y = 0; y < height; y++)
+    for (x = split; x < width; x++)
+      texture_builder_set_pixel (&builder, x, y, &blue);
+
+  return texture_builder_finish (&builder);
+}
+
+static void
+test_tiled_clip (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  gboolean draws_tiles = renderers[GPOINTER_TO_SIZE (data)].draws_tiles;
+  GskRenderNode *node;
+  GdkTexture *texture, *output, *expected;
+  Loader loader;
+
+  texture = create_tiled_texture (&loader, 2048);
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 2048, 2048));
+
+  /* Straddles the color change, but stays within 2 tiles */
+  output = gsk_renderer_render_texture (renderer, node, &GRAPHENE_RECT_INIT (992, 0, 64, 64));
+  expected = create_expected (gdk_texture_get_format (output), 64, 64, 32);
+  compare_textures (expected, output, FALSE);
+
+  /* Only the visible tiles are loaded, at full resolution */
+  if (draws_tiles)
+    {
+      g_assert_cmpint (loader.n_loads, ==, 2);
+      g_assert_cmpuint (loader.lod_levels, ==, 1 << 0);
+    }
+
+  g_object_unref (expected);
+  g_object_unref (output);
+  gsk_render_node_unref (node);
+  g_object_unref (texture);
+}
+
+static void
+test_tiled_scaled (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  gboolean draws_tiles = renderers[GPOINTER_TO_SIZE (data)].draws_tiles;
+  GskRenderNode *node;
+  GdkTexture *texture, *output, *expected;
+  Loader loader;
+
+  texture = create_tiled_texture (&loader, 4096);
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 256, 256));
+
+  output = gsk_renderer_render_texture (renderer, node, NULL);
+  expected = create_expected (gdk_texture_get_format (output), 256, 256, 128);
+  compare_textures (expected, output, FALSE);
+
+  /* Scaled down 16 times, so the tiles are loaded at a
+   * reduced level of detail instead of at full size */
+  if (draws_tiles)
+    {
+      g_assert_cmpint (loader.n_loads, >, 0);
+      g_assert_cmpuint (loader.lod_levels & 1, ==, 0);
+    }
+
+  g_object_unref (expected);
+  g_object_unref (output);
+  gsk_render_node_unref (node);
+  g_object_unref (texture);
+}
+
+static void
+create_renderers (void)
+{
+  GError *error = NULL;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      renderers[i].renderer = renderers[i].create_func ();
+      if (!gsk_renderer_realize_for_display (renderers[i].renderer, gdk_display_get_default (), &error))
+        {
+          g_test_message ("Could not realize %s renderer: %s", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_clear_object (&renderers[i].renderer);
+        }
+    }
+}
+
+static void
+destroy_renderers (void)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      gsk_renderer_unrealize (renderers[i].renderer);
+      g_clear_object (&renderers[i].renderer);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int result;
+  gsize i;
+
+  gtk_test_init (&argc, &argv, NULL);
+  create_renderers ();
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      char *test_name;
+
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      test_name = g_strdup_printf ("/tiled-texture/clip/%s", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_tiled_clip);
+      g_free (test_name);
+
+      test_name = g_strdup_printf ("/tiled-texture/scaled/%s", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_tiled_scaled);
+      g_free (test_name);
+    }
+
+  result = g_test_run ();
+
+  /* So the context gets actually destroyed */
+  gdk_gl_context_clear_current ();
+
+  destroy_renderers ();
+
+  return result;
+}
@@ -2981,6 +2981,120 @@ test_picture (void)
   g_free (uri);
 }
 
+/* Summarizes the objects built from builder-resource.ui,
+ * so builds can be compared
+ */
+static char *
+describe_resource_objects (GtkBuilder *builder)
+{
+  GString *string = g_string_new ("");
+  GObject *box, *label, *button, *adjustment;
+  GSList *objects;
+
+  box = gtk_builder_get_object (builder, "box");
+  label = gtk_builder_get_object (builder, "label");
+  button = gtk_builder_get_object (builder, "button");
+  adjustment = gtk_builder_get_object (builder, "adjustment");
+
+  g_assert_true (GTK_IS_BOX (box));
+  g_assert_true (GTK_IS_LABEL (label));
+  g_assert_true (GTK_IS_BUTTON (button));
+  g_assert_true (GTK_IS_ADJUSTMENT (adjustment));
+
+  g_string_append_printf (string, "box %d %d %d %d %d\n",
+                          gtk_orientable_get_orientation (GTK_ORIENTABLE (box)),
+                          gtk_box_get_spacing (GTK_BOX (box)),
+                          gtk_widget_has_css_class (GTK_WIDGET (box), "resource-box"),
+                          gtk_widget_get_first_child (GTK_WIDGET (box)) == GTK_WIDGET (label),
+                          gtk_widget_get_last_child (GTK_WIDGET (box)) == GTK_WIDGET (button));
+  g_string_append_printf (string, "label %s %g\n",
+                          gtk_label_get_label (GTK_LABEL (label)),
+                          gtk_label_get_xalign (GTK_LABEL (label)));
+  g_string_append_printf (string, "button %s %d\n",
+                          gtk_button_get_label (GTK_BUTTON (button)),
+                          gtk_button_get_use_underline (GTK_BUTTON (button)));
+  g_string_append_printf (string, "adjustment %g %g\n",
+                          gtk_adjustment_get_upper (GTK_ADJUSTMENT (adjustment)),
+                          gtk_adjustment_get_value (GTK_ADJUSTMENT (adjustment)));
+  objects = gtk_builder_get_objects (builder);
+  g_string_append_printf (string, "%u objects\n", g_slist_length (objects));
+  g_slist_free (objects);
+
+  return g_string_free (string, FALSE);
+}
+
+static void
+test_resource (void)
+{
+  const char *path = "/org/gtk/builder-test/builder-resource.ui";
+  const char *expected = "box 1 6 1 1 1\n"
+                         "label Hello 0\n"
+                         "button Öffnen… 1\n"
+                         "adjustment 100 42\n"
+                         "4 objects\n";
+  GError *error = NULL;
+  guint i;
+
+  /* Loading the same resource repeatedly switches to a
+   * faster path, which must build the same objects
+   */
+  for (i = 0; i < 5; i++)
+    {
+      GtkBuilder *builder;
+      char *description;
+
+      builder = gtk_builder_new ();
+      gtk_builder_add_from_resource (builder, path, &error);
+      g_assert_no_error (error);
+
+      description = describe_resource_objects (builder);
+      g_assert_cmpstr (description, ==, expected);
+
+      g_free (description);
+      g_object_unref (builder);
+    }
+
+  for (i = 0; i < 3; i++)
+    {
+      const char *ids[] = { "label", NULL };
+      GtkBuilder *builder;
+      GObject *label;
+
+      builder = gtk_builder_new ();
+      gtk_builder_add_objects_from_resource (builder, path, ids, &error);
+      g_assert_no_error (error);
+
+      label = gtk_builder_get_object (builder, "label");
+      g_assert_true (GTK_IS_LABEL (label));
+      g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "Hello");
+      g_assert_null (gtk_builder_get_object (builder, "box"));
+
+      g_object_unref (builder);
+    }
+}
+
+static void
+test_resource_invalid (void)
+{
+  guint i;
+
+  /* Failures must not be cached, every load reports the error */
+  for (i = 0; i < 5; i++)
+    {
+      GtkBuilder *builder;
+      GError *error = NULL;
+
+      builder = gtk_builder_new ();
+      g_assert_false (gtk_builder_add_from_resource (builder,
+                                                     "/org/gtk/builder-test/builder-resource-invalid.ui",
+                                                     &error));
+      g_assert_error (error, GTK_BUILDER_ERROR, GTK_BUILDER_ERROR_INVALID_PROPERTY);
+
+      g_error_free (error);
+      g_object_unref (builder);
+    }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -3031,6 +3145,8 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Child Dispose Order", test_child_dispose_order);
   g_test_add_func ("/Builder/Buildable", test_buildable);
   g_test_add_func ("/Builder/Picture", test_picture);
+  g_test_add_func ("/Builder/Resource", test_resource);
+  g_test_add_func ("/Builder/Resource Invalid", test_resource_invalid);
 
   return g_test_run();
 }
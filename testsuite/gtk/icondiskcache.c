@@ -0,0 +1,274 @@
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#ifdef G_OS_WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#include "gtk/gtkiconthemeprivate.h"
+
+/* Must match GTK_ICON_CACHE_SIZE in main(), in bytes */
+#define CACHE_LIMIT (1024 * 1024)
+
+static char *cache_dir;
+static char *source_dir;
+
+static void
+clear_dir (const char *path)
+{
+  GDir *dir;
+  const char *name;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *file = g_build_filename (path, name, NULL);
+      g_unlink (file);
+      g_free (file);
+    }
+
+  g_dir_close (dir);
+}
+
+static void
+get_cache_usage (guint *n_entries,
+                 gsize *size)
+{
+  GDir *dir;
+  const char *name;
+
+  *n_entries = 0;
+  *size = 0;
+
+  dir = g_dir_open (cache_dir, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *file = g_build_filename (cache_dir, name, NULL);
+      GStatBuf stat_buf;
+
+      if (g_stat (file, &stat_buf) == 0)
+        {
+          *n_entries += 1;
+          *size += stat_buf.st_size;
+        }
+
+      g_free (file);
+    }
+
+  g_dir_close (dir);
+}
+
+/* All colors have the same length, so edited
+ * files keep their size
+ */
+static char *
+write_svg (const char *name,
+           const char *color,
+           int         size)
+{
+  char *path, *contents;
+  GError *error = NULL;
+
+  path = g_build_filename (source_dir, name, NULL);
+  contents = g_strdup_printf ("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\">"
+                              "<rect width=\"%d\" height=\"%d\" fill=\"%s\"/>"
+                              "</svg>",
+                              size, size, size, size, color);
+
+  g_file_set_contents (path, contents, -1, &error);
+  g_assert_no_error (error);
+
+  g_free (contents);
+
+  return path;
+}
+
+static void
+assert_icon_color (const char *path,
+                   int         size,
+                   guint32     expected)
+{
+  GtkIconPaintable *icon;
+  GtkSnapshot *snapshot;
+  GskRenderNode *node;
+  GdkTexture *texture;
+  GdkTextureDownloader *downloader;
+  guint32 *data;
+  GFile *file;
+
+  file = g_file_new_for_path (path);
+  icon = gtk_icon_paintable_new_for_file (file, size, 1);
+
+  snapshot = gtk_snapshot_new ();
+  gdk_paintable_snapshot (GDK_PAINTABLE (icon), snapshot, size, size);
+  node = gtk_snapshot_free_to_node (snapshot);
+
+  g_assert_cmpint (gsk_render_node_get_node_type (node), ==, GSK_TEXTURE_NODE);
+  texture = gsk_texture_node_get_texture (node);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, size);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, size);
+
+  data = g_new (guint32, size * size);
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, GDK_MEMORY_A8R8G8B8_PREMULTIPLIED);
+  gdk_texture_downloader_download_into (downloader, (guchar *) data, size * 4);
+  gdk_texture_downloader_free (downloader);
+
+  g_assert_cmphex (GUINT32_FROM_BE (data[size * size / 2 + size / 2]), ==, expected);
+
+  g_free (data);
+  gsk_render_node_unref (node);
+  g_object_unref (icon);
+  g_object_unref (file);
+
+  gtk_icon_disk_cache_flush ();
+}
+
+static void
+test_reuse (void)
+{
+  guint n_entries;
+  gsize size;
+  char *path;
+
+  clear_dir (cache_dir);
+
+  path = write_svg ("reuse.svg", "#ff0000", 32);
+
+  assert_icon_color (path, 32, 0xffff0000);
+  get_cache_usage (&n_entries, &size);
+  g_assert_cmpuint (n_entries, ==, 1);
+  g_assert_cmpuint (size, >=, 32 * 32 * 4);
+
+  /* Loaded from the cache, nothing new is written */
+  assert_icon_color (path, 32, 0xffff0000);
+  get_cache_usage (&n_entries, &size);
+  g_assert_cmpuint (n_entries, ==, 1);
+
+  /* Other sizes are separate entries */
+  assert_icon_color (path, 16, 0xffff0000);
+  get_cache_usage (&n_entries, &size);
+  g_assert_cmpuint (n_entries, ==, 2);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+static void
+test_edit (void)
+{
+  guint n_entries;
+  gsize size;
+  char *path;
+  GStatBuf stat_buf;
+  struct utimbuf times;
+
+  clear_dir (cache_dir);
+
+  path = write_svg ("edit.svg", "#ff0000", 32);
+  assert_icon_color (path, 32, 0xffff0000);
+  g_assert_cmpint (g_stat (path, &stat_buf), ==, 0);
+
+  /* Rewritten with the same size, so only the
+   * modification time tells the versions apart.
+   * Make sure it differs even with coarse timestamps.
+   */
+  g_free (write_svg ("edit.svg", "#0000ff", 32));
+  times.actime = stat_buf.st_mtime + 10;
+  times.modtime = stat_buf.st_mtime + 10;
+  g_assert_cmpint (g_utime (path, &times), ==, 0);
+  assert_icon_color (path, 32, 0xff0000ff);
+
+  /* Rewritten with a different size */
+  g_free (write_svg ("edit.svg", "#00ff00", 320));
+  g_assert_cmpint (g_utime (path, &times), ==, 0);
+  assert_icon_color (path, 32, 0xff00ff00);
+
+  get_cache_usage (&n_entries, &size);
+  g_assert_cmpuint (n_entries, ==, 3);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+static void
+test_limit (void)
+{
+  const char *colors[] = { "#ff0000", "#00ff00", "#0000ff", "#ffff00", "#00ffff", "#ff00ff" };
+  guint n_entries;
+  gsize size;
+  guint i;
+
+  clear_dir (cache_dir);
+
+  /* Each entry is at least 256 kB, so these exceed the limit */
+  for (i = 0; i < G_N_ELEMENTS (colors); i++)
+    {
+      char *name, *path;
+
+      name = g_strdup_printf ("limit%u.svg", i);
+      path = write_svg (name, colors[i], 256);
+
+      assert_icon_color (path, 256, 0xff000000 | strtoul (colors[i] + 1, NULL, 16));
+
+      get_cache_usage (&n_entries, &size);
+      g_assert_cmpuint (n_entries, >, 0);
+      g_assert_cmpuint (size, <=, CACHE_LIMIT);
+
+      g_unlink (path);
+      g_free (path);
+      g_free (name);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  char *tmp_dir;
+  char *xdg_cache_home;
+  int result;
+
+  tmp_dir = g_dir_make_tmp ("icondiskcache-XXXXXX", NULL);
+  g_assert_nonnull (tmp_dir);
+
+  xdg_cache_home = g_build_filename (tmp_dir, "cache", NULL);
+  cache_dir = g_build_filename (xdg_cache_home, "gtk-4.0", "icons", NULL);
+  source_dir = g_build_filename (tmp_dir, "source", NULL);
+  g_mkdir_with_parents (source_dir, 0700);
+
+  /* Both are read once, so set them before anything looks */
+  g_setenv ("XDG_CACHE_HOME", xdg_cache_home, TRUE);
+  g_setenv ("GTK_ICON_CACHE_SIZE", "1", TRUE);
+
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/icondiskcache/reuse", test_reuse);
+  g_test_add_func ("/icondiskcache/edit", test_edit);
+  g_test_add_func ("/icondiskcache/limit", test_limit);
+
+  result = g_test_run ();
+
+  clear_dir (cache_dir);
+  g_rmdir (cache_dir);
+  g_free (cache_dir);
+  cache_dir = g_build_filename (xdg_cache_home, "gtk-4.0", NULL);
+  g_rmdir (cache_dir);
+  g_rmdir (xdg_cache_home);
+  g_rmdir (source_dir);
+  g_rmdir (tmp_dir);
+
+  g_free (cache_dir);
+  g_free (source_dir);
+  g_free (xdg_cache_home);
+  g_free (tmp_dir);
+
+  return result;
+}
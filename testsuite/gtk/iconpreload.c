@@ -0,0 +1,189 @@
+#include <gtk/gtk.h>
+
+#include "gtk/gtkiconthemeprivate.h"
+
+static GtkIconTheme *
+get_test_icontheme (void)
+{
+  GtkIconTheme *icon_theme;
+  const char *current_dir[2];
+
+  icon_theme = gtk_icon_theme_new ();
+  gtk_icon_theme_set_theme_name (icon_theme, "icons");
+  current_dir[0] = g_test_get_dir (G_TEST_DIST);
+  current_dir[1] = NULL;
+  gtk_icon_theme_set_search_path (icon_theme, current_dir);
+
+  return icon_theme;
+}
+
+static void
+preload_done (GObject      *source,
+              GAsyncResult *result,
+              gpointer      data)
+{
+  GAsyncResult **res = data;
+
+  *res = g_object_ref (result);
+}
+
+static GPtrArray *
+preload_icons (GtkIconTheme        *theme,
+               GIcon * const       *icons,
+               GtkIconLookupFlags   flags,
+               GCancellable        *cancellable,
+               GError             **error)
+{
+  GAsyncResult *result = NULL;
+  GPtrArray *paintables;
+
+  gtk_icon_theme_preload_icons_async (theme, icons, 16, 1, GTK_TEXT_DIR_NONE, flags,
+                                      cancellable, preload_done, &result);
+
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  paintables = gtk_icon_theme_preload_icons_finish (theme, result, error);
+  g_object_unref (result);
+
+  return paintables;
+}
+
+static void
+test_order (void)
+{
+  GtkIconTheme *theme;
+  GIcon *icons[4];
+  GPtrArray *paintables;
+  GError *error = NULL;
+  guint i;
+
+  theme = get_test_icontheme ();
+
+  icons[0] = g_themed_icon_new ("simple");
+  icons[1] = g_themed_icon_new ("only32-symbolic");
+  icons[2] = g_themed_icon_new ("simple");
+  icons[3] = NULL;
+
+  paintables = preload_icons (theme, icons, 0, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (paintables->len, ==, 3);
+
+  /* Duplicates resolve to the same paintable */
+  g_assert_true (g_ptr_array_index (paintables, 0) == g_ptr_array_index (paintables, 2));
+  g_assert_true (g_ptr_array_index (paintables, 0) != g_ptr_array_index (paintables, 1));
+
+  g_assert_cmpstr (gtk_icon_paintable_get_icon_name (g_ptr_array_index (paintables, 0)), ==, "simple");
+  g_assert_cmpstr (gtk_icon_paintable_get_icon_name (g_ptr_array_index (paintables, 1)), ==, "only32-symbolic");
+
+  g_ptr_array_unref (paintables);
+  for (i = 0; icons[i]; i++)
+    g_object_unref (icons[i]);
+  g_object_unref (theme);
+}
+
+static void
+test_same_as_lookup (void)
+{
+  GtkIconTheme *theme;
+  GIcon *icons[3];
+  GPtrArray *paintables;
+  GtkIconPaintable *paintable;
+  GError *error = NULL;
+  guint i;
+
+  theme = get_test_icontheme ();
+
+  icons[0] = g_themed_icon_new ("simple");
+  icons[1] = g_themed_icon_new_with_default_fallbacks ("everything-justregular-symbolic");
+  icons[2] = NULL;
+
+  paintables = preload_icons (theme, icons, GTK_ICON_LOOKUP_FORCE_REGULAR, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (paintables->len, ==, 2);
+
+  /* Widgets look up with the preload flag, that must not change
+   * the result, or preloading would not help them
+   */
+  for (i = 0; icons[i]; i++)
+    {
+      paintable = gtk_icon_theme_lookup_by_gicon (theme, icons[i], 16, 1, GTK_TEXT_DIR_NONE,
+                                                  GTK_ICON_LOOKUP_FORCE_REGULAR | GTK_ICON_LOOKUP_PRELOAD);
+      g_assert_true (paintable == g_ptr_array_index (paintables, i));
+      g_object_unref (paintable);
+    }
+
+  g_ptr_array_unref (paintables);
+  for (i = 0; icons[i]; i++)
+    g_object_unref (icons[i]);
+  g_object_unref (theme);
+}
+
+static void
+test_file_icon (void)
+{
+  GtkIconTheme *theme;
+  GIcon *icons[2];
+  GFile *file;
+  GPtrArray *paintables;
+  GError *error = NULL;
+  char *path;
+
+  theme = get_test_icontheme ();
+
+  path = g_test_build_filename (G_TEST_DIST, "icons", "16x16", "simple.png", NULL);
+  file = g_file_new_for_path (path);
+  icons[0] = g_file_icon_new (file);
+  icons[1] = NULL;
+
+  paintables = preload_icons (theme, icons, 0, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (paintables->len, ==, 1);
+  g_assert_cmpint (gdk_paintable_get_intrinsic_width (g_ptr_array_index (paintables, 0)), ==, 16);
+
+  g_ptr_array_unref (paintables);
+  g_object_unref (icons[0]);
+  g_object_unref (file);
+  g_free (path);
+  g_object_unref (theme);
+}
+
+static void
+test_cancel (void)
+{
+  GtkIconTheme *theme;
+  GIcon *icons[2];
+  GCancellable *cancellable;
+  GPtrArray *paintables;
+  GError *error = NULL;
+
+  theme = get_test_icontheme ();
+
+  icons[0] = g_themed_icon_new ("twosize");
+  icons[1] = NULL;
+
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+
+  paintables = preload_icons (theme, icons, 0, cancellable, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_null (paintables);
+
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+  g_object_unref (icons[0]);
+  g_object_unref (theme);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/iconpreload/order", test_order);
+  g_test_add_func ("/iconpreload/same-as-lookup", test_same_as_lookup);
+  g_test_add_func ("/iconpreload/file-icon", test_file_icon);
+  g_test_add_func ("/iconpreload/cancel", test_cancel);
+
+  return g_test_run ();
+}
@@ -1553,6 +1553,60 @@ test_get_iter (void)
   g_object_unref (buffer);
 }
 
+static void
+check_iter_at_offset (GtkTextBuffer *buffer,
+                      int            offset,
+                      int            line_length)
+{
+  GtkTextIter iter;
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, offset);
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, offset);
+  g_assert_cmpint (gtk_text_iter_get_line (&iter), ==, offset / line_length);
+  g_assert_cmpint (gtk_text_iter_get_line_offset (&iter), ==, offset % line_length);
+}
+
+static void
+test_get_iter_at_offset_sequence (void)
+{
+  GtkTextBuffer *buffer;
+  GString *str;
+  GtkTextIter iter;
+  int i, n_chars;
+
+  buffer = gtk_text_buffer_new (NULL);
+
+  /* Enough lines to get a multi-level btree, each "xyz\n" is 4 chars */
+  str = g_string_new (NULL);
+  for (i = 0; i < 500; i++)
+    g_string_append (str, "xyz\n");
+  gtk_text_buffer_set_text (buffer, str->str, -1);
+  n_chars = gtk_text_buffer_get_char_count (buffer);
+  g_assert_cmpint (n_chars, ==, 2000);
+
+  for (i = 0; i < n_chars; i++)
+    check_iter_at_offset (buffer, i, 4);
+
+  for (i = n_chars - 1; i >= 0; i -= 7)
+    check_iter_at_offset (buffer, i, 4);
+
+  for (i = 0; i < n_chars; i += 37)
+    check_iter_at_offset (buffer, i, 4);
+
+  /* Edits must invalidate whatever was remembered from lookups above */
+  check_iter_at_offset (buffer, 1001, 4);
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_insert (buffer, &iter, "abc\n", -1);
+  check_iter_at_offset (buffer, 1001, 4);
+  check_iter_at_offset (buffer, 1005, 4);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, n_chars + 4);
+  g_assert_true (gtk_text_iter_is_end (&iter));
+
+  g_string_free (str, TRUE);
+  g_object_unref (buffer);
+}
+
 static void
 test_iter_with_anchor (void)
 {
@@ -1940,6 +1994,7 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Tag", test_tag);
   g_test_add_func ("/TextBuffer/Clipboard", test_clipboard);
   g_test_add_func ("/TextBuffer/Get iter", test_get_iter);
+  g_test_add_func ("/TextBuffer/Get iter at offset sequence", test_get_iter_at_offset_sequence);
   g_test_add_func ("/TextBuffer/Iter with anchor", test_iter_with_anchor);
   g_test_add_func ("/TextBuffer/Get text with anchor", test_get_text_with_anchor);
   g_test_add_func ("/TextBuffer/Undo 0", test_undo0);
@@ -44,6 +44,7 @@ enum {
   SELECT,
   CHECK_SELECT,
   SET_MAX_UNDO,
+  SET_MAX_UNDO_BYTES,
 };
 
 typedef struct
@@ -310,6 +311,10 @@ run_test (const Command *commands,
           gtk_text_history_set_max_undo_levels (text->history, cmd->location);
           break;
 
+        case SET_MAX_UNDO_BYTES:
+          gtk_text_history_set_max_undo_bytes (text->history, cmd->location);
+          break;
+
         default:
           break;
         }
@@ -602,6 +607,42 @@ test14 (void)
   g_free (fill_after_2);
 }
 
+static void
+test15 (void)
+{
+  static const Command commands[] = {
+    { SET_MAX_UNDO_BYTES, 10, -1, NULL, NULL, UNSET, UNSET, UNSET },
+    { INSERT, 0, -1, "aaaa\n", "aaaa\n", SET, UNSET, UNSET },
+    { INSERT, 5, -1, "bbbb\n", "aaaa\nbbbb\n", SET, UNSET, UNSET },
+    { INSERT, 10, -1, "cccc\n", "aaaa\nbbbb\ncccc\n", SET, UNSET, UNSET },
+    { UNDO, -1, -1, NULL, "aaaa\nbbbb\n", SET, SET, UNSET },
+    { UNDO, -1, -1, NULL, "aaaa\n", UNSET, SET, UNSET },
+    { REDO, -1, -1, NULL, "aaaa\nbbbb\n", SET, SET, UNSET },
+    /* A single action larger than the limit can still be undone */
+    { INSERT, 10, -1, "dddddddddddddddd\n", "aaaa\nbbbb\ndddddddddddddddd\n", SET, UNSET, UNSET },
+    { UNDO, -1, -1, NULL, "aaaa\nbbbb\n", UNSET, SET, UNSET },
+  };
+
+  run_test (commands, G_N_ELEMENTS (commands), 0);
+}
+
+static void
+test16 (void)
+{
+  static const Command commands[] = {
+    { INSERT, 0, -1, "this is some text", "this is some text", SET, UNSET, UNSET },
+    { BEGIN_USER, -1, -1, NULL, NULL, UNSET, UNSET, UNSET },
+    { DELETE_KEY, 4, 7, " is", "this some text", UNSET, UNSET, UNSET },
+    { DELETE_KEY, 4, 9, " some", "this text", UNSET, UNSET, UNSET },
+    { DELETE_KEY, 0, 4, "this", " text", UNSET, UNSET, UNSET },
+    { END_USER, -1, -1, NULL, NULL, SET, UNSET, UNSET },
+    { UNDO, -1, -1, NULL, "this is some text", SET, SET, UNSET },
+    { REDO, -1, -1, NULL, " text", SET, UNSET, UNSET },
+  };
+
+  run_test (commands, G_N_ELEMENTS (commands), 0);
+}
+
 static void
 test_issue_4276 (void)
 {
@@ -684,6 +725,8 @@ main (int   argc,
   g_test_add_func ("/Gtk/TextHistory/test12", test12);
   g_test_add_func ("/Gtk/TextHistory/test13", test13);
   g_test_add_func ("/Gtk/TextHistory/test14", test14);
+  g_test_add_func ("/Gtk/TextHistory/test15", test15);
+  g_test_add_func ("/Gtk/TextHistory/test16", test16);
   g_test_add_func ("/Gtk/TextHistory/issue_4276", test_issue_4276);
   g_test_add_func ("/Gtk/TextHistory/issue_4575", test_issue_4575);
   g_test_add_func ("/Gtk/TextHistory/issue_5777", test_issue_5777);
@@ -279,6 +279,87 @@ test_search_caseless (void)
   check_found_backward ("aa \303\200", "aa", flags, 0, 2, "aa");
 }
 
+/* Searching turns matches back into iterators by counting chars.
+ * Without flags that skip anything, this moves over whole segments,
+ * and for caseless searches ASCII chars take a shortcut. Check that
+ * every substring is found where it is, with all flags, across line,
+ * segment and buffer boundaries, and with non-ASCII text.
+ */
+static void
+test_search_match_offsets (void)
+{
+  const char *chunks[] = {
+    "Ab\303\251c",
+    " d\303\266g ",
+    "\346\227\245\346\234\254",
+    "\n",
+    "x\360\237\230\200y",
+    "\nend \303\234",
+  };
+  GtkTextSearchFlags flags[] = {
+    0,
+    GTK_TEXT_SEARCH_VISIBLE_ONLY,
+    GTK_TEXT_SEARCH_TEXT_ONLY,
+    GTK_TEXT_SEARCH_CASE_INSENSITIVE,
+    GTK_TEXT_SEARCH_CASE_INSENSITIVE | GTK_TEXT_SEARCH_VISIBLE_ONLY | GTK_TEXT_SEARCH_TEXT_ONLY,
+  };
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter iter;
+  int n_chars, start, len;
+  gsize i, f;
+
+  buffer = gtk_text_buffer_new (NULL);
+  tag = gtk_text_buffer_create_tag (buffer, NULL, "weight", PANGO_WEIGHT_BOLD, NULL);
+
+  /* Alternate tags, so the text is split into several segments */
+  for (i = 0; i < G_N_ELEMENTS (chunks); i++)
+    {
+      gtk_text_buffer_get_end_iter (buffer, &iter);
+      if (i % 2)
+        gtk_text_buffer_insert_with_tags (buffer, &iter, chunks[i], -1, tag, NULL);
+      else
+        gtk_text_buffer_insert (buffer, &iter, chunks[i], -1);
+    }
+
+  n_chars = gtk_text_buffer_get_char_count (buffer);
+
+  for (start = 0; start < n_chars; start++)
+    {
+      for (len = 1; len <= 5 && start + len <= n_chars; len++)
+        {
+          GtkTextIter needle_start, needle_end, s, e;
+          char *needle;
+
+          gtk_text_buffer_get_iter_at_offset (buffer, &needle_start, start);
+          gtk_text_buffer_get_iter_at_offset (buffer, &needle_end, start + len);
+          needle = gtk_text_iter_get_text (&needle_start, &needle_end);
+
+          /* Needles can span lines, but not start or end with a newline */
+          if (needle[0] == '\n' || needle[strlen (needle) - 1] == '\n')
+            {
+              g_free (needle);
+              continue;
+            }
+
+          for (f = 0; f < G_N_ELEMENTS (flags); f++)
+            {
+              g_assert_true (gtk_text_iter_forward_search (&needle_start, needle, flags[f], &s, &e, NULL));
+              g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, start);
+              g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, start + len);
+
+              g_assert_true (gtk_text_iter_backward_search (&needle_end, needle, flags[f], &s, &e, NULL));
+              g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, start);
+              g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, start + len);
+            }
+
+          g_free (needle);
+        }
+    }
+
+  g_object_unref (buffer);
+}
+
 static void
 test_forward_to_tag_toggle (void)
 {
@@ -841,6 +922,7 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_search_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Search Match Offsets", test_search_match_offsets);
   g_test_add_func ("/TextIter/Forward To Tag Toggle", test_forward_to_tag_toggle);
   g_test_add_func ("/TextIter/Forward To Line End", test_forward_to_line_end);
   g_test_add_func ("/TextIter/Word Boundaries", test_word_boundaries);
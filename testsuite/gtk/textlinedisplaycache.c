@@ -0,0 +1,149 @@
+#include <gtk/gtk.h>
+
+#include "gtk/gtktextattributesprivate.h"
+#include "gtk/gtktextiterprivate.h"
+#include "gtk/gtktextlayoutprivate.h"
+#include "gtk/gtktextlinedisplaycacheprivate.h"
+
+#define N_LINES 2000
+#define BASE_SIZE 100
+/* Must match MAX_MRU_GROWTH */
+#define MAX_SIZE (4 * BASE_SIZE)
+
+static GtkTextLayout *
+create_layout (void)
+{
+  GtkTextLayout *layout;
+  GtkTextBuffer *buffer;
+  GtkTextAttributes *style;
+  PangoContext *context;
+  GString *text;
+  int i;
+
+  text = g_string_new ("");
+  for (i = 0; i < N_LINES; i++)
+    g_string_append_printf (text, "Line %d\n", i);
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+  g_string_free (text, TRUE);
+
+  layout = gtk_text_layout_new ();
+  gtk_text_layout_set_buffer (layout, buffer);
+  g_object_unref (buffer);
+
+  context = pango_font_map_create_context (pango_cairo_font_map_get_default ());
+  gtk_text_layout_set_contexts (layout, context, context);
+  g_object_unref (context);
+
+  style = gtk_text_attributes_new ();
+  gtk_text_layout_set_default_style (layout, style);
+  gtk_text_attributes_unref (style);
+
+  return layout;
+}
+
+/* Looks up the displays for lines @first to @last, in that order */
+static void
+scroll (GtkTextLineDisplayCache *cache,
+        GtkTextLayout           *layout,
+        int                      first,
+        int                      last)
+{
+  int step = first <= last ? 1 : -1;
+  int i;
+
+  for (i = first; ; i += step)
+    {
+      GtkTextIter iter;
+      GtkTextLineDisplay *display;
+
+      gtk_text_buffer_get_iter_at_line (layout->buffer, &iter, i);
+      display = gtk_text_line_display_cache_get (cache, layout, _gtk_text_iter_get_text_line (&iter), FALSE);
+      gtk_text_line_display_unref (display);
+
+      g_assert_cmpuint (gtk_text_line_display_cache_get_n_displays (cache), <=,
+                        gtk_text_line_display_cache_get_mru_size (cache));
+      g_assert_cmpuint (gtk_text_line_display_cache_get_mru_size (cache), >=, BASE_SIZE);
+      g_assert_cmpuint (gtk_text_line_display_cache_get_mru_size (cache), <=, MAX_SIZE);
+
+      if (i == last)
+        break;
+    }
+}
+
+static void
+test_grow (void)
+{
+  GtkTextLayout *layout;
+  GtkTextLineDisplayCache *cache;
+  int i;
+
+  layout = create_layout ();
+  cache = gtk_text_line_display_cache_new ();
+  gtk_text_line_display_cache_set_mru_size (cache, BASE_SIZE);
+
+  /* Repeatedly going over more lines than fit misses every
+   * time, so the cache grows until they fit
+   */
+  for (i = 0; i < 4; i++)
+    scroll (cache, layout, 0, 3 * BASE_SIZE - 1);
+
+  g_assert_cmpuint (gtk_text_line_display_cache_get_mru_size (cache), >=, 3 * BASE_SIZE);
+  g_assert_cmpuint (gtk_text_line_display_cache_get_n_displays (cache), ==, 3 * BASE_SIZE);
+
+  /* Scrolling back and forth over all lines can't be helped,
+   * but the cache must not grow beyond its limit
+   */
+  for (i = 0; i < 2; i++)
+    {
+      scroll (cache, layout, 0, N_LINES - 1);
+      scroll (cache, layout, N_LINES - 1, 0);
+    }
+
+  g_assert_cmpuint (gtk_text_line_display_cache_get_mru_size (cache), ==, MAX_SIZE);
+  g_assert_cmpuint (gtk_text_line_display_cache_get_n_displays (cache), ==, MAX_SIZE);
+
+  /* Setting a new size drops what was grown */
+  gtk_text_line_display_cache_set_mru_size (cache, BASE_SIZE / 2);
+  g_assert_cmpuint (gtk_text_line_display_cache_get_mru_size (cache), ==, BASE_SIZE / 2);
+  g_assert_cmpuint (gtk_text_line_display_cache_get_n_displays (cache), ==, BASE_SIZE / 2);
+
+  gtk_text_line_display_cache_free (cache);
+  g_object_unref (layout);
+}
+
+static void
+test_no_grow (void)
+{
+  GtkTextLayout *layout;
+  GtkTextLineDisplayCache *cache;
+  int i;
+
+  layout = create_layout ();
+  cache = gtk_text_line_display_cache_new ();
+  gtk_text_line_display_cache_set_mru_size (cache, BASE_SIZE);
+
+  /* Scrolling back and forth within what fits only hits */
+  for (i = 0; i < 10; i++)
+    {
+      scroll (cache, layout, 0, BASE_SIZE / 2);
+      scroll (cache, layout, BASE_SIZE / 2, 0);
+    }
+
+  g_assert_cmpuint (gtk_text_line_display_cache_get_mru_size (cache), ==, BASE_SIZE);
+
+  gtk_text_line_display_cache_free (cache);
+  g_object_unref (layout);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/textlinedisplaycache/grow", test_grow);
+  g_test_add_func ("/textlinedisplaycache/no-grow", test_no_grow);
+
+  return g_test_run ();
+}
@@ -0,0 +1,96 @@
+#include <gtk/gtk.h>
+
+static GskRenderNode *
+snapshot_child (GtkWidget *parent,
+                GtkWidget *child)
+{
+  GtkSnapshot *snapshot;
+  GskRenderNode *node;
+
+  snapshot = gtk_snapshot_new ();
+  gtk_widget_snapshot_child (parent, child, snapshot);
+  node = gtk_snapshot_free_to_node (snapshot);
+
+  g_assert_nonnull (node);
+  g_assert_cmpint (gsk_render_node_get_node_type (node), ==, GSK_TRANSFORM_NODE);
+
+  return node;
+}
+
+static void
+assert_offset (GskRenderNode *node,
+               float          x,
+               float          y)
+{
+  float dx, dy;
+
+  gsk_transform_to_translate (gsk_transform_node_get_transform (node), &dx, &dy);
+  g_assert_cmpfloat (dx, ==, x);
+  g_assert_cmpfloat (dy, ==, y);
+}
+
+/* Children with a transform are wrapped in a transform node.
+ * As long as neither the child nor its transform change, the
+ * same node must be used in every frame, so diffing is cheap.
+ */
+static void
+test_transform_node_reuse (void)
+{
+  GtkWidget *window, *fixed, *child;
+  GskRenderNode *node1, *node2;
+
+  window = gtk_window_new ();
+  fixed = gtk_fixed_new ();
+  child = gtk_label_new ("Hello");
+  gtk_fixed_put (GTK_FIXED (fixed), child, 10, 20);
+  gtk_window_set_child (GTK_WINDOW (window), fixed);
+  gtk_window_present (GTK_WINDOW (window));
+
+  gtk_test_widget_wait_for_draw (window);
+
+  node1 = snapshot_child (fixed, child);
+  assert_offset (node1, 10, 20);
+
+  /* Nothing changed */
+  node2 = snapshot_child (fixed, child);
+  g_assert_true (node1 == node2);
+  gsk_render_node_unref (node2);
+
+  /* Reallocating creates a new, but equal transform */
+  gtk_widget_queue_allocate (fixed);
+  gtk_test_widget_wait_for_draw (window);
+  node2 = snapshot_child (fixed, child);
+  g_assert_true (node1 == node2);
+  gsk_render_node_unref (node2);
+
+  /* The transform changed */
+  gtk_fixed_move (GTK_FIXED (fixed), child, 30, 40);
+  gtk_test_widget_wait_for_draw (window);
+  node2 = snapshot_child (fixed, child);
+  g_assert_true (node1 != node2);
+  assert_offset (node2, 30, 40);
+  gsk_render_node_unref (node1);
+  node1 = node2;
+
+  /* The child was redrawn */
+  gtk_label_set_label (GTK_LABEL (child), "World");
+  gtk_test_widget_wait_for_draw (window);
+  node2 = snapshot_child (fixed, child);
+  g_assert_true (node1 != node2);
+  g_assert_true (gsk_transform_node_get_child (node1) != gsk_transform_node_get_child (node2));
+  assert_offset (node2, 30, 40);
+
+  gsk_render_node_unref (node1);
+  gsk_render_node_unref (node2);
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/widget/snapshot/transform-node-reuse", test_transform_node_reuse);
+
+  return g_test_run ();
+}
@@ -29,6 +29,130 @@
 #include <gtk/gtk.h>
 #include "gtk-rendernode-tool.h"
 
+#include "gsk/gskrendernodeparserprivate.h"
+
+static GdkTexture *
+render_and_download (GskRenderer           *renderer,
+                     GskRenderNode         *node,
+                     const graphene_rect_t *viewport,
+                     gboolean               download)
+{
+  GdkTexture *texture;
+
+  texture = gsk_renderer_render_texture (renderer, node, viewport);
+  if (download)
+    {
+      GdkTextureDownloader *downloader;
+      GBytes *bytes;
+      gsize stride;
+
+      downloader = gdk_texture_downloader_new (texture);
+      bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
+      g_bytes_unref (bytes);
+      gdk_texture_downloader_free (downloader);
+    }
+
+  return texture;
+}
+
+static int
+compare_durations (gconstpointer a,
+                   gconstpointer b)
+{
+  gint64 da = *(const gint64 *) a;
+  gint64 db = *(const gint64 *) b;
+
+  return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+static void
+benchmark_trace (GArray     *frames,
+                 const char *renderer_name,
+                 guint       runs,
+                 gboolean    download,
+                 gboolean    full_frames,
+                 gboolean    verbose)
+{
+  GError *error = NULL;
+  GskRenderer *renderer;
+  gint64 *durations;
+  guint run, i, n;
+
+  renderer = create_renderer (renderer_name, &error);
+  if (renderer == NULL)
+    {
+      g_printerr ("Could not benchmark renderer \"%s\": %s\n", renderer_name, error->message);
+      g_clear_error (&error);
+      return;
+    }
+
+  durations = g_new (gint64, frames->len);
+
+  for (run = 0; run < runs; run++)
+    {
+      gint64 total = 0;
+
+      n = 0;
+      for (i = 0; i < frames->len; i++)
+        {
+          GskRenderTraceFrame *frame = &g_array_index (frames, GskRenderTraceFrame, i);
+          cairo_rectangle_int_t extents;
+          GdkTexture *texture;
+          gint64 start_time, duration;
+
+          /* Replay the same area the renderer had to redraw when the
+           * frame was recorded, so caches see the same incremental load.
+           */
+          if (full_frames)
+            extents = (cairo_rectangle_int_t) { 0, 0, frame->width, frame->height };
+          else
+            cairo_region_get_extents (frame->region, &extents);
+
+          if (extents.width <= 0 || extents.height <= 0)
+            continue;
+
+          start_time = g_get_monotonic_time ();
+          texture = render_and_download (renderer,
+                                         frame->node,
+                                         &GRAPHENE_RECT_INIT (extents.x, extents.y,
+                                                              extents.width, extents.height),
+                                         download);
+          duration = g_get_monotonic_time () - start_time;
+          g_object_unref (texture);
+
+          durations[n++] = duration;
+          total += duration;
+
+          if (verbose)
+            g_print ("%s\trun %u\tframe %u\t%dx%d\t%.3fms\t(recorded %.3fms)\n",
+                     renderer_name, run, i,
+                     extents.width, extents.height,
+                     duration / 1000.,
+                     frame->duration / 1000.);
+        }
+
+      if (n == 0)
+        {
+          g_print ("%s\tno frames with damage\n", renderer_name);
+          break;
+        }
+
+      qsort (durations, n, sizeof (gint64), compare_durations);
+      g_print ("%s\t%u frames\ttotal %.3fms\tmin %.3fms\tmedian %.3fms\tp95 %.3fms\tmax %.3fms\n",
+               renderer_name, n,
+               total / 1000.,
+               durations[0] / 1000.,
+               durations[n / 2] / 1000.,
+               durations[MIN (n - 1, n * 95 / 100)] / 1000.,
+               durations[n - 1] / 1000.);
+    }
+
+  g_free (durations);
+
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+}
+
 static void
 benchmark_node (GskRenderNode *node,
                 const char    *renderer_name,
@@ -54,18 +178,7 @@ benchmark_node (GskRenderNode *node,
 
       start_time = g_get_monotonic_time ();
 
-      texture = gsk_renderer_render_texture (renderer, node, NULL);
-      if (download)
-        {
-          GdkTextureDownloader *downloader;
-          GBytes *bytes;
-          gsize stride;
-
-          downloader = gdk_texture_downloader_new (texture);
-          bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
-          g_bytes_unref (bytes);
-          gdk_texture_downloader_free (downloader);
-        }
+      texture = render_and_download (renderer, node, NULL, download);
 
       end_time = g_get_monotonic_time ();
 
@@ -89,15 +202,20 @@ do_benchmark (int          *argc,
   char **filenames = NULL;
   char **renderers = NULL;
   gboolean nodownload = FALSE;
+  gboolean full_frames = FALSE;
+  gboolean verbose = FALSE;
   int runs = 3;
   const GOptionEntry entries[] = {
     { "renderer", 0, 0, G_OPTION_ARG_STRING_ARRAY, &renderers, N_("Add renderer to benchmark"), N_("RENDERER") },
     { "runs", 0, 0, G_OPTION_ARG_INT, &runs, N_("Number of runs with each renderer"), N_("RUNS") },
     { "no-download", 0, 0, G_OPTION_ARG_NONE, &nodownload, N_("Don’t download result/wait for GPU to finish"), NULL },
+    { "full-frames", 0, 0, G_OPTION_ARG_NONE, &full_frames, N_("Render whole frames of a trace instead of the damage"), NULL },
+    { "verbose", 0, 0, G_OPTION_ARG_NONE, &verbose, N_("Print the time of every frame of a trace"), NULL },
     { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL, N_("FILE…") },
     { NULL, }
   };
   GskRenderNode *node;
+  GArray *frames;
   GError *error = NULL;
   gsize i;
 
@@ -111,7 +229,7 @@ do_benchmark (int          *argc,
   context = g_option_context_new (NULL);
   g_option_context_set_translation_domain (context, GETTEXT_PACKAGE);
   g_option_context_add_main_entries (context, entries, NULL);
-  g_option_context_set_summary (context, _("Benchmark rendering of a .node file."));
+  g_option_context_set_summary (context, _("Benchmark rendering of a .node file or a frame trace."));
 
   if (!g_option_context_parse (context, argc, (char ***)argv, &error))
     {
@@ -137,14 +255,25 @@ do_benchmark (int          *argc,
   if (renderers == NULL || renderers[0] == NULL)
     renderers = g_strdupv ((char **) (const char *[]) { "gl", "ngl", "vulkan", "cairo", NULL });
   
-  node = load_node_file (filenames[0]);
-
-  for (i = 0; renderers[i] != NULL; i++)
+  frames = load_trace_file (filenames[0]);
+  if (frames)
     {
-      benchmark_node (node, renderers[i], runs, !nodownload);
+      for (i = 0; renderers[i] != NULL; i++)
+        benchmark_trace (frames, renderers[i], runs, !nodownload, full_frames, verbose);
+
+      g_array_unref (frames);
     }
+  else
+    {
+      node = load_node_file (filenames[0]);
 
-  gsk_render_node_unref (node);
+      for (i = 0; renderers[i] != NULL; i++)
+        {
+          benchmark_node (node, renderers[i], runs, !nodownload);
+        }
+
+      gsk_render_node_unref (node);
+    }
 
   g_strfreev (filenames);
   g_strfreev (renderers);
@@ -0,0 +1,107 @@
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib/gi18n-lib.h>
+#include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include "gtk-rendernode-tool.h"
+
+#include "gsk/gskrendernodeparserprivate.h"
+
+static gboolean binary = FALSE;
+
+static void
+file_convert (const char *filename,
+              const char *output)
+{
+  GskRenderNode *node;
+  GFile *file;
+  GFileOutputStream *stream;
+  GError *error = NULL;
+
+  node = load_node_file (filename);
+
+  file = g_file_new_for_commandline_arg (output);
+
+  if (binary)
+    {
+      stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &error);
+      if (stream)
+        {
+          if (gsk_render_node_write_binary (node, G_OUTPUT_STREAM (stream), NULL, &error))
+            g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, &error);
+          g_object_unref (stream);
+        }
+    }
+  else
+    {
+      GBytes *bytes;
+
+      bytes = gsk_render_node_serialize (node);
+      g_file_replace_contents (file,
+                               g_bytes_get_data (bytes, NULL),
+                               g_bytes_get_size (bytes),
+                               NULL, FALSE, G_FILE_CREATE_NONE,
+                               NULL, NULL, &error);
+      g_bytes_unref (bytes);
+    }
+
+  if (error)
+    {
+      g_printerr (_("Failed to write %s: %s\n"), output, error->message);
+      g_error_free (error);
+      exit (1);
+    }
+
+  g_object_unref (file);
+  gsk_render_node_unref (node);
+}
+
+void
+do_convert (int          *argc,
+            const char ***argv)
+{
+  GOptionContext *context;
+  char **filenames = NULL;
+  const GOptionEntry entries[] = {
+    { "binary", 0, 0, G_OPTION_ARG_NONE, &binary, N_("Use the binary format"), NULL },
+    { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL, N_("FILE…") },
+    { NULL, }
+  };
+  GError *error = NULL;
+
+  g_set_prgname ("gtk4-rendernode-tool convert");
+  context = g_option_context_new (NULL);
+  g_option_context_set_translation_domain (context, GETTEXT_PACKAGE);
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_set_summary (context, _("Convert the node file to the text or binary format."));
+
+  if (!g_option_context_parse (context, argc, (char ***)argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      exit (1);
+    }
+
+  g_option_context_free (context);
+
+  if (filenames == NULL)
+    {
+      g_printerr (_("No .node file specified\n"));
+      exit (1);
+    }
+
+  if (g_strv_length (filenames) != 2)
+    {
+      g_printerr (_("Can only accept a single .node file and output file\n"));
+      exit (1);
+    }
+
+  file_convert (filenames[0], filenames[1]);
+
+  g_strfreev (filenames);
+}
@@ -29,6 +29,8 @@
 #include <gtk/gtk.h>
 #include "gtk-rendernode-tool.h"
 
+#include "gsk/gskrendernodeparserprivate.h"
+
 #ifdef GDK_WINDOWING_BROADWAY
 #include <gsk/broadway/gskbroadwayrenderer.h>
 #endif
@@ -56,15 +58,30 @@ deserialize_error_func (const GskParseLocation *start,
   g_string_free (string, TRUE);
 }
 
-GskRenderNode *
-load_node_file (const char *filename)
+GBytes *
+load_file_bytes (const char *filename)
 {
   GFile *file;
   GBytes *bytes;
   GError *error = NULL;
 
   file = g_file_new_for_commandline_arg (filename);
-  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  if (g_file_peek_path (file))
+    {
+      GMappedFile *mapped;
+
+      /* Binary node files can use textures straight from the mapping */
+      mapped = g_mapped_file_new (g_file_peek_path (file), FALSE, &error);
+      if (mapped)
+        {
+          bytes = g_mapped_file_get_bytes (mapped);
+          g_mapped_file_unref (mapped);
+        }
+      else
+        bytes = NULL;
+    }
+  else
+    bytes = g_file_load_bytes (file, NULL, NULL, &error);
   g_object_unref (file);
 
   if (bytes == NULL)
@@ -74,7 +91,36 @@ load_node_file (const char *filename)
       exit (1);
     }
 
-  return gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+  return bytes;
+}
+
+GskRenderNode *
+load_node_file (const char *filename)
+{
+  GskRenderNode *node;
+  GBytes *bytes;
+
+  bytes = load_file_bytes (filename);
+  if (gsk_render_node_bytes_are_binary (bytes))
+    node = gsk_render_node_deserialize_binary (bytes, deserialize_error_func, NULL);
+  else
+    node = gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+  g_bytes_unref (bytes);
+
+  return node;
+}
+
+GArray *
+load_trace_file (const char *filename)
+{
+  GArray *frames;
+  GBytes *bytes;
+
+  bytes = load_file_bytes (filename);
+  frames = gsk_render_node_deserialize_trace (bytes, deserialize_error_func, NULL);
+  g_bytes_unref (bytes);
+
+  return frames;
 }
 
 /* keep in sync with gsk/gskrenderer.c */
@@ -7,6 +7,9 @@ void do_info        (int *argc, const char ***argv);
 void do_show        (int *argc, const char ***argv);
 void do_render      (int *argc, const char ***argv);
 void do_extract     (int *argc, const char ***argv);
+void do_convert     (int *argc, const char ***argv);
 
+GBytes        *load_file_bytes (const char *filename);
 GskRenderNode *load_node_file (const char *filename);
+GArray        *load_trace_file (const char *filename);
 GskRenderer   *create_renderer (const char *name, GError **error);